@@ -0,0 +1,66 @@
+# PlatformIO pre-build script. Compresses the web pages and assets that
+# the device serves into gzip byte arrays in include so that they can be
+# sent with Content-Encoding: gzip. A header is only written when its
+# contents change so that an unchanged page doesn't cause a rebuild.
+#
+# It can also be run on its own with: python compressWebPages.py
+
+import gzip
+import os
+import zlib
+
+try:
+    Import("env")
+    projectDir = env["PROJECT_DIR"]
+except NameError:
+    projectDir = os.path.dirname(os.path.abspath(__file__))
+
+# source file, header, array name, length define, hash define
+
+webAssets = [
+    ("src/codeEditorWebPage.html", "include/codeEditorWebPage.h",
+     "codeEditorPageGzip", "CODE_EDITOR_PAGE_GZIP_LENGTH", "CODE_EDITOR_PAGE_HASH"),
+    ("src/settingsWebStyle.css", "include/settingsWebAssets.h",
+     "settingsWebStyleGzip", "SETTINGS_WEB_STYLE_GZIP_LENGTH", "SETTINGS_WEB_STYLE_HASH"),
+]
+
+
+def buildHeader(sourcePath, arrayName, lengthName, hashName):
+    with open(os.path.join(projectDir, sourcePath), "rb") as sourceFile:
+        source = sourceFile.read()
+
+    # mtime of 0 so the output only changes when the source does
+    compressed = gzip.compress(source, 9, mtime=0)
+
+    lines = []
+    for pos in range(0, len(compressed), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in compressed[pos:pos + 16]) + ",")
+
+    return (
+        "#pragma once\n"
+        "\n"
+        "// Generated by compressWebPages.py from %s - do not edit\n"
+        "\n"
+        "#define %s %d\n"
+        "#define %s \"%08x\"\n"
+        "\n"
+        "const uint8_t %s[] PROGMEM = {\n"
+        "%s\n"
+        "};\n"
+    ) % (sourcePath, lengthName, len(compressed), hashName,
+         zlib.crc32(source) & 0xFFFFFFFF, arrayName, "\n".join(lines))
+
+
+for sourcePath, headerPath, arrayName, lengthName, hashName in webAssets:
+    header = buildHeader(sourcePath, arrayName, lengthName, hashName)
+    fullHeaderPath = os.path.join(projectDir, headerPath)
+
+    existing = None
+    if os.path.exists(fullHeaderPath):
+        with open(fullHeaderPath, "r") as headerFile:
+            existing = headerFile.read()
+
+    if header != existing:
+        print("Compressing %s into %s" % (sourcePath, headerPath))
+        with open(fullHeaderPath, "w") as headerFile:
+            headerFile.write(header)
@@ -5,6 +5,8 @@
 
 #define ENV_READING_LIFETIME_MSECS 5000
 
+#define BME280_DEFAULT_POLL_INTERVAL_MILLIS 100
+
 #define BME280SENSOR_NOT_FITTED -1
 #define BME280SENSOR_NOT_CONNECTED -2
 
@@ -88,6 +90,7 @@ struct BME280SensorSettings {
 	float humidDelta;
 	float humidNormMin;
 	float humidNormMax;
+	int pollIntervalMillis;
 };
 
 extern struct BME280SensorSettings bme280SensorSettings;
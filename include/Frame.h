@@ -2,10 +2,18 @@
 
 #include "Led.h"
 #include "Leds.h"
+#include "Sprite.h"
 
-#define MAX_NO_OF_SPRITES 20
+// Each sprite takes about 110 bytes of heap, spread over the 26 parallel
+// arrays of the sprite store. A frame has 20 sprites, which is about 2.4K.
+// Building with PIXELS_LARGE_SPRITE_STORE gives a frame a sprite for every
+// four pixels within the limits below, so a panel of 256 or more pixels
+// has 64 sprites and uses about 7.2K.
 
-class Sprite;
+#define DEFAULT_NO_OF_SPRITES 20
+
+#define MIN_NO_OF_SPRITES 20
+#define MAX_NO_OF_SPRITES 64
 
 class Frame
 {
@@ -29,10 +37,12 @@ public:
 	int noOfBrightnessSteps;
 	float targetBrightness;
 
-	Sprite * sprites [MAX_NO_OF_SPRITES];
-	Frame(Leds* inLeds, Colour inBackground); 
+	// set when something has changed that needs the frame to be drawn
+	// again - cleared by render
+	bool frameChanged;
 
-	Sprite * getSprite(int spriteNo);
+	Sprites * sprites;
+	Frame(Leds* inLeds, Colour inBackground); 
 
 	void overlayColour(Colour col, int timeMins);
 
@@ -49,7 +59,7 @@ public:
 	void fadeDown(int noOfSteps);
 
 	void fadeToBrightness(float brightness, int steps);
-	void setTargetColour(char ch, Sprite * s, int steps);
+	void setTargetColour(char ch, int spriteNo, int steps);
 	void fadeToColour(Colour target, int steps);
 	void setColour(Colour target);
 	void fadeBackToColour(Colour target, int noOfSteps);
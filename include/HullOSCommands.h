@@ -22,6 +22,8 @@ bool loadRunningProgramFromFile();
 
 void updateRunningProgram();
 
+unsigned long millisToNextProgramStep(unsigned long currentMillis);
+
 enum ProgramState
 {
 	PROGRAM_STOPPED,
@@ -33,6 +35,13 @@ enum ProgramState
 
 void displayProgramState();
 
+#define PROGRAM_OUTPUT_BUFFER_SIZE 40
+
+// The handler is called with the text written by print statements in
+// a running program, which is also displayed as before.
+
+bool bindProgramOutputHandler(void (*handler)(const char *text));
+
 void programStatus(char *buffer, int bufferLength);
 
 enum InterpreterState
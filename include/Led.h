@@ -2,12 +2,45 @@
 
 #include "Colour.h"
 
+// Building with PIXELS_INTEGER_FRAMEBUFFER holds each led as three bytes
+// and does the blending and brightness scaling in integer arithmetic.
+// This is much faster on processors without floating point hardware.
+// Nearly all the colours sent to the pixels are within one step of the
+// float version.
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+
+typedef unsigned char pixelChannel;
+
+#define PIXEL_CHANNEL_MAX 255
+
+#else
+
+typedef float pixelChannel;
+
+#define PIXEL_CHANNEL_MAX 1
+
+#endif
+
 class Led
 {
 public:
 
 	Led();
 
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+
+	unsigned char red;
+	unsigned char green;
+	unsigned char blue;
+
+	void Reset();
+	void SetColourValues(unsigned char r, unsigned char g, unsigned char b);
+	void AddColourValues(unsigned char r, unsigned char g, unsigned char b, int opacity);
+	bool IsBlack();
+
+#else
+
 	Colour colour;
 
 	void Reset();
@@ -15,6 +48,6 @@ public:
 	void AddColourValues(float r, float g, float b, float opacity);
 	void ReplceColour(Colour colour, float fraction);
 
+#endif
 
 };
-
@@ -8,18 +8,45 @@ class Leds
 public:
 
 	void(*show)();
-	void(*setPixel)(int no, float r, float g, float b);
+	void(*setPixel)(int no, pixelChannel r, pixelChannel g, pixelChannel b);
 
-	Led** leds;
+	// one block of leds in row major order - the led at x,y is
+	// leds[(y * ledWidth) + x]
+
+	Led* leds;
 	int ledWidth;
 	int ledHeight;
+	int noOfLeds;
+
+	// maps each led onto its position in the pixel strip
+	const int* rasterLookup;
+
+	// When an output buffer is set display() writes each frame straight
+	// into the pixel strip buffer in the strip colour order rather than
+	// calling setPixel for each led. Brightness and gamma are applied
+	// through a lookup table which is rebuilt when the brightness changes.
+
+	unsigned char* outputBuffer;
+	int outputRedOffset;
+	int outputGreenOffset;
+	int outputBlueOffset;
+	int outputBytesPerPixel;
+
+	unsigned char gammaTable[256];
+	unsigned char outputTable[256];
+	int outputTableBrightness;
 
 	float normWidth;
 	float normHeight;
 
 	Leds(int inWidth, int inHeight,
+		const int* inRasterLookup,
 		void(*inShow)(), 
-		void(*inSetPixel)(int no, float r, float g, float b));
+		void(*inSetPixel)(int no, pixelChannel r, pixelChannel g, pixelChannel b));
+
+	void setOutputBuffer(unsigned char* buffer, int redOffset, int greenOffset, int blueOffset, int bytesPerPixel);
+	void setGamma(float gamma);
+	void writeOutputBuffer(float brightness);
 
 	void dump();
 	void display(float brightness);
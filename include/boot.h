@@ -1,10 +1,16 @@
 #pragma once
 
+#include "processes.h"
+
+#define BOOT_OK 1700
+#define BOOT_IN_PROGRESS 1701
+
 extern struct process bootProcessDescriptor;
 
 struct BootSettings 
 {
     int accessPointTimeoutSecs;
+    bool fastBoot;
 };
 
 extern struct BootSettings bootSettings;
@@ -31,10 +37,32 @@ bool isSoftwareReset();
 #define BOOT_CONFIG_AP_DURATION_MAX_SECS 6000
 #define BOOT_CONFIG_AP_DURATION_DEFAULT_SECS 600
 
+// delays that give a serial monitor time to connect and the user time
+// to read the startup status. Both are skipped when fast boot is on.
+
+#define BOOT_SERIAL_SETTLE_MILLIS 3000
+#define BOOT_STATUS_DISPLAY_MILLIS 1000
+
+#define BOOT_MAX_NO_OF_PHASES 12
+
 extern char bootReasonMessage [BOOT_REASON_MESSAGE_SIZE];
 
 extern unsigned char bootMode;
 
 void getBootMode();
 
-void internalReboot(unsigned char rebootCode);
\ No newline at end of file
+void internalReboot(unsigned char rebootCode);
+
+void recordBootPhase(const char *phaseName);
+
+// called when a sensor produces a reading or a HullOS program runs a
+// statement - only the first call after boot is recorded
+
+void recordBootFirstWork(const char *workName);
+
+// called at the end of each pass through loop - starts the deferred
+// processes after the first pass
+
+void completeBoot();
+
+void dumpBootPhases();
\ No newline at end of file
@@ -21,6 +21,8 @@
 
 #define CLOCK_SYNC_TIMEOUT 5
 
+#define CLOCK_DEFAULT_POLL_INTERVAL_MILLIS 100
+
 #define ALARM1_TRIGGER 1
 #define ALARM2_TRIGGER 2
 #define ALARM3_TRIGGER 3
@@ -67,6 +69,7 @@ struct ClockSensorSettings {
 	struct ClockAlarm alarm3;
 	struct ClockTimer timer1;
 	struct ClockTimer timer2;
+	int pollIntervalMillis;
 };
 
 extern struct ClockSensorSettings clockSensorSettings;
@@ -10,6 +10,12 @@
 #define CODE_EDIT_PROGRAM_SIZE 500
 #define CODE_EDIT_PROGRAM_FILE_NAME "code.txt"
 
+// WebSocket for the live link to the editor page
+#define CODE_EDITOR_SOCKET_PORT 81
+// room for the whole program with every character escaped
+#define CODE_EDITOR_SOCKET_BUFFER_SIZE (CODE_EDIT_PROGRAM_SIZE * 2 + 60)
+#define CODE_EDITOR_SOCKET_JSON_SIZE 200
+
 
 #define CODE_EDITOR_TOPIC "codeEditor"
 
@@ -1,169 +1,188 @@
-const char *webPage = R"(
-<!DOCTYPE html>
-<html lang="en">
+#pragma once
 
-<head>
-    <title>Hull Pixelbot Python-ish Editor</title>
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <link rel="stylesheet" href="https://cdn.jsdelivr.net/npm/bootstrap@4.3.1/dist/css/bootstrap.min.css"
-        integrity="sha384-ggOyR0iXCbMQv3Xipma34MD+dH/1fQ784/j6cY/iJTQUOhcWr7x9JvoRxT2MZw1T" crossorigin="anonymous">
-</head>
+// Generated by compressWebPages.py from src/codeEditorWebPage.html - do not edit
 
-<body>
-    <div class="container mb-2 mt-2">
-        <h1 class="mb-4">&#128421;&#65039; Hull Pixelbot Python-ish Editor</h1>
-    </div>
-    <p>
+#define CODE_EDITOR_PAGE_GZIP_LENGTH 2854
+#define CODE_EDITOR_PAGE_HASH "d673cdb2"
 
-    <div class="container mb-2 mt-2">
-      <form method="POST" id="EditorForm">
-        <textarea id="codeTextarea" name="codeTextarea" style="font-family:monospace;" class="w-100" rows="20"
-          cols="120"></textarea>
-        <input type="submit" value="Save and run" class="btn btn-primary mt-2 mb-2 btn-block">
-      </form>
-    </div>
-
-    <div class="container mb-2 mt-2" id="actionButtons">
-        <div class="row justify-content-between">
-            <div class="col">
-                <a href="/run" class="btn btn-primary mb-2">Run</a>
-            </div>
-            <div class="col">
-                <a href="/stop" class="btn btn-primary mb-2">Stop</a>
-            </div>
-            <div class="col">
-                <button class="btn btn-primary mb-2" onclick="doSampleProgram();">Sample</button>
-            </div>
-            <div class="col">
-                <button class="btn btn-primary mb-2" onclick="doClearProgram();">Clear</button>
-            </div>
-        </div>
-    <div class="container mb-2 mt-2">
-      <a href="http://www.hullpixelbot.com/HullOS%20Python-ish%20Specification.pdf" target="_blank">Python-ish Specification</a>
-      </p>
-  </div>
-    </div>
-
-  <script>
-    document.getElementById("EditorForm").addEventListener("submit", function(event) {
-
-      event.preventDefault(); // Prevent the default form submit (which reloads the page)
-
-      const textarea = document.getElementById("codeTextarea");
-      const text = textarea.value;
-      text = 'begin\n' + text + '\nend\nsave "active.txt"\nload "active.txt"\n';
-
-      fetch("/save", {
-        method: "POST",
-        headers: {
-          "Content-Type": "text/plain"
-        },
-        body: text
-      })
-      .then(response => {
-        if (!response.ok) throw new Error("Network response was not ok");
-        return response.text(); // or .json() if your server responds with JSON
-      })
-      .then(data => {
-        console.log("Saved:", data); // Show success feedback if needed
-      })
-      .catch(error => {
-        alert("Error: Unable to send the program." + error.message);
-      });
-    });
-        var serial = null;
-
-        let builtInProgramNo = 0;
-
-        let builtInPrograms = [
-`# Coloured flashing
-forever
-  red
-  delay 5
-  green
-  delay 5
-`,
-`# Alarm 
-forever
-  sound 1000
-  delay 5
-  sound 2000
-  delay 5
-`,
-`# square dance 
-forever
-  move 100
-  turn 90
-`,
-`# distance light 
-forever
-  d = @distance
-  if d < 100:
-    red
-    continue
-  if d < 200:
-    yellow
-    continue
-  green
-`,
-`# robot coward 
-forever
-  green
-  d = @distance
-  if d < 100:
-    red
-    move -100
-`,
-`# turn and run 
-forever
-  green
-  d = @distance
-  if d < 100:
-    red
-    turn 180
-    move 100
-`,
-`# avoid obstacles 
-forever
-  green
-  move
-  d = @distance
-  if d < 100:
-    red
-    turn 90
-`,
-`# spin the bottle
-forever
-  green
-  if @distance < 100:
-    a = @random*30
-    a = a+360
-    red
-    turn a
-`,
-`# theramin
-forever
-  f=@distance*20
-  f=f+1000
-  sound f
-`
-    ];
-
-    function doSampleProgram(){
-        let input = document.getElementById('codeTextarea');
-        input.value = builtInPrograms[builtInProgramNo];
-        builtInProgramNo++;
-        if(builtInProgramNo==builtInPrograms.length){
-            builtInProgramNo=0;
-        }
-    }
-
-    function doClearProgram() {
-        let input = document.getElementById('codeTextarea');
-        input.value = "";
-    }
-</script>
-</body>
-
-</html>
-)";
+const uint8_t codeEditorPageGzip[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xc5, 0x1a, 0x6b, 0x6f, 0xdb, 0xb6,
+    0xf6, 0x7b, 0x7e, 0x05, 0xab, 0xe1, 0xb6, 0xf6, 0x12, 0xcb, 0x76, 0xd2, 0x6d, 0x99, 0x1f, 0x41,
+    0xd7, 0x34, 0x43, 0x57, 0xb4, 0x4d, 0xb6, 0x78, 0xd8, 0x76, 0xd7, 0xe2, 0x8e, 0x96, 0x68, 0x8b,
+    0x0d, 0x45, 0x6a, 0x24, 0x6d, 0xc7, 0xe8, 0xf2, 0xdf, 0x77, 0xf8, 0xb0, 0x44, 0xc9, 0x4e, 0xe6,
+    0x6e, 0xf7, 0xe2, 0x06, 0x08, 0x22, 0x1d, 0x92, 0xe7, 0xfd, 0xa4, 0x32, 0x7a, 0xf4, 0xe2, 0xf2,
+    0x7c, 0xf2, 0xcb, 0xd5, 0x05, 0xca, 0x74, 0xce, 0xce, 0x0e, 0x46, 0xe6, 0x0f, 0x62, 0x98, 0xcf,
+    0xc7, 0x11, 0xe1, 0xd1, 0xd9, 0x01, 0x40, 0x08, 0x4e, 0xcf, 0x0e, 0x10, 0xfc, 0x8c, 0x34, 0xd5,
+    0x8c, 0x9c, 0xbd, 0x5c, 0x30, 0x86, 0xae, 0xe8, 0x2d, 0x61, 0x53, 0xa1, 0xd1, 0xd5, 0x5a, 0x67,
+    0x82, 0x77, 0xa8, 0xca, 0xd0, 0x45, 0x4a, 0xb5, 0x90, 0xa3, 0xae, 0xdb, 0xe6, 0x8e, 0xe4, 0x44,
+    0x63, 0xc4, 0x71, 0x4e, 0xc6, 0xd1, 0x92, 0x92, 0x55, 0x21, 0xa4, 0x8e, 0x50, 0x22, 0xb8, 0x26,
+    0x5c, 0x8f, 0xa3, 0x15, 0x4d, 0x75, 0x36, 0x4e, 0xc9, 0x92, 0x26, 0xa4, 0x63, 0x5f, 0x8e, 0x10,
+    0xe5, 0x54, 0x53, 0xcc, 0x3a, 0x2a, 0xc1, 0x8c, 0x8c, 0xfb, 0x71, 0x2f, 0xf2, 0xa8, 0x18, 0xe5,
+    0x37, 0x48, 0x12, 0x36, 0x8e, 0x94, 0x5e, 0x33, 0xa2, 0x32, 0x42, 0x00, 0x57, 0x26, 0xc9, 0x6c,
+    0x1c, 0x65, 0x5a, 0x17, 0x6a, 0xd0, 0xed, 0x26, 0x29, 0x8f, 0x3f, 0xa8, 0x94, 0x30, 0xba, 0x94,
+    0x31, 0x27, 0xba, 0xcb, 0x8b, 0xbc, 0x3b, 0x15, 0x42, 0x2b, 0x2d, 0x71, 0xf1, 0xec, 0x69, 0x7c,
+    0x12, 0xf7, 0xbb, 0x29, 0x55, 0xba, 0x9b, 0x28, 0x55, 0x2d, 0xc4, 0x39, 0xe5, 0x31, 0x40, 0x22,
+    0x4b, 0xc9, 0xfc, 0x50, 0xe0, 0x70, 0x2e, 0xa9, 0x5e, 0x03, 0xb5, 0x0c, 0x9f, 0x9c, 0x3e, 0xed,
+    0xcc, 0xe7, 0x97, 0xeb, 0x1f, 0x7a, 0xf4, 0xe7, 0xf3, 0xe9, 0x9b, 0xef, 0x97, 0x27, 0x3f, 0xd3,
+    0x22, 0xc7, 0x27, 0x4f, 0xdf, 0xbc, 0x38, 0x4c, 0x5f, 0x76, 0xfb, 0xb3, 0xef, 0xbf, 0x3a, 0x7d,
+    0xda, 0xfd, 0xf0, 0x65, 0xf2, 0x4b, 0x97, 0xbe, 0x9a, 0x7c, 0xff, 0xe3, 0x65, 0x96, 0xfc, 0x24,
+    0xbf, 0xba, 0xfd, 0xfa, 0xd5, 0x52, 0xfc, 0x70, 0x3b, 0x39, 0x7e, 0xf3, 0xef, 0x55, 0x7f, 0x02,
+    0x62, 0x4b, 0xa1, 0x94, 0x90, 0x74, 0x4e, 0xf9, 0x38, 0xc2, 0x5c, 0xf0, 0x75, 0x2e, 0x16, 0x0a,
+    0xc4, 0x1b, 0x75, 0x9d, 0x92, 0x0f, 0x46, 0x53, 0x91, 0xae, 0xbd, 0xb8, 0x29, 0x5d, 0xa2, 0x84,
+    0x61, 0xa5, 0xc6, 0x91, 0xd1, 0x17, 0xa6, 0x9c, 0x48, 0x94, 0x4f, 0x3b, 0xc7, 0x28, 0xd7, 0x9d,
+    0x63, 0xaf, 0x14, 0xbb, 0x33, 0xeb, 0x6f, 0x36, 0xc2, 0xf2, 0xd3, 0xe8, 0xec, 0xf1, 0x67, 0xfd,
+    0xe3, 0xd3, 0xa7, 0xc7, 0xfd, 0xe1, 0xe3, 0xcf, 0xbe, 0xfc, 0xa2, 0x77, 0xf2, 0xf5, 0x10, 0xfd,
+    0xa5, 0xc9, 0xb2, 0xbe, 0xa7, 0x0a, 0xca, 0x59, 0xfa, 0xc7, 0x02, 0x18, 0xfa, 0x14, 0x4e, 0x46,
+    0x33, 0x21, 0x73, 0x04, 0x06, 0xcf, 0x44, 0x3a, 0x8e, 0xae, 0x2e, 0xaf, 0x41, 0x64, 0x0a, 0x4f,
+    0x8e, 0xc6, 0xb7, 0xb0, 0x18, 0x32, 0xad, 0xc9, 0xad, 0xc6, 0x92, 0x60, 0xbb, 0x25, 0x11, 0x29,
+    0x99, 0x78, 0x40, 0xe4, 0xdd, 0xa5, 0x0e, 0xb3, 0x26, 0x1f, 0x47, 0x33, 0xa0, 0xdf, 0x99, 0xe1,
+    0x9c, 0xb2, 0xf5, 0x20, 0x17, 0x5c, 0xa8, 0x02, 0x27, 0x64, 0x18, 0x6d, 0xd8, 0x5b, 0x75, 0xfa,
+    0xbd, 0x5e, 0x84, 0xa4, 0x58, 0xc1, 0xcb, 0x71, 0xaf, 0x32, 0x27, 0x02, 0x9f, 0x63, 0x00, 0xeb,
+    0x03, 0xf0, 0x0c, 0x3c, 0xd4, 0xe3, 0x0d, 0xf8, 0xa1, 0xbc, 0x58, 0x68, 0xa4, 0xd7, 0x05, 0x50,
+    0x51, 0x8b, 0x69, 0x4e, 0xc1, 0xb7, 0x96, 0x98, 0x2d, 0xe0, 0xf5, 0x1a, 0x2f, 0x09, 0xc2, 0x3c,
+    0x45, 0x72, 0xc1, 0x4b, 0x52, 0x53, 0xcd, 0x11, 0xfc, 0x76, 0x0a, 0x49, 0x73, 0x2c, 0xd7, 0x56,
+    0x15, 0x4e, 0x29, 0x06, 0x3a, 0x65, 0x22, 0xb9, 0xa9, 0x34, 0xd3, 0x35, 0xaa, 0xa9, 0x69, 0x78,
+    0x2f, 0xcd, 0x5a, 0xdd, 0xe0, 0x44, 0x53, 0xc1, 0x9f, 0x2f, 0xb4, 0x16, 0x5c, 0x85, 0x1a, 0x0c,
+    0x0e, 0x83, 0xc0, 0xe8, 0xc3, 0x42, 0x69, 0x3a, 0x5b, 0x77, 0x7c, 0x70, 0x75, 0xa6, 0x44, 0xaf,
+    0x88, 0x8d, 0x61, 0x14, 0xfc, 0xd4, 0x49, 0xb2, 0xc6, 0xaa, 0xdd, 0x81, 0x7d, 0x4c, 0x75, 0x1f,
+    0x14, 0x77, 0x6a, 0xf8, 0x13, 0x3c, 0x61, 0x34, 0xb9, 0x01, 0x06, 0x88, 0x5e, 0x48, 0x8e, 0x52,
+    0xf1, 0xc3, 0x82, 0x5f, 0x49, 0x31, 0x97, 0x38, 0x6f, 0xb5, 0x87, 0xd1, 0x19, 0xbc, 0x8e, 0xba,
+    0xb8, 0xc1, 0x42, 0xe5, 0x63, 0x7f, 0x87, 0x2b, 0xa5, 0x45, 0xf1, 0xc9, 0x6c, 0x5d, 0xc3, 0xa1,
+    0x90, 0x2f, 0xf3, 0xfe, 0x5f, 0x62, 0x6c, 0x6a, 0x2d, 0xb3, 0x27, 0x43, 0xc0, 0x09, 0xce, 0x0b,
+    0x46, 0x6a, 0xbc, 0x58, 0xc8, 0xa8, 0xeb, 0x10, 0xfd, 0x1f, 0x58, 0x3a, 0x67, 0x04, 0xcb, 0x90,
+    0x23, 0x0b, 0xd8, 0x8b, 0xa1, 0x30, 0x5f, 0xec, 0x9b, 0x26, 0x0a, 0xeb, 0xd6, 0xc4, 0x66, 0x85,
+    0x6b, 0x8d, 0xb5, 0x49, 0x81, 0x6f, 0x21, 0x2d, 0xc1, 0x21, 0x4e, 0x12, 0x4d, 0xd2, 0x51, 0xb7,
+    0xa8, 0x36, 0x4b, 0x62, 0xb7, 0x17, 0x8e, 0xbd, 0xcb, 0x85, 0x86, 0x30, 0x2d, 0xd3, 0x41, 0x8e,
+    0x6f, 0x3b, 0x19, 0xa1, 0xf3, 0x4c, 0x0f, 0xfa, 0x3d, 0x92, 0x0f, 0x91, 0x58, 0x12, 0x39, 0x63,
+    0x62, 0xd5, 0x59, 0x0f, 0xf0, 0x42, 0x8b, 0xa1, 0x09, 0x76, 0x40, 0xb1, 0x9d, 0xdc, 0xf6, 0x65,
+    0x16, 0x07, 0x05, 0x06, 0xea, 0xcb, 0x6a, 0xb5, 0x8a, 0x33, 0x48, 0xa6, 0x85, 0xcf, 0xa5, 0x71,
+    0x22, 0xf2, 0xae, 0xc9, 0xae, 0x97, 0xd7, 0xff, 0x3a, 0xee, 0x55, 0x89, 0x15, 0x5e, 0xae, 0x0b,
+    0x92, 0xd0, 0x19, 0x4d, 0xb0, 0x09, 0xdf, 0xb8, 0x48, 0x67, 0x11, 0x82, 0x9c, 0x33, 0x27, 0x50,
+    0xf6, 0xfe, 0x33, 0x85, 0x0a, 0x0b, 0xe9, 0x21, 0x48, 0xc4, 0xb5, 0xdd, 0x81, 0x67, 0x7a, 0x5d,
+    0x84, 0xac, 0x97, 0x09, 0x64, 0xa4, 0x12, 0x49, 0x0b, 0xed, 0xc0, 0xdd, 0x2e, 0x7a, 0x4d, 0x21,
+    0x4f, 0xd9, 0x2a, 0xa9, 0x05, 0xd2, 0x19, 0x41, 0xae, 0xb0, 0xc6, 0x36, 0xcb, 0x2b, 0x04, 0x09,
+    0x0f, 0x29, 0xc8, 0x0c, 0x08, 0x2b, 0xb3, 0xba, 0xb6, 0x80, 0x1c, 0xa7, 0x00, 0x35, 0xdb, 0xb1,
+    0xde, 0xe0, 0xc1, 0x26, 0xd1, 0x41, 0xa5, 0xfd, 0x7d, 0x41, 0x94, 0x06, 0x47, 0x61, 0x6b, 0x94,
+    0x99, 0x33, 0x02, 0xd4, 0x8e, 0xa5, 0xb6, 0xa8, 0xbd, 0x3d, 0x62, 0x34, 0x31, 0x2f, 0x78, 0x4e,
+    0xd0, 0x0c, 0x33, 0xa6, 0xd0, 0x14, 0x27, 0x37, 0x1b, 0x3c, 0x70, 0xe0, 0xe5, 0x64, 0x72, 0x85,
+    0x56, 0x19, 0xe1, 0xf6, 0x90, 0xe5, 0x8d, 0x2a, 0xc4, 0xc1, 0xda, 0xa2, 0x20, 0x3c, 0x76, 0x69,
+    0x90, 0x11, 0x0d, 0x2c, 0x24, 0x37, 0xf0, 0x67, 0x8c, 0x38, 0x28, 0x73, 0x58, 0x81, 0xd7, 0x3c,
+    0x21, 0xa9, 0x29, 0x03, 0x5b, 0x4b, 0xc0, 0xe3, 0x35, 0x48, 0xf3, 0x8d, 0x59, 0xe9, 0x0d, 0x1d,
+    0xa6, 0xd9, 0x82, 0xdb, 0x6c, 0x09, 0x72, 0x6a, 0xe7, 0x5a, 0x2d, 0x93, 0xea, 0xdb, 0xe8, 0xa3,
+    0x57, 0x67, 0x2a, 0x92, 0x45, 0x0e, 0xa7, 0x62, 0xb0, 0xc3, 0x05, 0x23, 0xe6, 0xf1, 0xf9, 0xfa,
+    0xbb, 0xb4, 0x55, 0x77, 0xc7, 0x76, 0x6c, 0x4e, 0x9d, 0xbb, 0x44, 0x0a, 0xe8, 0xcd, 0x9b, 0x23,
+    0x7c, 0xd7, 0xa4, 0x63, 0xd9, 0xbe, 0x04, 0x59, 0x5a, 0x15, 0x11, 0x9f, 0x75, 0xbc, 0x48, 0x8f,
+    0x1c, 0xe3, 0xe8, 0xf1, 0x63, 0x0f, 0x89, 0xa1, 0xf0, 0xa4, 0x6b, 0x43, 0x8a, 0xa0, 0xf1, 0x18,
+    0xfd, 0x44, 0xa6, 0xd7, 0x0e, 0x7e, 0x79, 0x75, 0xf1, 0xf6, 0x1e, 0x32, 0x84, 0xa7, 0xd7, 0x62,
+    0x21, 0x13, 0x12, 0x90, 0x01, 0xbf, 0x05, 0xf3, 0x68, 0xa7, 0x9b, 0x7b, 0x05, 0xab, 0x95, 0xd1,
+    0x76, 0x6c, 0x4b, 0xda, 0xd0, 0x63, 0xf0, 0xfc, 0x18, 0xec, 0xad, 0x57, 0xd7, 0x97, 0x6f, 0x63,
+    0x68, 0x86, 0x28, 0x9f, 0x43, 0x15, 0x69, 0x7d, 0x44, 0x49, 0x9e, 0x0e, 0x50, 0xa4, 0x2c, 0xd5,
+    0xe8, 0x08, 0x19, 0x3c, 0x03, 0x47, 0xed, 0xae, 0xdd, 0x2e, 0x31, 0x84, 0xf6, 0xd9, 0x52, 0x13,
+    0xf8, 0x80, 0xc1, 0xad, 0x9c, 0xc7, 0x18, 0xd7, 0x11, 0x33, 0xfb, 0x6c, 0xd1, 0x18, 0x97, 0xb3,
+    0x8e, 0x95, 0x64, 0xd0, 0x6f, 0x92, 0x14, 0x29, 0x0a, 0xc8, 0x9c, 0xa3, 0x60, 0x90, 0xcc, 0x1c,
+    0x6d, 0xe8, 0x81, 0x2a, 0x63, 0x14, 0xca, 0x17, 0x36, 0x4c, 0x9e, 0xaf, 0x35, 0x69, 0x4d, 0xb7,
+    0xf4, 0xde, 0x9a, 0xa2, 0xc7, 0xa8, 0x77, 0x7b, 0xde, 0x6b, 0x1b, 0xf5, 0xf6, 0x6e, 0x4f, 0x7b,
+    0xf7, 0x28, 0x15, 0x78, 0x77, 0xbd, 0x49, 0xa0, 0x54, 0x3a, 0x43, 0xad, 0x47, 0x35, 0xab, 0xfe,
+    0xf1, 0x47, 0x4d, 0x4a, 0x67, 0xcd, 0xea, 0xc0, 0x86, 0xec, 0x46, 0x23, 0x9e, 0xca, 0x3f, 0x33,
+    0x4f, 0xc0, 0x8c, 0xf6, 0x54, 0x2b, 0x1e, 0xf6, 0xa0, 0x6d, 0x82, 0xaf, 0x8c, 0x7f, 0x94, 0x09,
+    0xb6, 0xb1, 0x81, 0x8b, 0x5a, 0x93, 0x01, 0x7e, 0x9c, 0x7c, 0xdb, 0x39, 0x3d, 0x72, 0xa1, 0x4f,
+    0x90, 0x71, 0x7f, 0x13, 0x99, 0x33, 0xb1, 0x80, 0x3e, 0x07, 0x7a, 0x9d, 0x0a, 0x91, 0x4d, 0x19,
+    0x14, 0x4a, 0x08, 0x68, 0x5b, 0x21, 0x89, 0x61, 0xbb, 0x34, 0xb6, 0xe3, 0x06, 0xf8, 0x0a, 0x2f,
+    0xf1, 0xb5, 0xcd, 0x42, 0xc6, 0x8a, 0x12, 0x7a, 0x15, 0x22, 0x55, 0x4d, 0x01, 0xee, 0x18, 0x68,
+    0x8d, 0xac, 0x90, 0xe1, 0xfe, 0x82, 0x1b, 0x91, 0x41, 0xe5, 0x31, 0xb1, 0x4f, 0x2e, 0x40, 0x87,
+    0xb5, 0x33, 0x4e, 0xd6, 0xe7, 0x7f, 0x75, 0x32, 0x50, 0x49, 0xa9, 0x32, 0x9b, 0x34, 0x6c, 0x96,
+    0xb2, 0x59, 0xc1, 0x01, 0x57, 0x19, 0x65, 0x04, 0xb5, 0x1c, 0x7c, 0xe4, 0x58, 0x8a, 0x19, 0xe1,
+    0x73, 0x9d, 0xd9, 0xb0, 0xf4, 0xf0, 0x80, 0x6c, 0xb0, 0x6a, 0x77, 0xff, 0x6a, 0xf7, 0xbc, 0xaf,
+    0x0c, 0xf1, 0x3c, 0x80, 0x86, 0x06, 0xb1, 0x90, 0xc3, 0xc3, 0x2d, 0x8b, 0x18, 0xbe, 0xc0, 0x0c,
+    0x17, 0xa0, 0xdd, 0xf1, 0x0e, 0x42, 0xc3, 0x60, 0x1b, 0xc8, 0xeb, 0xb6, 0x4d, 0x77, 0x6c, 0xf0,
+    0xa2, 0x78, 0x54, 0x67, 0x9e, 0x77, 0x60, 0xd3, 0x9f, 0x0a, 0x20, 0x8e, 0x71, 0x0f, 0xef, 0xa0,
+    0xfe, 0x16, 0xf7, 0x1e, 0x89, 0x59, 0x0a, 0x45, 0x70, 0xe0, 0x4e, 0x67, 0x58, 0x42, 0x1c, 0x8e,
+    0x0a, 0x12, 0xfa, 0x19, 0xf8, 0x81, 0x75, 0x9e, 0x1c, 0xda, 0x4f, 0x9b, 0xd8, 0x1d, 0x7d, 0x21,
+    0x11, 0x84, 0xaf, 0x0b, 0xfa, 0x15, 0x5e, 0x83, 0xc3, 0x48, 0xb1, 0x98, 0x67, 0x50, 0x5b, 0x4a,
+    0x3f, 0xd9, 0x65, 0x9c, 0x33, 0xd4, 0x33, 0xac, 0xb7, 0x76, 0x05, 0x7a, 0x4d, 0xe3, 0x10, 0x95,
+    0x3b, 0xf6, 0xec, 0xb0, 0x4d, 0x7b, 0xcb, 0x3a, 0x3b, 0xe4, 0xf0, 0x3c, 0x78, 0x5d, 0x6d, 0x7b,
+    0xc8, 0xbd, 0xec, 0xb8, 0x13, 0xef, 0xdb, 0xdb, 0xfa, 0xab, 0x7c, 0x60, 0xa3, 0xbf, 0x1d, 0x5e,
+    0xf1, 0x50, 0x02, 0x2e, 0x4f, 0xbb, 0x44, 0x6c, 0x94, 0x1c, 0x1d, 0x95, 0x40, 0xac, 0x07, 0x4e,
+    0x9a, 0xa3, 0x20, 0x17, 0xe4, 0xd0, 0xfe, 0x0c, 0x50, 0x69, 0xd6, 0xc6, 0x3a, 0xe5, 0x8a, 0x48,
+    0x38, 0xb6, 0x89, 0xa7, 0x17, 0x64, 0x13, 0x4f, 0xa9, 0x7d, 0x72, 0x22, 0xc5, 0x30, 0xfc, 0x60,
+    0x29, 0xf1, 0xda, 0x59, 0xe4, 0xc8, 0x33, 0xdf, 0x6e, 0x57, 0x88, 0x9c, 0x5e, 0x06, 0x35, 0x2d,
+    0x6d, 0x24, 0x6b, 0x57, 0xa1, 0xf8, 0x70, 0x6d, 0x28, 0xd3, 0xb0, 0x6f, 0xfb, 0x26, 0xe2, 0x85,
+    0xcd, 0x56, 0x41, 0x2e, 0xae, 0x7a, 0x02, 0xe0, 0xb8, 0x2c, 0x93, 0xad, 0x68, 0x65, 0x26, 0xfd,
+    0x08, 0x1d, 0x22, 0x18, 0xb2, 0x5c, 0x77, 0x95, 0x09, 0xa5, 0xcd, 0xd4, 0x08, 0xb0, 0x68, 0x70,
+    0xda, 0xef, 0x46, 0x01, 0x17, 0x4e, 0xc5, 0x30, 0x2b, 0x42, 0x3a, 0x07, 0x5c, 0x25, 0xdd, 0x56,
+    0xcd, 0x31, 0xca, 0x7e, 0x21, 0x3a, 0xdf, 0xb4, 0xa1, 0x51, 0xbb, 0xb2, 0xa0, 0xc9, 0xc4, 0x81,
+    0x3c, 0x8f, 0xb6, 0xab, 0x80, 0x0d, 0x06, 0x49, 0xbc, 0x34, 0x60, 0x44, 0x30, 0x80, 0xde, 0xf4,
+    0x46, 0x55, 0x06, 0x66, 0x50, 0xf5, 0x21, 0x50, 0xa0, 0x4d, 0x55, 0xc0, 0x44, 0x70, 0x3a, 0x2c,
+    0xf1, 0x15, 0xdd, 0xbb, 0x8d, 0x5e, 0xb7, 0xe5, 0x49, 0x98, 0x50, 0x64, 0x1f, 0x81, 0x6a, 0xbd,
+    0x75, 0x28, 0x14, 0xec, 0x99, 0xd0, 0x9c, 0x88, 0x85, 0x6e, 0x35, 0x8c, 0x70, 0x84, 0x8e, 0x7b,
+    0xbd, 0x5e, 0xb9, 0x75, 0x07, 0xf5, 0x9c, 0x28, 0x65, 0x24, 0x0b, 0xe9, 0x93, 0x25, 0x94, 0x8a,
+    0x90, 0x09, 0x97, 0xcd, 0xab, 0xad, 0xd6, 0xc5, 0x21, 0x25, 0x28, 0xe2, 0xf6, 0xc6, 0x29, 0xd6,
+    0x38, 0x60, 0xc8, 0xed, 0x17, 0xb6, 0xc7, 0x7f, 0xa8, 0x68, 0xd6, 0x87, 0x81, 0xca, 0xd6, 0xc0,
+    0xdf, 0x8a, 0xea, 0x24, 0x43, 0x2d, 0x4f, 0x33, 0x36, 0xf3, 0x7c, 0xdd, 0x4a, 0x09, 0x06, 0xad,
+    0x6d, 0xda, 0x9a, 0x41, 0x6d, 0xb6, 0x69, 0x18, 0x79, 0xbc, 0xcb, 0xc8, 0x0f, 0x36, 0x91, 0xbb,
+    0x8a, 0x39, 0xc8, 0xb1, 0x61, 0xc6, 0x2c, 0x0f, 0x1b, 0xb8, 0x6a, 0x41, 0x72, 0xff, 0xc6, 0xbb,
+    0xda, 0xdb, 0x14, 0xf0, 0xdf, 0x0c, 0xb7, 0x84, 0x92, 0xc4, 0x60, 0x6b, 0x08, 0xb5, 0xdb, 0xaf,
+    0x1e, 0xc0, 0xa2, 0x4c, 0x63, 0xba, 0x43, 0x33, 0x55, 0xbf, 0x0d, 0xde, 0x6f, 0xb3, 0xf4, 0x86,
+    0x5d, 0x7b, 0xc2, 0x40, 0x23, 0x33, 0x9b, 0x17, 0xc6, 0xc9, 0xb6, 0x74, 0x16, 0xf8, 0xa3, 0x9f,
+    0x34, 0x91, 0x89, 0xe0, 0x3a, 0x0a, 0x88, 0x5e, 0x84, 0x67, 0x50, 0x1a, 0xec, 0xda, 0x1b, 0x68,
+    0x35, 0x62, 0x69, 0x1a, 0x92, 0x56, 0x01, 0x53, 0x9d, 0x90, 0x39, 0x06, 0x5d, 0xc5, 0x5c, 0xac,
+    0xc0, 0xd3, 0x3b, 0x55, 0xff, 0xdf, 0xb6, 0xe7, 0x72, 0x15, 0xb5, 0x9b, 0xca, 0x6d, 0x8c, 0x08,
+    0x35, 0x85, 0x22, 0xc2, 0x40, 0xda, 0xbf, 0xc3, 0x66, 0xfb, 0x6f, 0x98, 0x06, 0xc6, 0xc4, 0x02,
+    0x4a, 0x4c, 0xda, 0xd0, 0xab, 0x73, 0xf5, 0xc6, 0xb4, 0x11, 0x45, 0x7b, 0xd9, 0xc9, 0x9d, 0xfd,
+    0x6b, 0x84, 0x87, 0x95, 0x5f, 0x55, 0x49, 0xb8, 0xb1, 0x1f, 0x06, 0x49, 0xc1, 0xd8, 0x44, 0x14,
+    0x40, 0xbe, 0x06, 0x7a, 0x69, 0x87, 0xeb, 0xbd, 0xf8, 0x21, 0x52, 0x0a, 0xb9, 0xe5, 0x7c, 0xa5,
+    0x3a, 0x5f, 0xc3, 0x84, 0x5d, 0xd3, 0x25, 0x33, 0x00, 0x93, 0xaf, 0x6b, 0x50, 0xff, 0xb7, 0xa1,
+    0xe3, 0x07, 0x0c, 0xd9, 0xe0, 0x26, 0x48, 0x98, 0x41, 0xb1, 0xd9, 0xaa, 0x31, 0x3e, 0x65, 0xec,
+    0x1b, 0xc9, 0x38, 0x4d, 0x2f, 0x4c, 0xc2, 0x7a, 0x4d, 0x15, 0xe8, 0x14, 0x6a, 0x66, 0x64, 0xaf,
+    0x0b, 0x61, 0x2c, 0xaa, 0x86, 0x88, 0x76, 0x73, 0x06, 0xad, 0x5f, 0x86, 0xdd, 0x3f, 0x61, 0x6c,
+    0xf7, 0xf3, 0x48, 0xcb, 0x6a, 0x48, 0xbb, 0x0b, 0xca, 0xe9, 0x66, 0x5c, 0xd9, 0xac, 0x85, 0x7a,
+    0xd9, 0x8a, 0x91, 0x4f, 0x98, 0xf2, 0xec, 0x4d, 0x5f, 0x30, 0xd6, 0x79, 0x36, 0x60, 0xa4, 0x57,
+    0x64, 0x77, 0xd5, 0x6e, 0x5c, 0xa9, 0xfd, 0x73, 0xe9, 0xf6, 0x18, 0x45, 0xed, 0xc5, 0xdf, 0x3e,
+    0x5c, 0xde, 0x6b, 0xd6, 0xe0, 0x2a, 0x7a, 0x97, 0x51, 0xfd, 0xbd, 0xef, 0x51, 0x29, 0x66, 0x55,
+    0xd2, 0x3c, 0x49, 0x57, 0xb6, 0x0a, 0x69, 0xff, 0xbe, 0x20, 0x33, 0xbc, 0x60, 0x1a, 0x34, 0x6d,
+    0x6a, 0xff, 0x95, 0x03, 0xfa, 0xc1, 0xcb, 0xae, 0x20, 0x7b, 0x23, 0xee, 0xb0, 0xa2, 0x16, 0x34,
+    0x99, 0x50, 0x9a, 0x24, 0x61, 0x02, 0x97, 0x23, 0x31, 0x78, 0x7a, 0x38, 0xec, 0x3d, 0xaa, 0xfb,
+    0xcc, 0x27, 0x4d, 0x99, 0xf6, 0x32, 0x7d, 0xef, 0x49, 0x33, 0x1c, 0x38, 0x74, 0xd5, 0xa2, 0x99,
+    0xc5, 0xc6, 0x10, 0xea, 0x57, 0x9f, 0x4c, 0xc9, 0x9c, 0xf2, 0x77, 0xfc, 0x09, 0x04, 0xab, 0x05,
+    0x1d, 0xa2, 0x27, 0xef, 0x38, 0x98, 0xeb, 0x1d, 0x57, 0xe6, 0x7e, 0xdc, 0xde, 0x53, 0x2f, 0x21,
+    0xc7, 0xdc, 0xea, 0xe8, 0x1d, 0x37, 0x32, 0x36, 0x40, 0x4f, 0x4a, 0x8c, 0x33, 0x02, 0x35, 0xba,
+    0x15, 0x75, 0xcd, 0x39, 0x50, 0x76, 0x25, 0xa3, 0xfb, 0x76, 0x00, 0xa6, 0xb6, 0x1f, 0x0f, 0xaa,
+    0x86, 0xd3, 0x7c, 0x1d, 0x81, 0x86, 0x69, 0x50, 0x4b, 0xd7, 0x91, 0x4f, 0x70, 0x9d, 0x09, 0xd4,
+    0x78, 0x93, 0x45, 0x0c, 0x57, 0xdd, 0x82, 0x61, 0xca, 0xab, 0x7b, 0xff, 0xbb, 0x0a, 0x89, 0xf9,
+    0xb4, 0xe2, 0x2e, 0x30, 0xca, 0x5e, 0xd5, 0x3f, 0xc4, 0x60, 0x0b, 0xde, 0x82, 0xea, 0x59, 0x80,
+    0x32, 0xa1, 0x60, 0x9f, 0x05, 0x74, 0xac, 0x55, 0x36, 0x4b, 0xb1, 0xb8, 0x69, 0xdb, 0x49, 0x66,
+    0x65, 0x5b, 0xd2, 0x0b, 0x93, 0xf1, 0xa0, 0xbf, 0x22, 0x7a, 0x25, 0xa4, 0xf9, 0x34, 0xe5, 0x11,
+    0xac, 0xb0, 0xbf, 0xe2, 0xba, 0x09, 0x4b, 0x92, 0xf7, 0xd6, 0x12, 0x97, 0xe1, 0xc4, 0xbb, 0x0e,
+    0x0c, 0x4b, 0xf1, 0x07, 0x25, 0xcc, 0x6d, 0x03, 0xd0, 0x5b, 0x43, 0xb5, 0x86, 0xcc, 0x29, 0xa1,
+    0x47, 0xf4, 0xbb, 0xc1, 0x5d, 0xa0, 0xaf, 0xc9, 0x6c, 0xff, 0xb4, 0x9b, 0x79, 0xd3, 0x48, 0xd5,
+    0x19, 0x37, 0x8e, 0x21, 0x18, 0xa4, 0x59, 0x31, 0x6f, 0xd9, 0x2f, 0x18, 0xe9, 0x00, 0x74, 0xed,
+    0x1a, 0x2e, 0x43, 0xf3, 0x3a, 0x03, 0x29, 0xd4, 0x22, 0x49, 0x20, 0xe1, 0x82, 0x45, 0x48, 0x6a,
+    0x6e, 0xee, 0x0c, 0x79, 0x0e, 0xcf, 0x24, 0xdd, 0x22, 0x03, 0x9d, 0x36, 0x18, 0xcd, 0x26, 0xf9,
+    0x3a, 0x21, 0xcc, 0x60, 0xaa, 0x80, 0xd0, 0x32, 0x2b, 0x03, 0xf4, 0x23, 0xc7, 0x53, 0x18, 0xa5,
+    0xcc, 0x5d, 0xa1, 0x99, 0xff, 0xc2, 0xab, 0xc2, 0x77, 0xdc, 0x24, 0x7a, 0x8b, 0x61, 0x2b, 0xcd,
+    0xdf, 0xf9, 0xa7, 0xbb, 0x40, 0x61, 0x4b, 0x6c, 0xd5, 0x40, 0x31, 0x2b, 0xef, 0xfe, 0x82, 0x11,
+    0x44, 0xa3, 0xe9, 0x82, 0x32, 0xfd, 0xdd, 0x26, 0x5a, 0xde, 0x8a, 0xe0, 0x1e, 0x70, 0xf7, 0x16,
+    0x73, 0x99, 0xf0, 0xeb, 0xc1, 0x6f, 0x9f, 0xa1, 0x73, 0xc1, 0x40, 0xc7, 0x24, 0x45, 0x33, 0x86,
+    0x55, 0x06, 0x69, 0xe6, 0x00, 0x02, 0x15, 0xa2, 0xd7, 0x8c, 0xa4, 0xd2, 0xca, 0x9e, 0x12, 0x06,
+    0x43, 0xeb, 0x17, 0xf0, 0x34, 0x97, 0x84, 0xf0, 0x00, 0xf2, 0xdb, 0x91, 0xc1, 0xf0, 0x0d, 0xc3,
+    0x10, 0xd9, 0xc1, 0x31, 0x65, 0x2f, 0x4e, 0xfa, 0xd0, 0x35, 0xd7, 0x4e, 0x3b, 0xf0, 0x71, 0x1d,
+    0xec, 0x50, 0xa8, 0xdf, 0x17, 0xe6, 0x02, 0x36, 0x35, 0x09, 0x3b, 0xc4, 0x64, 0x86, 0x38, 0x83,
+    0x08, 0x1e, 0xad, 0xc3, 0x7c, 0xdd, 0xf3, 0x07, 0xcc, 0x67, 0x4b, 0xbb, 0x99, 0x99, 0x9a, 0x1c,
+    0x1e, 0x31, 0x97, 0x05, 0xcf, 0x36, 0xcb, 0x07, 0xd6, 0x69, 0xcd, 0x14, 0x0b, 0x48, 0x5c, 0x39,
+    0x96, 0xde, 0x9e, 0x89, 0x1b, 0x62, 0x83, 0x2d, 0xc7, 0x9b, 0x2d, 0x6b, 0xc2, 0x98, 0x58, 0x35,
+    0x77, 0x39, 0xe1, 0x1d, 0x79, 0x29, 0xa6, 0x76, 0x90, 0x58, 0x61, 0x99, 0x86, 0xc4, 0x4b, 0x05,
+    0xed, 0xc9, 0x84, 0x95, 0xcf, 0x7c, 0xa7, 0xf3, 0x78, 0xad, 0x90, 0xfe, 0xeb, 0xda, 0x3f, 0xc1,
+    0x6b, 0xf1, 0xf4, 0x4f, 0x7b, 0x15, 0x91, 0x8a, 0x06, 0x5e, 0x0a, 0x9a, 0x22, 0x31, 0x05, 0x24,
+    0x09, 0x23, 0x6a, 0x17, 0x19, 0x73, 0xe2, 0x53, 0xa9, 0x95, 0xa6, 0x51, 0x05, 0x75, 0x37, 0xdc,
+    0xa0, 0x22, 0xcd, 0xc8, 0x0e, 0xf4, 0x80, 0xa7, 0x44, 0x1b, 0xe2, 0x33, 0x29, 0xfb, 0x99, 0x04,
+    0xf1, 0x45, 0xfe, 0xf9, 0x49, 0xaf, 0x04, 0xe1, 0xc3, 0x93, 0x2f, 0x7b, 0xdb, 0x04, 0xf1, 0x46,
+    0x67, 0x19, 0x01, 0x7f, 0xa6, 0x3c, 0x20, 0x34, 0x1b, 0x97, 0xf8, 0x3f, 0x3f, 0xee, 0x59, 0xc0,
+    0xec, 0xd0, 0xfb, 0xa3, 0xf3, 0xc2, 0xd9, 0xc1, 0x6f, 0x16, 0xd3, 0xfb, 0xed, 0x46, 0xa5, 0xf1,
+    0x51, 0xea, 0x63, 0x2d, 0x88, 0xdc, 0x97, 0xd1, 0xfb, 0x2b, 0xcb, 0x93, 0xb0, 0xb2, 0x3c, 0x09,
+    0x87, 0x66, 0x73, 0xb0, 0x9c, 0x82, 0x1a, 0xb1, 0xf8, 0x6b, 0x33, 0x7c, 0xdf, 0x07, 0x83, 0xe9,
+    0x8e, 0x56, 0x07, 0x6d, 0xc5, 0x7b, 0x78, 0xc3, 0x42, 0x67, 0xad, 0xe6, 0xf2, 0x78, 0xdc, 0xa0,
+    0xe8, 0x6f, 0x2a, 0xda, 0xf5, 0x9e, 0x7f, 0xeb, 0x58, 0xaf, 0xd9, 0x4c, 0x6e, 0xb7, 0x3e, 0xf5,
+    0x0f, 0x66, 0xe8, 0x7f, 0xa2, 0xae, 0x70, 0x0a, 0xd8, 0xd6, 0xc7, 0xdd, 0xc1, 0xa8, 0xbb, 0xf9,
+    0xfa, 0x33, 0xea, 0xba, 0xff, 0x1a, 0x30, 0xff, 0x46, 0x60, 0xff, 0x89, 0xe3, 0x4f, 0xb2, 0xcd,
+    0x73, 0xd6, 0xd5, 0x21, 0x00, 0x00,
+};
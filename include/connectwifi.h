@@ -20,6 +20,7 @@
 #define WIFI_ERROR_CONNECT_TIMEOUT 604
 #define WIFI_ERROR_SCAN_TIMEOUT 605
 #define WIFI_RECONNECT_TIMER 606
+#define WIFI_FAST_CONNECTING 607
 
 #define WIFI_MAX_NO_OF_FAILED_SCANS 5
 
@@ -29,6 +30,12 @@
 #define WIFI_NO_OF_CONNECT_ATTEMPTS 3
 #define WIFI_MESSAGE_BUFFER_SIZE 120
 
+// details of the last connection used for a fast reconnect
+#define WIFI_CACHE_FILENAME "wificache"
+#define WIFI_CACHE_MAGIC 0x57494643
+#define WIFI_BSSID_LENGTH 6
+#define WIFI_FAST_CONNECT_TIMEOUT_MILLIS 5000
+
 #define WIFI_STATUS_OK_MESSAGE_NUMBER 1
 #define WIFI_STATUS_OK_MESSAGE_TEXT "WiFi connected OK"
 
@@ -48,6 +55,7 @@
 struct WifiConnectionSettings
 {
 	boolean wiFiOn;
+	boolean wifiFastConnect;
 	char wifi1SSID[WIFI_SSID_LENGTH];
 	char wifi1PWD[WIFI_PASSWORD_LENGTH];
 
@@ -89,4 +97,7 @@ bool syncConnectToAP(char *wifiSsid, char *wifiPassword);
 
 void beginWiFiScanning();
 
+// when the device last started to connect, used to time the connection
+unsigned long getWiFiConnectStartMillis();
+
 
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include <limits.h>
+
+#include "settings.h"
+#include "processes.h"
+
+#define IDLE_OK 1600
+#define IDLE_SLEEPING_OFF 1601
+#define IDLE_STOPPED 1602
+
+// the delay used at the end of each loop when idle sleep is turned off
+
+#define IDLE_LOOP_DELAY_MILLIS 5
+
+// returned by a deadline function that has nothing pending
+
+#define IDLE_NO_DEADLINE ULONG_MAX
+
+// the longest sleep either of the sleep settings can ask for
+
+#define IDLE_SLEEP_LIMIT_MILLIS 60000
+
+#define IDLE_MAX_NO_OF_DEADLINES 6
+#define IDLE_MAX_NO_OF_WAKE_PINS 4
+
+enum idleWakeReason
+{
+	idleWakeNone,
+	idleWakeTimer,
+	idleWakeInput,
+	idleWakeOther
+};
+
+struct IdleSettings
+{
+	bool idleSleepEnabled;
+	int idleMaxSleepMillis;
+	int idleMinSleepMillis;
+	bool idleLogWakes;
+};
+
+// A deadline function returns the number of milliseconds until it next
+// needs the loop to run, zero if it needs to run now or IDLE_NO_DEADLINE
+
+bool bindIdleDeadline(unsigned long (*millisToDeadline)(unsigned long currentMillis));
+
+bool bindIdleWakePin(int pinNo);
+
+unsigned long millisToNextIdleDeadline(unsigned long currentMillis);
+
+void idle();
+
+extern struct IdleSettings idleSettings;
+
+extern struct SettingItemCollection idleSettingItems;
+
+extern struct process idleProcess;
@@ -4,9 +4,56 @@
 #define MESSAGES_OK 400
 #define MESSAGES_STOPPED 401
 
+// size of the ring that holds queued message text when messages are
+// sent asynchronously. Messages that do not fit are dropped and counted.
+
+#ifndef MESSAGE_RING_SIZE
+#define MESSAGE_RING_SIZE 2048
+#endif
+
+#define MESSAGE_DRAIN_INTERVAL_MILLIS 5
+
+#define MAX_NO_OF_QUEUED_MESSAGE_HANDLERS 2
+// big enough for the longest message text any process sends, which is
+// the WiFi connected message built in a WIFI_MESSAGE_BUFFER_SIZE buffer.
+// Longer text is cut short and counted.
+#define QUEUED_MESSAGE_TEXT_LENGTH 120
+
+// one queue slot for each ledFlashBehaviour value
+#define NO_OF_MESSAGE_SEVERITIES 5
+
+// Log levels. Log calls below LOG_LEVEL compile to nothing so that
+// their arguments are not even evaluated. Set LOG_LEVEL in the build
+// flags to change this.
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Module tags. Each module has a bit in the runtime log module mask.
+
+#define LOG_MODULE_MQTT 0x01
+#define LOG_MODULE_WIFI 0x02
+#define LOG_MODULE_SENSORS 0x04
+#define LOG_MODULE_PROCESSES 0x08
+#define LOG_MODULE_HULLOS 0x10
+#define LOG_MODULE_SETTINGS 0x20
+#define LOG_MODULE_PIXELS 0x40
+#define LOG_MODULE_BOOT 0x80
+#define LOG_MODULE_ALL 0xFF
+
 struct MessagesSettings {
 	bool messagesEnabled;
 	bool speedMessagesEnabled;
+	bool asyncMessagesEnabled;
+	int logLevel;
+	int logModuleMask;
 };
 
 #pragma once
@@ -20,6 +67,44 @@ void displayMessage(const char* fmt, ...);
 void displayMessage(const String& s);
 
 void displayMessageWithNewline(const __FlashStringHelper* fmt, ...);
+
+// displays the message if the level and module are enabled at run time
+void logMessage(int level, int module, const __FlashStringHelper* fmt, ...);
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(module, fmt, ...) logMessage(LOG_LEVEL_DEBUG, module, F(fmt), ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(module, fmt, ...) do { } while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(module, fmt, ...) logMessage(LOG_LEVEL_INFO, module, F(fmt), ##__VA_ARGS__)
+#else
+#define LOG_INFO(module, fmt, ...) do { } while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(module, fmt, ...) logMessage(LOG_LEVEL_WARNING, module, F(fmt), ##__VA_ARGS__)
+#else
+#define LOG_WARNING(module, fmt, ...) do { } while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(module, fmt, ...) logMessage(LOG_LEVEL_ERROR, module, F(fmt), ##__VA_ARGS__)
+#else
+#define LOG_ERROR(module, fmt, ...) do { } while (0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(module, fmt, ...) logMessage(LOG_LEVEL_ERROR, module, F(fmt), ##__VA_ARGS__)
+#else
+#define LOG_ERROR(module, fmt, ...) do { } while (0)
+#endif
+
+const char *logLevelName(int level);
+int findLogLevelByName(const char *name);
+int findLogModuleByName(const char *name);
+void dumpLogSettings();
 void displayMessageWithNewline(const char* fmt, ...);
 void displayMessageWithNewline(const String& s);
 
@@ -30,8 +115,32 @@ void hardwareDisplayMessage(int messageNumber, ledFlashBehaviour flashBehaviour,
 
 void ledFlashBehaviourToString(ledFlashBehaviour severity, char * dest, int length);
 
+// writes out any queued message text - call this before a reboot
+void flushMessages();
+
+// Messages between these calls are kept in the ring and not sent. This
+// is used at boot while the serial port settles. Messages that don't fit
+// in the ring are dropped.
+void holdMessages();
+void releaseMessages();
+
+// Messages between these calls are written straight away, for example
+// when the console is responding to a command. Calls can be nested.
+void beginSynchronousMessages();
+void endSynchronousMessages();
+
 bool bindMessageHandler(void(*newHandler)(int messageNumber, ledFlashBehaviour severity, char* messageText));
 
+// A queued handler is not called by hardwareDisplayMessage. The latest
+// message of each severity is held for it until the process that owns
+// the handler calls deliverQueuedMessage from its update. This keeps
+// slow displays such as printers out of the code that raises messages.
+
+bool bindQueuedMessageHandler(void(*newHandler)(int messageNumber, ledFlashBehaviour severity, char* messageText));
+
+// delivers the oldest waiting message to the handler - returns false if there was nothing to deliver
+bool deliverQueuedMessage(void(*handler)(int messageNumber, ledFlashBehaviour severity, char* messageText));
+
 void messagesOff();
 
 void messagesOn();
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "settings.h"
+#include "processes.h"
+
+#define METRICS_OK 1800
+#define METRICS_PUBLISH_OFF 1801
+#define METRICS_STOPPED 1802
+
+#define METRICS_MAX_NO_OF_METRICS 48
+#define METRICS_MAX_HISTOGRAM_BUCKETS 8
+
+#define METRICS_TOPIC_LENGTH 30
+#define METRICS_JSON_BUFFER_SIZE 1500
+
+enum metricType
+{
+	metricTypeCounter,
+	metricTypeGauge,
+	metricTypeHistogram
+};
+
+// A histogram counts values into buckets. A value goes into the first
+// bucket whose limit it is below. Values above the last limit go into
+// an extra overflow bucket at the end.
+
+struct metricHistogram
+{
+	const unsigned long *bucketLimits;
+	int noOfLimits;
+	unsigned long counts[METRICS_MAX_HISTOGRAM_BUCKETS];
+	unsigned long noOfValues;
+	unsigned long maxValue;
+};
+
+struct MetricsSettings
+{
+	int metricsPublishSecs;
+	char metricsTopic[METRICS_TOPIC_LENGTH];
+};
+
+// Modules register their metrics once, usually from their init function.
+// Registering the same name twice is ignored.
+
+bool addCounterMetric(const char *name, unsigned long *counter);
+bool addGaugeMetric(const char *name, long (*readGauge)());
+bool addHistogramMetric(const char *name, struct metricHistogram *histogram);
+
+void recordMetricHistogram(struct metricHistogram *histogram, unsigned long value);
+
+// The sections of the metrics message. A message that doesn't fit in
+// METRICS_JSON_BUFFER_SIZE is sent as one message per section.
+
+#define METRICS_SECTION_COUNTERS 0x01
+#define METRICS_SECTION_GAUGES 0x02
+#define METRICS_SECTION_HISTOGRAMS 0x04
+#define METRICS_SECTION_TIMES 0x08
+#define METRICS_ALL_SECTIONS 0x0F
+
+// returns false if the json was cut off to fit the buffer
+
+bool createMetricsJson(char *buffer, int bufferLength, int sections);
+
+void dumpMetrics();
+
+extern struct MetricsSettings metricsSettings;
+
+extern struct SettingItemCollection metricsSettingItems;
+
+extern struct process metricsProcess;
@@ -23,14 +23,30 @@
 #define MQTT_ERROR_LOOP_FAILED 712
 #define MQTT_ERROR_NOT_CONFIGURED 713
 #define MQTT_ERROR_CONNECTION_TIMEOUT 714
+#define MQTT_CONNECTING 715
 
-#define MQTT_CONNECT_RETRY_INTERVAL_MSECS 60000
+// connection attempts are retried after mqttsecsperretry seconds, doubling
+// with each failure up to this limit
+#define MQTT_CONNECT_RETRY_MAX_MILLIS 300000
+
+// the WiFi is rescanned after this many failures in a row to reach the server
+#define MQTT_UNREACHABLE_BEFORE_WIFI_RESCAN 3
+
+// limits on the time each connection step can hold up the loop
+#define MQTT_NETWORK_CONNECT_TIMEOUT_MILLIS 3000
+#define MQTT_SESSION_CONNECT_TIMEOUT_SECS 3
 
 #define MQTT_USER_NAME_LENGTH 100
 #define MQTT_PASSWORD_LENGTH 200
 #define MQTT_TOPIC_LENGTH 150
 #define MQTT_TOPIC_PREFIX_LENGTH 100
 
+// prefix and topic joined together with a / after each
+#define MQTT_TOPIC_HEAD_LENGTH (MQTT_TOPIC_PREFIX_LENGTH + MQTT_TOPIC_LENGTH + 1)
+
+// prefix, topic and device name joined together
+#define MQTT_FULL_TOPIC_LENGTH (MQTT_TOPIC_PREFIX_LENGTH + MQTT_TOPIC_LENGTH + DEVICE_NAME_LENGTH)
+
 #define MQTT_NO_OF_RETRIES 3
 
 #define MQTT_STATUS_OK_MESSAGE_NUMBER 2
@@ -51,8 +67,37 @@
 #define MQTT_STATUS_PUBLISH_FAILED_MESSAGE_NUMBER 25
 #define MQTT_STATUS_PUBLISH_FAILED_MESSAGE_TEXT "MQTT publish failed"
 
+#define MQTT_STATUS_QUEUED_MESSAGE_NUMBER 26
+#define MQTT_STATUS_QUEUED_MESSAGE_TEXT "MQTT message queued"
+
+#define MQTT_STATUS_QUEUE_FULL_MESSAGE_NUMBER 27
+#define MQTT_STATUS_QUEUE_FULL_MESSAGE_TEXT "MQTT send queue full"
+
 #define MQTT_BUFFER_SIZE_MAX 2500
 
+// outgoing message queue and the journal that holds messages
+// while the connection is down
+
+#define MQTT_SEND_QUEUE_SIZE 3000
+#define MQTT_PUBLISH_BATCH_SIZE 4
+#define MQTT_PUBLISH_MAX_RETRIES 3
+#define MQTT_JOURNAL_FILENAME "mqttjournal"
+#define MQTT_JOURNAL_POS_FILENAME "mqttjournalpos"
+#define MQTT_JOURNAL_MAX_BYTES 16384
+#define MQTT_JOURNAL_RECORD_SIZE 600
+
+// sensor readings sent every mqttSecsPerUpdate seconds
+#define MQTT_TELEMETRY_BUFFER_SIZE 300
+
+// incoming message queue
+#define MQTT_RECEIVE_BUFFER_SIZE 1000
+#define MQTT_RECEIVE_TOPIC_SIZE 64
+#define NO_OF_MQTT_RECEIVE_BUFFERS 4
+#define MQTT_RECEIVE_MESSAGES_PER_UPDATE 2
+
+#define MQTT_LOAD_TEST_DEFAULT_MESSAGES 100
+#define MQTT_LOAD_TEST_MAX_MESSAGES 500
+
 struct MqttSettings
 {
 	char mqttDeviceName[DEVICE_NAME_LENGTH];
@@ -67,6 +112,10 @@ struct MqttSettings
 	char mqttTopicPrefix[MQTT_TOPIC_PREFIX_LENGTH];
 
 	int mqttSecsPerUpdate;
+	boolean mqttTelemetry;
+	boolean mqttTelemetryBinary;
+	boolean mqttTelemetryDelta;
+	int mqttKeyframeSends;
 	int seconds_per_mqtt_retry;
 	boolean mqtt_enabled;
 };
@@ -82,6 +131,8 @@ int publishBufferToMQTTTopic(char *buffer, char * topic);
 
 boolean validateMQTTtopic(void *dest, const char *newValueStr);
 
+void runMQTTLoadTest(int noOfMessages, int burstSize, const char *command);
+
 extern struct process MQTTProcessDescriptor;
 
 
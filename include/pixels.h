@@ -41,6 +41,7 @@ struct PixelSettings
 	int panelWidth;
 	int panelHeight;
 	float brightness;
+	float gamma;
 	char pixelName[MAX_PIXEL_NAME_LENGTH];
 };
 
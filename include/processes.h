@@ -12,6 +12,10 @@
 #define FIRST_SHUTDOWN_PROCESS 16
 #define SECOND_SHUTDOWN_PROCESS 32
 
+// started after the first pass through loop when fast boot is on
+
+#define DEFERRED_START_PROCESS 64
+
 #define STATUS_DESCRIPTION_LENGTH 200
 
 // If a process takes longer than this to complete an update
@@ -65,6 +69,7 @@ void initialiseAllProcesses();
 void startProcess(process *proc);
 struct process *startProcessByName(char *name);
 void startProcesses();
+void startDeferredProcesses();
 void updateProcesses();
 void dumpProcessStatus();
 bool dumpProcessStatusFiltered(const char * name);
@@ -74,6 +79,7 @@ void iterateThroughAllProcesses(void (*func)(process *p));
 void iterateThroughActiveProcesses(void (*func)(process *p));
 void stopProcesses();
 void iterateThroughProcessSettings(void (*func) (unsigned char * settings, int size));
+void iterateThroughProcessSettingStores(void (*func)(unsigned char *settings, int size, SettingItemCollection *s));
 void iterateThroughProcessSettingCollections(void (*func)(SettingItemCollection *s));
 void iterateThroughProcessSettings(void (*func)(SettingItem *s));
 void resetProcessesToDefaultSettings();
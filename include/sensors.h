@@ -19,6 +19,13 @@
 
 #define OPTION_STORAGE_SIZE 100
 
+// Polling offsets for the sensors that do slow reads. With the default
+// intervals of 100 millis these sensors are staggered so that they aren't
+// updated in the same loop. Other intervals can bring them together.
+
+#define BME280_POLL_OFFSET_MILLIS 50
+#define CLOCK_POLL_OFFSET_MILLIS 0
+
 // Received from MQTT and stored in settings - used to build commandMessageListener
 struct sensorListenerConfiguration{
 	char commandProcess [COMMAND_PROCESS_NAME_LENGTH];  // the process containing the command to be performed
@@ -63,6 +70,9 @@ struct sensor
 	boolean beingUpdated;  // active means that the sensor will be updated 
 	void * activeReading;
 	unsigned int activeTime;
+	unsigned long pollIntervalMillis;   // zero means the sensor is updated every time round the loop
+	unsigned long pollOffsetMillis;     // phase offset so that slow sensors are not all updated in the same tick
+	unsigned long millisAtLastPoll;
 	unsigned char* settingsStoreBase;
 	int settingsStoreLength;
 	struct SettingItemCollection* settingItems;
@@ -84,12 +94,40 @@ bool dumpSensorStatusFiltered(const char * name);
 
 void startSensorsReading();
 void updateSensors();
+bool sensorPollDue(struct sensor * s, unsigned long currentMillis);
+unsigned long millisToNextSensorPoll(unsigned long currentMillis);
 void createSensorJson(char * name, char * buffer, int bufferLength);
+
+// CBOR (RFC 8949) item types used for binary telemetry
+#define CBOR_MAJOR_UNSIGNED 0
+#define CBOR_MAJOR_NEGATIVE 1
+#define CBOR_MAJOR_TEXT 3
+#define CBOR_MAP_START 0xbf
+#define CBOR_FLOAT32 0xfa
+#define CBOR_BREAK 0xff
+
+enum sensorTelemetryEncoding
+{
+	sensorTelemetryJson,
+	sensorTelemetryCbor
+};
+
+int createSensorTelemetry(char * name, char * buffer, int bufferLength, sensorTelemetryEncoding encoding, bool changedOnly);
+
+// sensors move readingNumber on when they have a new value to send
+bool sensorReadingsChanged();
+void markSensorReadingsTransmitted();
+
+// used by the addReading function of each sensor
+void addSensorReadingInt(char * buffer, int bufferSize, const char * name, long value);
+void addSensorReadingFloat(char * buffer, int bufferSize, const char * name, float value);
+void addSensorReadingText(char * buffer, int bufferSize, const char * name, const char * value);
 void stopSensors();
 void iterateThroughSensors (void (*func) (sensor * s) );
 void iterateThroughSensorSettingCollections(void (*func) (SettingItemCollection* s));
 void iterateThroughSensorSettings(void (*func) (unsigned char* settings, int size));
 void iterateThroughSensorSettings(void (*func) (SettingItem* s));
+void iterateThroughSensorSettingStores(void (*func) (unsigned char* settings, int size, SettingItemCollection* s));
 void resetSensorsToDefaultSettings();
 SettingItem* FindSensorSettingByFormName(const char* settingName);
 void addMessageListenerToSensor(struct sensor *sensor, struct sensorListener * listener);
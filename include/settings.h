@@ -6,6 +6,21 @@
 
 #define SETTINGS_FILENAME "Settings.config"
 
+// Binary copy of the setting stores, loaded in preference to the text file
+
+#define SETTINGS_IMAGE_FILENAME "settings.bin"
+#define SETTINGS_IMAGE_MAGIC 0x53455449
+#define SETTINGS_IMAGE_VERSION 1
+
+// both settings files are written here and then renamed over the old file
+#define SETTINGS_TEMP_FILENAME "settings.tmp"
+
+// room for the CRC of each process and sensor settings store
+#define SETTINGS_MAX_NO_OF_STORES 64
+
+// changes are gathered up and saved this long after the first one
+#define SETTINGS_SAVE_DELAY_MILLIS 2000
+
 #ifdef DEFAULTS_ON
 
 #include "defaults.hsec"
@@ -74,8 +89,16 @@ struct SettingItemCollection
 
 enum processSettingCommandResult { displayedOK, setOK, settingNotFound, settingValueInvalid };
 
+// saveSettings requests a save, which is made by updateSettings after
+// the save delay or straight away by flushSettings
 void saveSettings();
+void flushSettings();
+void updateSettings();
 bool loadSettings();
+bool importSettingsFromFile(char *path);
+bool exportSettingsToFile(char *path);
+const char *getSettingsLoadSource();
+unsigned long getSettingsLoadMicros();
 void resetSettings();
 void PrintAllSettings();
 void PrintSomeSettings(char * filter);
@@ -83,6 +106,7 @@ void DumpAllSettings();
 void DumpSomeSettings(char * filter);
 void PrintStorage();
 void printSetting(SettingItem *item);
+void printSettingValue(SettingItem *item, char *buffer, int bufferLength);
 
 SettingItem* findSettingByName(const char* settingName);
 
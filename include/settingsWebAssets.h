@@ -0,0 +1,23 @@
+#pragma once
+
+// Generated by compressWebPages.py from src/settingsWebStyle.css - do not edit
+
+#define SETTINGS_WEB_STYLE_GZIP_LENGTH 212
+#define SETTINGS_WEB_STYLE_HASH "b466a752"
+
+const uint8_t settingsWebStyleGzip[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x8f, 0xb1, 0x8e, 0xc2, 0x30,
+    0x0c, 0x86, 0xe7, 0xe6, 0x29, 0xbc, 0xa0, 0x2e, 0xa9, 0x04, 0x3d, 0xba, 0x14, 0x31, 0xb0, 0xf1,
+    0x0e, 0x88, 0xc1, 0x77, 0x75, 0x89, 0xa5, 0x90, 0x46, 0x89, 0xa1, 0x05, 0xc4, 0xbb, 0x5f, 0x49,
+    0x0f, 0xe9, 0xee, 0x36, 0x18, 0x6d, 0xff, 0xfe, 0xfc, 0x79, 0x27, 0x17, 0x4f, 0xeb, 0x3c, 0x60,
+    0xc3, 0x5d, 0xbe, 0x87, 0x9b, 0xca, 0x0c, 0xf1, 0xc1, 0x48, 0x0d, 0xe5, 0xb9, 0x5f, 0xa9, 0xac,
+    0xe7, 0x46, 0xcc, 0xb3, 0x38, 0x62, 0x38, 0xb0, 0x2b, 0x2c, 0xb5, 0xe3, 0x7c, 0x39, 0xf7, 0xc3,
+    0x4a, 0xdd, 0x95, 0x62, 0xe7, 0x4f, 0xa2, 0xc1, 0x6b, 0x40, 0x0d, 0x16, 0x3f, 0xc9, 0x3e, 0x30,
+    0x53, 0xb6, 0x86, 0xca, 0x0f, 0x80, 0x27, 0xe9, 0xc6, 0xf5, 0xb6, 0x73, 0x52, 0x44, 0xbe, 0x52,
+    0x0d, 0x1f, 0x89, 0x97, 0x1a, 0x2d, 0x1e, 0xd9, 0x5e, 0x6a, 0xd8, 0x04, 0x46, 0xab, 0x61, 0x4b,
+    0xf6, 0x4c, 0xc2, 0x5f, 0x23, 0x2b, 0xa2, 0x8b, 0x45, 0xa4, 0xc0, 0x6d, 0xba, 0xb3, 0x9b, 0x54,
+    0x85, 0x06, 0xc9, 0xf7, 0x1a, 0x7e, 0x4a, 0x8f, 0x31, 0xf6, 0x5d, 0x68, 0x26, 0xf9, 0x3f, 0x86,
+    0x65, 0x32, 0xcc, 0x2c, 0x3b, 0x2a, 0x9e, 0x5f, 0x55, 0xf3, 0x59, 0x82, 0x99, 0xc5, 0x23, 0xfe,
+    0xcb, 0xa8, 0x7a, 0xc3, 0xc8, 0x94, 0xff, 0x20, 0xcb, 0xd7, 0x21, 0xdf, 0x52, 0xa7, 0x66, 0xb4,
+    0x81, 0x01, 0x00, 0x00,
+};
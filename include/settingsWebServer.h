@@ -10,6 +10,9 @@
 #define SETTINGS_ACCESS_POINT_SSID "CLB_SETUP"
 #define SETTINGS_MDNS_NAME "clb"
 
+// size of the buffer that settings pages are written into and sent from
+#define SETTINGS_PAGE_CHUNK_SIZE 512
+
 void startHostingConfigWebsite(bool timeout);
 
 #endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #pragma GCC diagnostic ignored "-Wwrite-strings"
 
+#include <stdint.h>
+
 #include "debug.h"
 
 int localRand();
@@ -13,6 +15,8 @@ int srtcasecmp(const char *string1, const char *string2);
 
 unsigned long ulongDiff(unsigned long end, unsigned long start);
 
+uint32_t calculateCRC32(uint32_t crc, const uint8_t *data, int length);
+
 bool strContains(char* searchMe,char* findMe);
 
 int getUnalignedInt(unsigned char * source);
@@ -106,6 +110,8 @@ void strip_end(char *str, int n);
 
 File fileOpen(const char * path, char * mode);
 
+bool fileRename(const char * from, const char * to);
+
 bool fileExists(char * path);
 
 void saveToFile(char * path, char * src);
@@ -176,6 +176,21 @@ struct SettingItem BME280HumidNormMax = {
 	setDefaultEnvHumidNormMax,
 	validateFloat};
 
+void setDefaultBME280PollInterval(void *dest)
+{
+	int *destInt = (int *)dest;
+	*destInt = BME280_DEFAULT_POLL_INTERVAL_MILLIS;
+}
+
+struct SettingItem BME280PollInterval = {
+	"Millis between sensor reads (0 for every loop)",
+	"bme280pollmillis",
+	&bme280SensorSettings.pollIntervalMillis,
+	NUMBER_INPUT_LENGTH,
+	integerValue,
+	setDefaultBME280PollInterval,
+	validateInt};
+
 struct SettingItem *bme280SensorSettingItemPointers[] =
 	{
 		&bme280SensorFittedSetting,
@@ -189,6 +204,7 @@ struct SettingItem *bme280SensorSettingItemPointers[] =
 		&BME280HumidNormMin,
 		&BME280HumidNormMax,
 		&envNoOfAveragesSetting,
+		&BME280PollInterval,
 };
 
 struct SettingItemCollection bme280SensorSettingItems = {
@@ -430,13 +446,16 @@ void updateBME280Sensor()
 		bme280activeReading->humidity = bme.readHumidity();
 		bme280activeReading->pressure = bme.readPressure() / 100.0F;
 		bme280Sensor.millisAtLastReading = millis();
-		bme280Sensor.readingNumber++;
 		updateEnvAverages(bme280activeReading);
 	}
 
 	bme280Sensor.millisAtLastReading = millis();
 
-	// always send a changed event when we first start up
+	// The reading number only moves on when an average has changed by more
+	// than its delta, so that delta telemetry leaves out a steady sensor.
+	// Always send a changed event when we first start up.
+
+	bool readingChanged = false;
 
 	if ((fabsf(bme280activeReading->lastHumidSent - bme280activeReading->humidityAverage) > bme280SensorSettings.humidDelta)||
 	BME280firstRun)
@@ -444,6 +463,7 @@ void updateBME280Sensor()
 		TRACELOGLN("Humidity change:");
 		sendToBME280SensorListeners(BME280_ON_CHANGE, BME280_HUMID);
 		bme280activeReading->lastHumidSent = bme280activeReading->humidityAverage;
+		readingChanged = true;
 	}
 
 	if ((fabsf(bme280activeReading->lastTempSent - bme280activeReading->temperatureAverage) > bme280SensorSettings.tempDelta)||
@@ -452,6 +472,7 @@ void updateBME280Sensor()
 		TRACELOGLN("Temp change:");
 		sendToBME280SensorListeners(BME280_ON_CHANGE, BME280_TEMP);
 		bme280activeReading->lastTempSent = bme280activeReading->temperatureAverage;
+		readingChanged = true;
 	}
 
 	if ((fabsf(bme280activeReading->lastPressSent - bme280activeReading->pressureAverage) > bme280SensorSettings.pressDelta)||
@@ -460,10 +481,16 @@ void updateBME280Sensor()
 		TRACELOGLN("Press change:");
 		sendToBME280SensorListeners(BME280_ON_CHANGE, BME280_PRESS);
 		bme280activeReading->lastPressSent = bme280activeReading->pressureAverage;
+		readingChanged = true;
 		// clear the first run flag
 		BME280firstRun=false;
 	}
 
+	if (readingChanged)
+	{
+		bme280Sensor.readingNumber++;
+	}
+
 	if (lastClockSecond == clockReading->second)
 	{
 		return;
@@ -513,6 +540,15 @@ void startBME280Sensor()
 {
 	BME280firstRun=true;
 
+	if (bme280SensorSettings.pollIntervalMillis > 0)
+	{
+		bme280Sensor.pollIntervalMillis = bme280SensorSettings.pollIntervalMillis;
+	}
+	else
+	{
+		bme280Sensor.pollIntervalMillis = 0;
+	}
+
 	if (!bme280SensorSettings.bme280SensorFitted)
 	{
 		bme280Sensor.status = BME280SENSOR_NOT_FITTED;
@@ -585,10 +621,9 @@ void addBME280SensorReading(char *jsonBuffer, int jsonBufferSize)
 
 		if (ulongDiff(millis(), bme280SensoractiveReading->lastEnvqAverageMillis) < ENV_READING_LIFETIME_MSECS)
 		{
-			appendFormattedString(jsonBuffer, jsonBufferSize, ",\"temp\":%.2f,\"humidity\":%.2f,\"pressure\":%.2f",
-					 bme280SensoractiveReading->temperatureAverage,
-					 bme280SensoractiveReading->humidityAverage,
-					 bme280SensoractiveReading->pressureAverage);
+			addSensorReadingFloat(jsonBuffer, jsonBufferSize, "temp", bme280SensoractiveReading->temperatureAverage);
+			addSensorReadingFloat(jsonBuffer, jsonBufferSize, "humidity", bme280SensoractiveReading->humidityAverage);
+			addSensorReadingFloat(jsonBuffer, jsonBufferSize, "pressure", bme280SensoractiveReading->pressureAverage);
 		}
 	}
 }
@@ -637,6 +672,9 @@ struct sensor bme280Sensor = {
 	false, // being updated
 	NULL,  // active reading - set in setup
 	0,	   // active time
+	0,	   // poll interval - set from settings when the sensor starts
+	BME280_POLL_OFFSET_MILLIS, // poll offset
+	0,	   // millis at last poll
 	(unsigned char *)&bme280SensorSettings,
 	sizeof(struct BME280SensorSettings),
 	&bme280SensorSettingItems,
@@ -17,22 +17,25 @@ Frame::Frame(Leds *inLeds, Colour inBackground)
 	noOfBrightnessSteps = 0;
 	brightness = 0;
 	colourBackSteps=0;
+	frameChanged = true;
 
-	for (int i = 0; i < MAX_NO_OF_SPRITES; i++)
+#ifdef PIXELS_LARGE_SPRITE_STORE
+	int noOfSprites = (noOfPixels / 4) + 1;
+
+	if (noOfSprites < MIN_NO_OF_SPRITES)
 	{
-		sprites[i] = new Sprite(this);
+		noOfSprites = MIN_NO_OF_SPRITES;
 	}
-}
-
-Sprite *Frame::getSprite(int spriteNo)
-{
 
-	if (spriteNo >= MAX_NO_OF_SPRITES || spriteNo < 0)
+	if (noOfSprites > MAX_NO_OF_SPRITES)
 	{
-		return NULL;
+		noOfSprites = MAX_NO_OF_SPRITES;
 	}
+#else
+	int noOfSprites = DEFAULT_NO_OF_SPRITES;
+#endif
 
-	return sprites[spriteNo];
+	sprites = new Sprites(noOfSprites);
 }
 
 void Frame::overlayColour(Colour col, int timeMins)
@@ -40,6 +43,7 @@ void Frame::overlayColour(Colour col, int timeMins)
 	overlay = col;
 	overlayActive = true;
 	overlayEndTicks = millis() + ((60 * timeMins)*1000);
+	frameChanged = true;
 }
 
 void Frame::render()
@@ -47,18 +51,13 @@ void Frame::render()
 	leds->clear(background);
 
  	if(overlayActive){
-		for (int i = 0; i < MAX_NO_OF_SPRITES; i++)
-		{
-			sprites[i]->renderColour(overlay);
-		}
+		sprites->renderColour(leds, overlay);
 	}
 	else {
-		for (int i = 0; i < MAX_NO_OF_SPRITES; i++)
-		{
-			sprites[i]->render();
-		}
+		sprites->render(leds);
 	}
 	leds->display(brightness);
+	frameChanged = false;
 }
 
 void Frame::dump()
@@ -70,10 +69,7 @@ void Frame::dump()
 
 	leds->dump();
 
-	for (int i = 0; i < MAX_NO_OF_SPRITES; i++)
-	{
-		sprites[i]->dump();
-	}
+	sprites->dump();
 }
 
 void Frame::update()
@@ -81,6 +77,7 @@ void Frame::update()
 
 	if(colourBackSteps>0)
 	{
+		frameChanged = true;
 		background.Red = background.Red + redBackStep;
 		background.Blue = background.Blue + blueBackStep;
 		background.Green = background.Green + greenBackStep;
@@ -90,13 +87,14 @@ void Frame::update()
 		}
 	}
 
-	for (int i = 0; i < MAX_NO_OF_SPRITES; i++)
+	if (sprites->update(width, height))
 	{
-		sprites[i]->update();
+		frameChanged = true;
 	}
 
 	if (noOfBrightnessSteps != 0)
 	{
+		frameChanged = true;
 		brightness += brightnessStep;
 		noOfBrightnessSteps--;
 		if (noOfBrightnessSteps == 0)
@@ -108,6 +106,7 @@ void Frame::update()
 	if(overlayActive){
 		if(millis()>overlayEndTicks){
 			overlayActive = false;
+			frameChanged = true;
 		}
 	}
 }
@@ -129,19 +128,20 @@ void Frame::fadeToColour(Colour target, int noOfSteps)
 		noOfSteps = 10;
 	}
 
-	for (int i = 0; i < MAX_NO_OF_SPRITES; i++)
+	for (int i = 0; i < sprites->noOfSprites; i++)
 	{
-		sprites[i]->fadeToColour(target, noOfSteps);
+		sprites->fadeToColour(i, target, noOfSteps);
 	}
 }
 
 
 void Frame::setColour(Colour target)
 {
-	for (int i = 0; i < MAX_NO_OF_SPRITES; i++)
+	for (int i = 0; i < sprites->noOfSprites; i++)
 	{
-		sprites[i]->setColour(target);
+		sprites->setColour(i, target);
 	}
+	frameChanged = true;
 }
 
 void Frame::fadeBackToColour(Colour target, int noOfSteps)
@@ -161,6 +161,7 @@ void Frame::fadeBackToColour(Colour target, int noOfSteps)
 void Frame::setBackColour(Colour target)
 {
 	background = target;
+	frameChanged = true;
 }
 
 void Frame::fadeToBrightness(float inTargetBrightness, int noOfSteps)
@@ -201,28 +202,26 @@ void Frame::fadeSpritesToColourCharMask(char *colourMask, int steps)
 
 	int pixelLimit;
 
-	if (MAX_NO_OF_SPRITES > noOfPixels)
+	if (sprites->noOfSprites > noOfPixels)
 	{
 		pixelLimit = noOfPixels;
 	}
 	else
 	{
-		pixelLimit = MAX_NO_OF_SPRITES;
+		pixelLimit = sprites->noOfSprites;
 	}
 
 	for (int i = 0; i < pixelLimit; i++)
 	{
-		Sprite *sprite = sprites[i];
-
 		float newX = row + 0.5;
 		float newY = col + 0.5;
 		// move to the specified position and then stop
-		sprite->moveToPosition(newX, newY, steps, Sprite::SPRITE_STOPPED);
-		sprite->enabled = true;
-		sprite->fadeToBrightness(1, steps);
-		sprite->opacity = 1.0;
+		sprites->moveToPosition(i, newX, newY, steps, Sprites::SPRITE_STOPPED);
+		sprites->enable(i);
+		sprites->fadeToBrightness(i, 1, steps);
+		sprites->opacity[i] = 1.0;
 
-		setTargetColour(*pos, sprite, steps);
+		setTargetColour(*pos, i, steps);
 
 		pos++;
 
@@ -243,10 +242,8 @@ void Frame::fadeSpritesToColourCharMask(char *colourMask, int steps)
 
 void Frame::disableAllSprites()
 {
-	for (int i = 0; i < MAX_NO_OF_SPRITES; i++)
-	{
-		sprites[i]->enabled = false;
-	}
+	sprites->disableAll();
+	frameChanged = true;
 }
 
 int Frame::getNumberOfActiveSprites()
@@ -258,15 +255,15 @@ int Frame::getNumberOfActiveSprites()
 
 	int activeSprites = (int)round(noOfPixels / 4) + 1;
 
-	if (activeSprites > MAX_NO_OF_SPRITES)
+	if (activeSprites > sprites->noOfSprites)
 	{
-		activeSprites = MAX_NO_OF_SPRITES;
+		activeSprites = sprites->noOfSprites;
 	}
 
 	return activeSprites;
 }
 
-void Frame::setTargetColour(char ch, Sprite *s, int steps)
+void Frame::setTargetColour(char ch, int spriteNo, int steps)
 {
 	switch (ch)
 	{
@@ -274,7 +271,7 @@ void Frame::setTargetColour(char ch, Sprite *s, int steps)
 		// A colour of * means "set a random colour for this sprite"
 		{
 			struct colourNameLookup *newColour = findRandomColour();
-			s->fadeToColour(newColour->col, steps);
+			sprites->fadeToColour(spriteNo, newColour->col, steps);
 		}
 		break;
 	case '+':
@@ -285,7 +282,7 @@ void Frame::setTargetColour(char ch, Sprite *s, int steps)
 		colourCharLookup *colour = findColourByChar(ch);
 		if (colour != NULL)
 		{
-			s->fadeToColour(colour->col, steps);
+			sprites->fadeToColour(spriteNo, colour->col, steps);
 		}
 		break;
 	}
@@ -301,9 +298,9 @@ void Frame::fadeSpritesToWalkingColours(char *colours, int steps)
 	int noOfSprites = getNumberOfActiveSprites();
 
 	// fade out and disable all the sprites we aren't using
-	for(int i=noOfSprites; i< MAX_NO_OF_SPRITES; i++)
+	for(int i=noOfSprites; i< sprites->noOfSprites; i++)
 	{
-		sprites[i]->fadeToBrightness(0,steps);
+		sprites->fadeToBrightness(i,0,steps);
 	}
 
 	float pixelSpaceBetweenSprites = noOfPixels / noOfSprites;
@@ -318,27 +315,26 @@ void Frame::fadeSpritesToWalkingColours(char *colours, int steps)
 
 	for (int i = 0; i < noOfSprites; i++)
 	{
-		Sprite *s = sprites[i];
-		s->moveToPosition(x + 0.5, y + 0.5, steps, Sprite::SPRITE_WRAP);
+		sprites->moveToPosition(i, x + 0.5, y + 0.5, steps, Sprites::SPRITE_WRAP);
 
 		if(random(0,2)==1)
-			s->xSpeed = speed;
+			sprites->xSpeed[i] = speed;
 		else
-			s->xSpeed = -speed;
+			sprites->xSpeed[i] = -speed;
 		speed = speed + speedStep;
 		if(random(0,2)==1){
-			s->ySpeed = speed;
+			sprites->ySpeed[i] = speed;
 		}
 		else{
-			s->ySpeed = -speed;
+			sprites->ySpeed[i] = -speed;
 		}
 		speed = speed + speedStep;
-		s->enabled = true;
+		sprites->enable(i);
 		
-		s->fadeToBrightness(1,steps);
-		s->opacity = 1;
+		sprites->fadeToBrightness(i,1,steps);
+		sprites->opacity[i] = 1;
 
-		setTargetColour(*colourChar, s, steps);
+		setTargetColour(*colourChar, i, steps);
 
 		colourChar++;
 
@@ -364,7 +360,7 @@ void Frame::fadeSpritesToTwinkle(int steps)
 	for (int i = 0; i < MAX_NO_OF_SPRITESToTwinkle; i++)
 	{
 		struct colourNameLookup *newColour = findRandomColour();
-		sprites[i]->fadeToColour(newColour->col, steps);
+		sprites->fadeToColour(i, newColour->col, steps);
 	}
 }
 
@@ -379,17 +375,15 @@ void Frame::setSpriteSpeed(float inSpeed)
 
 	for (int i = 0; i < noOfSprites; i++)
 	{
-		Sprite *s = sprites[i];
-
 		if(random(0,2)==1)
-			s->xSpeed = speed;
+			sprites->xSpeed[i] = speed;
 		else
-			s->xSpeed = -speed;
+			sprites->xSpeed[i] = -speed;
 		speed = speed + speedStep;
 		if(random(0,2)==1)
-			s->ySpeed = speed;
+			sprites->ySpeed[i] = speed;
 		else
-			s->ySpeed = -speed;
+			sprites->ySpeed[i] = -speed;
 		speed = speed + speedStep;
 	}
 }
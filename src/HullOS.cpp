@@ -14,6 +14,7 @@
 #include "console.h"
 #include "PythonIsh.h"
 #include "messages.h"
+#include "idle.h"
 
 struct HullOSSettings hullosSettings;
 
@@ -202,6 +203,7 @@ void initHullOS()
 {
     stopLanguageDecoding();
     hullosProcess.status = HULLOS_STOPPED;
+    bindIdleDeadline(millisToNextProgramStep);
 }
 
 void startHullOS()
@@ -18,6 +18,8 @@
 #include "HullOSCommands.h"
 #include "HullOSVariables.h"
 #include "HullOSScript.h"
+#include "idle.h"
+#include "boot.h"
 #include "HullOS.h"
 #include "RockStar.h"
 #include "PythonIsh.h"
@@ -3218,18 +3220,52 @@ void remoteSoundPlay()
     }
 }
 
+void (*programOutputHandler)(const char *text) = NULL;
+
+bool bindProgramOutputHandler(void (*handler)(const char *text))
+{
+    programOutputHandler = handler;
+    return true;
+}
+
+void sendProgramOutput(const char *text)
+{
+    displayMessage(F("%s"), text);
+
+    if (programOutputHandler != NULL)
+    {
+        programOutputHandler(text);
+    }
+}
+
 void doRemoteWriteText()
 {
+    char outputBuffer[PROGRAM_OUTPUT_BUFFER_SIZE];
+    int outputPos = 0;
+
     while (*decodePos != STATEMENT_TERMINATOR & decodePos != decodeLimit)
     {
-        displayMessage(F("%c"), *decodePos);
+        if (outputPos == PROGRAM_OUTPUT_BUFFER_SIZE - 1)
+        {
+            outputBuffer[outputPos] = 0;
+            sendProgramOutput(outputBuffer);
+            outputPos = 0;
+        }
+        outputBuffer[outputPos++] = *decodePos;
         decodePos++;
     }
+
+    outputBuffer[outputPos] = 0;
+
+    if (outputPos > 0)
+    {
+        sendProgramOutput(outputBuffer);
+    }
 }
 
 void doRemoteWriteLine()
 {
-    displayMessage(F("\n"));
+    sendProgramOutput("\n");
 }
 
 void doRemotePrintValue()
@@ -3238,7 +3274,9 @@ void doRemotePrintValue()
 
     if (getValue(&valueToPrint))
     {
-        displayMessage(F("%d"), valueToPrint);
+        char outputBuffer[PROGRAM_OUTPUT_BUFFER_SIZE];
+        snprintf(outputBuffer, PROGRAM_OUTPUT_BUFFER_SIZE, "%d", valueToPrint);
+        sendProgramOutput(outputBuffer);
     }
 }
 
@@ -3309,6 +3347,8 @@ void buildAndExecuteConsoleCommand(){
 
 void hullOSExecuteStatement(char *commandDecodePos, char *comandDecodeLimit)
 {
+    recordBootFirstWork("HullOS statement");
+
     decodePos = commandDecodePos;
     decodeLimit = comandDecodeLimit;
 
@@ -3519,6 +3559,26 @@ void programStatus(char *buffer, int bufferLength)
     }
 }
 
+// deadline for the idle sleep - a running program must not be held up
+
+unsigned long millisToNextProgramStep(unsigned long currentMillis)
+{
+    switch (programState)
+    {
+    case PROGRAM_STOPPED:
+    case PROGRAM_PAUSED:
+        return IDLE_NO_DEADLINE;
+    case PROGRAM_AWAITING_DELAY_COMPLETION:
+        if (currentMillis > delayEndTime)
+        {
+            return 0;
+        }
+        return delayEndTime - currentMillis;
+    default:
+        return 0;
+    }
+}
+
 void updateRunningProgram()
 {
     // If we receive serial data the program that is running
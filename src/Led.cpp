@@ -6,6 +6,57 @@ Led::Led()
 	Reset();
 }
 
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+
+void Led::Reset()
+{
+	red = 0;
+	green = 0;
+	blue = 0;
+}
+
+void Led::SetColourValues(unsigned char r, unsigned char g, unsigned char b)
+{
+	red = r;
+	green = g;
+	blue = b;
+}
+
+// opacity is in 256ths - 256 replaces the existing colour
+
+void Led::AddColourValues(unsigned char r, unsigned char g, unsigned char b, int opacity)
+{
+	int newRed, newGreen, newBlue;
+
+	if (opacity >= 256) {
+		newRed = red + r;
+		newGreen = green + g;
+		newBlue = blue + b;
+	}
+	else {
+		int trans = 256 - opacity;
+		newRed = ((red * trans + 128) >> 8) + r;
+		newGreen = ((green * trans + 128) >> 8) + g;
+		newBlue = ((blue * trans + 128) >> 8) + b;
+	}
+
+	if (newRed > 255) newRed = 255;
+	red = newRed;
+
+	if (newGreen > 255) newGreen = 255;
+	green = newGreen;
+
+	if (newBlue > 255) newBlue = 255;
+	blue = newBlue;
+}
+
+bool Led::IsBlack()
+{
+	return red == 0 && green == 0 && blue == 0;
+}
+
+#else
+
 void Led::Reset()
 {
 	colour.Red = 0;
@@ -69,3 +120,4 @@ void Led::ReplceColour(Colour colour, float fraction) {
 	colour.Blue = newVal;
 }
 
+#endif
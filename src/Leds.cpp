@@ -3,65 +3,214 @@
 
 bool close_to(float a, float b);
 
-Leds::Leds(int inWidth, int inHeight, 
+Leds::Leds(int inWidth, int inHeight,
+			const int *inRasterLookup,
 			void (*inShow)(),
-			void (*inSetPixel)(int no, float r, float g, float b))
+			void (*inSetPixel)(int no, pixelChannel r, pixelChannel g, pixelChannel b))
 {
 	ledWidth = inWidth;
 	ledHeight = inHeight;
+	noOfLeds = ledWidth * ledHeight;
 
 	normWidth = 1.0; // width of display is always 1
 	normHeight = (float)ledHeight / (float)ledWidth;
 
+	rasterLookup = inRasterLookup;
 	show = inShow;
 	setPixel = inSetPixel;
 
-	leds = new Led *[ledWidth];
+	leds = new Led[noOfLeds];
 
-	for (int i = 0; i < ledWidth; i++)
+	outputBuffer = NULL;
+	setGamma(1);
+}
+
+// converts a value between 0 and 1 into 256ths
+
+int fractionTo256(float value)
+{
+	if (value <= 0)
+		return 0;
+	if (value >= 1)
+		return 256;
+	return (int)(value * 256 + 0.5);
+}
+
+unsigned char colourToByte(float value)
+{
+	if (value <= 0)
+		return 0;
+	if (value >= 1)
+		return 255;
+	return (unsigned char)(value * 255 + 0.5);
+}
+
+void Leds::setOutputBuffer(unsigned char *buffer, int redOffset, int greenOffset, int blueOffset, int bytesPerPixel)
+{
+	outputBuffer = buffer;
+	outputRedOffset = redOffset;
+	outputGreenOffset = greenOffset;
+	outputBlueOffset = blueOffset;
+	outputBytesPerPixel = bytesPerPixel;
+}
+
+// the gamma curve is only worked out here - changes of brightness
+// just scale this table
+
+void Leds::setGamma(float gamma)
+{
+	for (int i = 0; i < 256; i++)
 	{
-		leds[i] = new Led[ledHeight];
+		if (gamma == 1)
+		{
+			gammaTable[i] = i;
+		}
+		else
+		{
+			gammaTable[i] = colourToByte(pow(i / 255.0, gamma));
+		}
 	}
+
+	outputTableBrightness = -1;
 }
 
-void Leds::display(float brightness)
+void Leds::writeOutputBuffer(float brightness)
 {
-	int ledNo = 0;
-	for (int y = 0; y < ledHeight; y++)
+	int brightness256 = fractionTo256(brightness);
+
+	if (brightness256 != outputTableBrightness)
 	{
-		for (int x = 0; x < ledWidth; x++)
+		for (int i = 0; i < 256; i++)
 		{
-			float r = (leds[x][y].colour.Red * brightness);
-			float g = (leds[x][y].colour.Green * brightness);
-			float b = (leds[x][y].colour.Blue * brightness);
-			setPixel(ledNo, r, g, b);
-			ledNo++;
+			outputTable[i] = (gammaTable[i] * brightness256 + 128) >> 8;
 		}
+		outputTableBrightness = brightness256;
+	}
+
+	Led *led = leds;
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
+	{
+		unsigned char *dest = outputBuffer + (rasterLookup[ledNo] * outputBytesPerPixel);
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+		dest[outputRedOffset] = outputTable[led->red];
+		dest[outputGreenOffset] = outputTable[led->green];
+		dest[outputBlueOffset] = outputTable[led->blue];
+#else
+		dest[outputRedOffset] = outputTable[colourToByte(led->colour.Red)];
+		dest[outputGreenOffset] = outputTable[colourToByte(led->colour.Green)];
+		dest[outputBlueOffset] = outputTable[colourToByte(led->colour.Blue)];
+#endif
+		led++;
+	}
+}
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+
+#define LEDS_POSITION_ONE 4096L
+
+void Leds::display(float brightness)
+{
+	if (outputBuffer != NULL)
+	{
+		writeOutputBuffer(brightness);
+		show();
+		return;
+	}
+
+	// scale once per frame rather than once per channel
+
+	int brightness256 = fractionTo256(brightness);
+
+	Led *led = leds;
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
+	{
+		unsigned char r = (led->red * brightness256 + 128) >> 8;
+		unsigned char g = (led->green * brightness256 + 128) >> 8;
+		unsigned char b = (led->blue * brightness256 + 128) >> 8;
+		setPixel(rasterLookup[ledNo], r, g, b);
+		led++;
 	}
 	show();
 }
 
 void Leds::clear(Colour colour)
 {
-	for (int y = 0; y < ledHeight; y++)
+	unsigned char r = colourToByte(colour.Red);
+	unsigned char g = colourToByte(colour.Green);
+	unsigned char b = colourToByte(colour.Blue);
+
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
 	{
-		for (int x = 0; x < ledWidth; x++)
+		leds[ledNo].SetColourValues(r, g, b);
+	}
+}
+
+void Leds::wash(Colour colour)
+{
+	unsigned char r = colourToByte(colour.Red);
+	unsigned char g = colourToByte(colour.Green);
+	unsigned char b = colourToByte(colour.Blue);
+
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
+	{
+		if (leds[ledNo].IsBlack())
 		{
-			leds[x][y].colour = colour;
+			leds[ledNo].SetColourValues(r, g, b);
 		}
 	}
 }
 
+void Leds::dump()
+{
+	displayMessage(F("Leds width:%d height:%d\n  "), ledWidth, ledHeight);
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
+	{
+		displayMessage(F("     r:%d g:%d b:%d\n"),
+					  leds[ledNo].red,
+					  leds[ledNo].green,
+					  leds[ledNo].blue);
+	}
+	displayMessage(F("\n"));
+}
+
+#else
+
+void Leds::display(float brightness)
+{
+	if (outputBuffer != NULL)
+	{
+		writeOutputBuffer(brightness);
+		show();
+		return;
+	}
+
+	Led *led = leds;
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
+	{
+		float r = (led->colour.Red * brightness);
+		float g = (led->colour.Green * brightness);
+		float b = (led->colour.Blue * brightness);
+		setPixel(rasterLookup[ledNo], r, g, b);
+		led++;
+	}
+	show();
+}
+
+void Leds::clear(Colour colour)
+{
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
+	{
+		leds[ledNo].colour = colour;
+	}
+}
+
 void Leds::wash(Colour colour)
 {
-	for (int y = 0; y < ledHeight; y++)
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
 	{
-		for (int x = 0; x < ledWidth; x++)
-		{
-			Colour led = leds[x][y].colour;
-			if(led.Red==0 && led.Blue==0 && led.Green==0){
-				leds[x][y].colour = colour;
-			}
+		Colour led = leds[ledNo].colour;
+		if(led.Red==0 && led.Blue==0 && led.Green==0){
+			leds[ledNo].colour = colour;
 		}
 	}
 }
@@ -70,19 +219,18 @@ void Leds::wash(Colour colour)
 void Leds::dump()
 {
 	displayMessage(F("Leds width:%d height:%d\n  "), ledWidth, ledHeight);
-	for (int y = 0; y < ledHeight; y++)
+	for (int ledNo = 0; ledNo < noOfLeds; ledNo++)
 	{
-		for (int x = 0; x < ledWidth; x++)
-		{
-			displayMessage(F("     r:%f g:%f b:%f\n"),
-						  leds[x][y].colour.Red,
-						  leds[x][y].colour.Green,
-						  leds[x][y].colour.Blue);
-		}
+		displayMessage(F("     r:%f g:%f b:%f\n"),
+					  leds[ledNo].colour.Red,
+					  leds[ledNo].colour.Green,
+					  leds[ledNo].colour.Blue);
 	}
 	displayMessage(F("\n"));
 	}
 
+#endif
+
 
 
 void Leds::renderLight(float sourceX, float sourceY, Colour colour, float brightness, float opacity)
@@ -91,6 +239,22 @@ void Leds::renderLight(float sourceX, float sourceY, Colour colour, float bright
 	int intX = int(sourceX);
 	int intY = int(sourceY);
 
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+	// the light position is held in 4096ths of a pixel so that lights
+	// near the edge of their reach land on the same pixels as the float
+	// version - a light with opacity dims any pixel it touches
+
+	long fixedX = (long)(sourceX * LEDS_POSITION_ONE + 0.5);
+	long fixedY = (long)(sourceY * LEDS_POSITION_ONE + 0.5);
+
+	long brightness256 = fractionTo256(brightness);
+	int opacity256 = fractionTo256(opacity);
+
+	int red = colourToByte(colour.Red);
+	int green = colourToByte(colour.Green);
+	int blue = colourToByte(colour.Blue);
+#endif
+
 	for (int xOffset = -1; xOffset <= 1; xOffset++)
 	{
 		int px = intX + xOffset;
@@ -133,6 +297,24 @@ void Leds::renderLight(float sourceX, float sourceY, Colour colour, float bright
 				}
 			}
 
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+			long dx = fixedX - ((long)px * LEDS_POSITION_ONE + LEDS_POSITION_ONE / 2);
+			long dy = fixedY - ((long)py * LEDS_POSITION_ONE + LEDS_POSITION_ONE / 2);
+			long dist = (dx * dx) + (dy * dy);
+
+			if (dist < LEDS_POSITION_ONE * LEDS_POSITION_ONE)
+			{
+				// factor in 65536ths and weight in 256ths
+				long factor = (LEDS_POSITION_ONE * LEDS_POSITION_ONE - dist) >> 8;
+				int weight = (int)((brightness256 * factor) >> 16);
+
+				leds[(writeY * ledWidth) + writeX].AddColourValues(
+					(red * weight + 128) >> 8,
+					(green * weight + 128) >> 8,
+					(blue * weight + 128) >> 8,
+					opacity256);
+			}
+#else
 			// each pixel is at the centre of a 1*1 square
 			// find the distance from this pixel to the light
 			float dx = sourceX - (px + 0.5);
@@ -152,8 +334,9 @@ void Leds::renderLight(float sourceX, float sourceY, Colour colour, float bright
 				float gs = colour.Green * brightness * factor;
 				float bs = colour.Blue * brightness * factor;
 
-				leds[writeX][writeY].AddColourValues(rs, gs, bs, opacity);
+				leds[(writeY * ledWidth) + writeX].AddColourValues(rs, gs, bs, opacity);
 			}
+#endif
 		}
 	}
 	return;
@@ -218,7 +401,7 @@ void Leds::renderLight(float sourceX, float sourceY, Colour colour, float bright
             // Convert to float just once per write (still cheap on RP2040)
             float wf = (float)w / 65536.0f;
 
-            leds[x][y].AddColourValues(r * wf, g * wf, b * wf, opacity);
+            leds[(y * ledWidth) + x].AddColourValues(r * wf, g * wf, b * wf, opacity);
         }
     }
 }
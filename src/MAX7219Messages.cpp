@@ -925,7 +925,7 @@ struct process max7219MessagesProcess = {
     NULL,
     (unsigned char *)&max7219MessagesSettings, sizeof(Max7219MessagesSettings), &max7219MessagesSettingItems,
     &MAX7219Commands,
-    BOOT_PROCESS + ACTIVE_PROCESS + CONFIG_PROCESS + WIFI_CONFIG_PROCESS,
+    BOOT_PROCESS + ACTIVE_PROCESS + CONFIG_PROCESS + WIFI_CONFIG_PROCESS + DEFERRED_START_PROCESS,
     NULL,
     NULL,
     NULL,
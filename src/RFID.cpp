@@ -613,6 +613,7 @@ void updateRFIDSensorReading()
             checkRFIDCard(uidbuffer);
 
             RFIDSensor.millisAtLastReading = millis();
+            RFIDSensor.readingNumber++;
 
             sendRFIDtagToListeners();
 
@@ -684,6 +685,7 @@ void updateRFIDSensorReading()
                     checkRFIDCard(uidbuffer);
 
                     RFIDSensor.millisAtLastReading = millis();
+                    RFIDSensor.readingNumber++;
 
                     sendRFIDtagToListeners();
                 }
@@ -745,8 +747,7 @@ void addRFIDSensorReading(char *jsonBuffer, int jsonBufferSize)
 
     if (RFIDSensor.status == SENSOR_OK)
     {
-        appendFormattedString(jsonBuffer, jsonBufferSize, ",\"rfid\":\"%s\"",
-                              RFIDSensoractiveReading->idString);
+        addSensorReadingText(jsonBuffer, jsonBufferSize, "rfid", RFIDSensoractiveReading->idString);
     }
 }
 
@@ -765,6 +766,9 @@ struct sensor RFIDSensor = {
     false, // being updated
     NULL,  // active reading - set in setup
     0,     // active time
+    0,     // poll interval - zero means every update
+    0,     // poll offset
+    0,     // millis at last poll
     (unsigned char *)&RFIDSensorSettings,
     sizeof(struct RFIDSensorSettings),
     &RFIDSensorSettingItems,
@@ -1,88 +1,380 @@
 #include "Sprite.h"
-#include "Frame.h"
+#include "Leds.h"
 
-// declared here because of issues with forward declaration of the frame
-// class - these functions use members of the Frame class can can't be 
-// defined in Sprite.h
+Sprites::Sprites(int inNoOfSprites)
+{
+    noOfSprites = inNoOfSprites;
+
+    movingState = new SpriteMovingState[noOfSprites];
+    stateWhenMoveCompleted = new SpriteMovingState[noOfSprites];
+    x = new float[noOfSprites];
+    y = new float[noOfSprites];
+    xSpeed = new float[noOfSprites];
+    ySpeed = new float[noOfSprites];
+
+    positionXSpeed = new float[noOfSprites];
+    positionYSpeed = new float[noOfSprites];
+    destX = new float[noOfSprites];
+    destY = new float[noOfSprites];
+    moveSteps = new int[noOfSprites];
+
+    red = new float[noOfSprites];
+    green = new float[noOfSprites];
+    blue = new float[noOfSprites];
+    redStep = new float[noOfSprites];
+    greenStep = new float[noOfSprites];
+    blueStep = new float[noOfSprites];
+    targetColour = new Colour[noOfSprites];
+    colourSteps = new int[noOfSprites];
+
+    brightness = new float[noOfSprites];
+    targetBrightness = new float[noOfSprites];
+    brightnessStep = new float[noOfSprites];
+    brightnessSteps = new int[noOfSprites];
+
+    opacity = new float[noOfSprites];
+
+    enabled = new bool[noOfSprites];
+
+    activeSprites = new int[noOfSprites];
+
+    for (int i = 0; i < noOfSprites; i++)
+    {
+        reset(i);
+    }
+
+    buildActiveSprites();
+}
 
-void Sprite::render()
+void Sprites::reset(int spriteNo)
 {
-    if (!enabled)
-        return;
+    enabled[spriteNo] = false;
+    movingState[spriteNo] = SPRITE_STOPPED;
+    stateWhenMoveCompleted[spriteNo] = SPRITE_STOPPED;
+    red[spriteNo] = 0;
+    green[spriteNo] = 0;
+    blue[spriteNo] = 0;
+    targetColour[spriteNo] = BLACK_COLOUR;
+    moveSteps[spriteNo] = 0;
+    colourSteps[spriteNo] = 0;
+    brightnessSteps[spriteNo] = 0;
+    x[spriteNo] = 0;
+    y[spriteNo] = 0;
+    xSpeed[spriteNo] = 0;
+    ySpeed[spriteNo] = 0;
+    positionXSpeed[spriteNo] = 0;
+    positionYSpeed[spriteNo] = 0;
+    destX[spriteNo] = 0;
+    destY[spriteNo] = 0;
+    redStep[spriteNo] = 0;
+    greenStep[spriteNo] = 0;
+    blueStep[spriteNo] = 0;
+    brightness[spriteNo] = 0;
+    targetBrightness[spriteNo] = 0;
+    brightnessStep[spriteNo] = 0;
+    opacity[spriteNo] = 1;
+    activeSpritesChanged = true;
+}
 
-    frame->leds->renderLight(x, y, colour, brightness, opacity);
+void Sprites::enable(int spriteNo)
+{
+    if (!enabled[spriteNo])
+    {
+        enabled[spriteNo] = true;
+        activeSpritesChanged = true;
+    }
 }
 
-void Sprite::renderColour(Colour col)
+void Sprites::disable(int spriteNo)
 {
-    if (!enabled)
-        return;
+    if (enabled[spriteNo])
+    {
+        enabled[spriteNo] = false;
+        activeSpritesChanged = true;
+    }
+}
 
-    frame->leds->renderLight(x, y, col, brightness, 1);
+void Sprites::disableAll()
+{
+    for (int i = 0; i < noOfSprites; i++)
+    {
+        enabled[i] = false;
+    }
+    activeSpritesChanged = true;
 }
 
-void Sprite::bounce()
+// only done when a sprite has been enabled or disabled
+
+void Sprites::buildActiveSprites()
 {
-    x = x + xSpeed;
-    y = y + ySpeed;
+    noOfActiveSprites = 0;
 
-    if (x < 0)
+    for (int i = 0; i < noOfSprites; i++)
     {
-        x = 0;
-        xSpeed = fabs(xSpeed);
+        if (enabled[i])
+        {
+            activeSprites[noOfActiveSprites] = i;
+            noOfActiveSprites++;
+        }
     }
 
-    if (y < 0)
+    activeSpritesChanged = false;
+}
+
+void Sprites::setColour(int spriteNo, Colour target)
+{
+    redStep[spriteNo] = 0;
+    blueStep[spriteNo] = 0;
+    greenStep[spriteNo] = 0;
+    red[spriteNo] = target.Red;
+    green[spriteNo] = target.Green;
+    blue[spriteNo] = target.Blue;
+    targetColour[spriteNo] = target;
+    colourSteps[spriteNo] = 0;
+}
+
+void Sprites::fadeToColour(int spriteNo, Colour target, int noOfSteps)
+{
+    redStep[spriteNo] = (target.Red - red[spriteNo]) / noOfSteps;
+    blueStep[spriteNo] = (target.Blue - blue[spriteNo]) / noOfSteps;
+    greenStep[spriteNo] = (target.Green - green[spriteNo]) / noOfSteps;
+    targetColour[spriteNo] = target;
+    colourSteps[spriteNo] = noOfSteps;
+}
+
+void Sprites::fadeToBrightness(int spriteNo, float target, int noOfSteps)
+{
+    brightnessStep[spriteNo] = (target - brightness[spriteNo]) / noOfSteps;
+    targetBrightness[spriteNo] = target;
+    brightnessSteps[spriteNo] = noOfSteps;
+}
+
+void Sprites::moveToPosition(int spriteNo, float targetX, float targetY, int noOfSteps, SpriteMovingState inStateWhenMoveCompleted)
+{
+    destX[spriteNo] = targetX;
+    destY[spriteNo] = targetY;
+
+    positionXSpeed[spriteNo] = (targetX - x[spriteNo]) / noOfSteps;
+    positionYSpeed[spriteNo] = (targetY - y[spriteNo]) / noOfSteps;
+
+    stateWhenMoveCompleted[spriteNo] = inStateWhenMoveCompleted;
+    moveSteps[spriteNo] = noOfSteps;
+    movingState[spriteNo] = SPRITE_MOVE;
+}
+
+void Sprites::setup(int spriteNo, Colour inColour, float inBrightness, float inOpacity,
+                    float inX, float inY,
+                    float inXSpeed, float inYSpeed, SpriteMovingState inMovingState,
+                    bool inEnabled)
+{
+    // set the colour of the sprite using a fast fade so that it looks good
+    // 10 steps means that the new colour is hit in a fifth of a second
+    fadeToColour(spriteNo, inColour, 10);
+    brightness[spriteNo] = inBrightness;
+    opacity[spriteNo] = inOpacity;
+    x[spriteNo] = inX;
+    y[spriteNo] = inY;
+    xSpeed[spriteNo] = inXSpeed;
+    ySpeed[spriteNo] = inYSpeed;
+    movingState[spriteNo] = inMovingState;
+
+    if (inEnabled)
+        enable(spriteNo);
+    else
+        disable(spriteNo);
+}
+
+// Each kind of change is a separate pass over the active sprites so that
+// each loop does one simple job
+
+bool Sprites::update(int width, int height)
+{
+    if (activeSpritesChanged)
     {
-        y = 0;
-        ySpeed = fabs(ySpeed);
+        buildActiveSprites();
     }
 
-    if (x >= frame->width)
+    bool changed = false;
+
+    for (int k = 0; k < noOfActiveSprites; k++)
     {
-        x = frame->width;
-        xSpeed = -fabs(xSpeed);
+        int i = activeSprites[k];
+
+        if (brightnessSteps[i] > 0)
+        {
+            changed = true;
+            brightness[i] = brightness[i] + brightnessStep[i];
+            brightnessSteps[i]--;
+            if (brightnessSteps[i] == 0)
+            {
+                brightness[i] = targetBrightness[i];
+                if (targetBrightness[i] == 0)
+                {
+                    // stays in the active list until the next update
+                    enabled[i] = false;
+                    activeSpritesChanged = true;
+                }
+            }
+        }
     }
 
-    if (y >= frame->height)
+    for (int k = 0; k < noOfActiveSprites; k++)
     {
-        y = frame->height;
-        ySpeed = -fabs(ySpeed);
+        int i = activeSprites[k];
+
+        if (colourSteps[i] > 0)
+        {
+            changed = true;
+            red[i] = red[i] + redStep[i];
+            blue[i] = blue[i] + blueStep[i];
+            green[i] = green[i] + greenStep[i];
+            colourSteps[i]--;
+            if (colourSteps[i] == 0)
+            {
+                red[i] = targetColour[i].Red;
+                green[i] = targetColour[i].Green;
+                blue[i] = targetColour[i].Blue;
+            }
+        }
     }
-}
 
-void Sprite::wrap()
-{
-    
-    x = x + xSpeed;
-    y = y + ySpeed;
+    for (int k = 0; k < noOfActiveSprites; k++)
+    {
+        int i = activeSprites[k];
+
+        switch (movingState[i])
+        {
+        case SPRITE_STOPPED:
+            break;
+
+        case SPRITE_BOUNCE:
+            x[i] = x[i] + xSpeed[i];
+            y[i] = y[i] + ySpeed[i];
+
+            if (x[i] < 0)
+            {
+                x[i] = 0;
+                xSpeed[i] = fabs(xSpeed[i]);
+            }
+
+            if (y[i] < 0)
+            {
+                y[i] = 0;
+                ySpeed[i] = fabs(ySpeed[i]);
+            }
+
+            if (x[i] >= width)
+            {
+                x[i] = width;
+                xSpeed[i] = -fabs(xSpeed[i]);
+            }
+
+            if (y[i] >= height)
+            {
+                y[i] = height;
+                ySpeed[i] = -fabs(ySpeed[i]);
+            }
+
+            changed = changed || xSpeed[i] != 0 || ySpeed[i] != 0;
+            break;
+
+        case SPRITE_WRAP:
+            x[i] = x[i] + xSpeed[i];
+            y[i] = y[i] + ySpeed[i];
 
-    while(x<0)
-        x=x+frame->width;
+            while (x[i] < 0)
+                x[i] = x[i] + width;
 
-    while(x>frame->width)
-        x=x-frame->width;
+            while (x[i] > width)
+                x[i] = x[i] - width;
 
-    while(y<0)
-        y=y+frame->height;
+            while (y[i] < 0)
+                y[i] = y[i] + height;
 
-    while(y>frame->height)
-        y=y-frame->height;
+            while (y[i] > height)
+                y[i] = y[i] - height;
 
+            changed = changed || xSpeed[i] != 0 || ySpeed[i] != 0;
+            break;
+
+        case SPRITE_MOVE:
+            x[i] = x[i] + positionXSpeed[i];
+            y[i] = y[i] + positionYSpeed[i];
+
+            moveSteps[i]--;
+            if (moveSteps[i] == 0)
+            {
+                x[i] = destX[i];
+                y[i] = destY[i];
+                movingState[i] = stateWhenMoveCompleted[i];
+            }
+            changed = true;
+            break;
+        }
+    }
+
+    return changed;
+}
+
+void Sprites::render(Leds *leds)
+{
+    if (activeSpritesChanged)
+    {
+        buildActiveSprites();
+    }
+
+    for (int k = 0; k < noOfActiveSprites; k++)
+    {
+        int i = activeSprites[k];
+        Colour colour = {red[i], green[i], blue[i]};
+        leds->renderLight(x[i], y[i], colour, brightness[i], opacity[i]);
+    }
 }
 
-void Sprite::move()
+void Sprites::renderColour(Leds *leds, Colour col)
 {
-    x = x + positionXSpeed;
-    y = y + positionYSpeed;
+    if (activeSpritesChanged)
+    {
+        buildActiveSprites();
+    }
 
-    moveSteps--;
-    if(moveSteps==0)
+    for (int k = 0; k < noOfActiveSprites; k++)
     {
-        x=destX;
-        y=destY;
-        movingState = stateWhenMoveCompleted;
+        int i = activeSprites[k];
+        leds->renderLight(x[i], y[i], col, brightness[i], 1);
     }
 }
 
+void Sprites::dump()
+{
+    displayMessage(F("Sprites:%d active:%d\n"), noOfSprites, noOfActiveSprites);
+
+    for (int i = 0; i < noOfSprites; i++)
+    {
+        if (!enabled[i])
+        {
+            continue;
+        }
+
+        displayMessage(F("r:%f g:%f b:%f bright:%f opacity:%f x:%f y:%f moveSteps:%d colourSteps:%d "),
+            red[i], green[i], blue[i],
+            brightness[i], opacity[i],
+            x[i], y[i], moveSteps[i], colourSteps[i]);
 
+        switch (movingState[i])
+        {
+        case SPRITE_STOPPED:
+            displayMessage(F(" stopped\n"));
+            break;
+        case SPRITE_BOUNCE:
+            displayMessage(F(" bounce -xSpeed:%f ySpeed:%f\n"), xSpeed[i], ySpeed[i]);
+            break;
+        case SPRITE_WRAP:
+            displayMessage(F(" wrap -xSpeed:%f ySpeed:%f\n"), xSpeed[i], ySpeed[i]);
+            break;
+        case SPRITE_MOVE:
+            displayMessage(F(" move -xSpeed:%f ySpeed:%f \n"), xSpeed[i], ySpeed[i]);
+            break;
+        }
+    }
+}
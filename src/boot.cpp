@@ -3,6 +3,8 @@
 
 #include "connectwifi.h"
 #include "utils.h"
+#include "messages.h"
+#include "processes.h"
 #include "boot.h"
 
 struct BootSettings bootSettings;
@@ -41,9 +43,18 @@ struct SettingItem accessPointTimeoutSecs = {"Access Point Timeout seconds",
                                              setDefaultAccessPointTimeoutSecs,
                                              validateBootTimeout};
 
+struct SettingItem fastBootSetting = {"Fast boot (yes or no)",
+                                      "fastboot",
+                                      &bootSettings.fastBoot,
+                                      ONOFF_INPUT_LENGTH,
+                                      yesNo,
+                                      setFalse,
+                                      validateYesNo};
+
 struct SettingItem *bootSettingItemPointers[] =
     {
-        &accessPointTimeoutSecs};
+        &accessPointTimeoutSecs,
+        &fastBootSetting};
 
 struct SettingItemCollection bootSettingItems = {
     "boot",
@@ -51,6 +62,96 @@ struct SettingItemCollection bootSettingItems = {
     bootSettingItemPointers,
     sizeof(bootSettingItemPointers) / sizeof(struct SettingItem *)};
 
+// Boot phase profile. Each phase records the millis value when it ended
+// so the time taken by a phase is the difference from the one before.
+
+struct bootPhase
+{
+    const char *phaseName;
+    unsigned long endMillis;
+};
+
+struct bootPhase bootPhases[BOOT_MAX_NO_OF_PHASES];
+int bootNoOfPhases = 0;
+
+const char *bootFirstWorkName = NULL;
+unsigned long bootFirstWorkMillis;
+
+bool bootCompleted = false;
+
+void recordBootPhase(const char *phaseName)
+{
+    if (bootNoOfPhases >= BOOT_MAX_NO_OF_PHASES)
+    {
+        return;
+    }
+
+    bootPhases[bootNoOfPhases].phaseName = phaseName;
+    bootPhases[bootNoOfPhases].endMillis = millis();
+    bootNoOfPhases++;
+}
+
+void recordBootFirstWork(const char *workName)
+{
+    if (bootFirstWorkName != NULL)
+    {
+        return;
+    }
+
+    bootFirstWorkName = workName;
+    bootFirstWorkMillis = millis();
+}
+
+void completeBoot()
+{
+    if (bootCompleted)
+    {
+        return;
+    }
+
+    recordBootPhase("First loop");
+
+    startDeferredProcesses();
+
+    recordBootPhase("Deferred starts");
+
+    bootCompleted = true;
+
+    bootProcessDescriptor.status = BOOT_OK;
+}
+
+// millis counts from reset so the times include the time spent
+// in the bootloader and the serial settle delay
+
+void dumpBootPhases()
+{
+    displayMessage(F("Boot phases (millis)\n"));
+
+    unsigned long phaseStart = 0;
+
+    for (int i = 0; i < bootNoOfPhases; i++)
+    {
+        displayMessage(F("   %s: %lu at %lu\n"),
+                       bootPhases[i].phaseName,
+                       ulongDiff(bootPhases[i].endMillis, phaseStart),
+                       bootPhases[i].endMillis);
+        phaseStart = bootPhases[i].endMillis;
+    }
+
+    if (bootFirstWorkName == NULL)
+    {
+        displayMessage(F("   No sensor reading or HullOS statement yet\n"));
+    }
+    else
+    {
+        displayMessage(F("   First %s at %lu\n"), bootFirstWorkName, bootFirstWorkMillis);
+    }
+
+    displayMessage(F("   Settings loaded from %s in %lu micros\n"), getSettingsLoadSource(), getSettingsLoadMicros());
+
+    displayMessage(F("   Fast boot %s\n"), bootSettings.fastBoot ? "on" : "off");
+}
+
 void getBootReasonMessage(char *buffer, int bufferlength)
 {
 #if defined(ARDUINO_ARCH_ESP32)
@@ -323,6 +424,10 @@ void internalReboot(unsigned char rebootCode)
 {
     setInternalBootCode(rebootCode);
 
+    flushSettings();
+
+    flushMessages();
+
 #if defined(PICO)
     watchdog_reboot(0, 0, 0);
 #endif
@@ -335,3 +440,69 @@ void internalReboot(unsigned char rebootCode)
 #endif
 }
 
+
+void initBoot()
+{
+    bootProcessDescriptor.status = BOOT_IN_PROGRESS;
+}
+
+void startBoot()
+{
+}
+
+void updateBoot()
+{
+}
+
+void stopBoot()
+{
+}
+
+bool bootStatusOK()
+{
+    return bootProcessDescriptor.status == BOOT_OK;
+}
+
+void bootStatusMessage(char *buffer, int bufferLength)
+{
+    if (bootProcessDescriptor.status != BOOT_OK)
+    {
+        snprintf(buffer, bufferLength, "Boot in progress");
+        return;
+    }
+
+    unsigned long readyMillis = bootPhases[bootNoOfPhases - 1].endMillis;
+
+    if (bootFirstWorkName == NULL)
+    {
+        snprintf(buffer, bufferLength, "Boot ready at %lu millis", readyMillis);
+    }
+    else
+    {
+        snprintf(buffer, bufferLength, "Boot ready at %lu millis first %s at %lu millis",
+                 readyMillis, bootFirstWorkName, bootFirstWorkMillis);
+    }
+}
+
+struct process bootProcessDescriptor = {
+    "boot",
+    initBoot,
+    startBoot,
+    updateBoot,
+    stopBoot,
+    bootStatusOK,
+    bootStatusMessage,
+    false,
+    0,
+    0,
+    0,
+    NULL,
+    (unsigned char *)&bootSettings, sizeof(BootSettings), &bootSettingItems,
+    NULL,
+    BOOT_PROCESS + ACTIVE_PROCESS + CONFIG_PROCESS + WIFI_CONFIG_PROCESS,
+    NULL,
+    NULL,
+    NULL,
+    NULL, // no command options
+    0     // no command options
+};
@@ -6,6 +6,7 @@
 #include "mqtt.h"
 #include "pixels.h"
 #include "utils.h"
+#include "idle.h"
 
 struct ButtonSensorSettings buttonSensorSettings;
 
@@ -173,6 +174,8 @@ bool updateButtonSensor()
 	// if we get here we have a change in the reading
 	// see who wants to know
 
+	buttonSensor.readingNumber++;
+
 	sensorListener *pos = buttonSensor.listeners;
 
 	while (pos != NULL)
@@ -252,6 +255,8 @@ void startbuttonSensor()
 			digitalWrite(buttonSensorSettings.buttonGroundPin, LOW);
 		}
 
+		bindIdleWakePin(buttonSensorSettings.buttonSensorInputPinNo);
+
 		buttonSensor.status = SENSOR_OK;
 	}
 }
@@ -286,8 +291,7 @@ void addButtonSensorReading(char *jsonBuffer, int jsonBufferSize)
 
 	if (buttonSensor.status == SENSOR_OK)
 	{
-		appendFormattedString(jsonBuffer, jsonBufferSize, ",\"button\":\"%d\"",
-				 buttonSensoractiveReading->pressed);
+		addSensorReadingInt(jsonBuffer, jsonBufferSize, "button", buttonSensoractiveReading->pressed);
 	}
 }
 
@@ -327,6 +331,9 @@ struct sensor buttonSensor = {
 	false, // being updated
 	NULL,  // active reading - set in setup
 	0,	   // active time
+	0,	   // poll interval - zero means every update
+	0,	   // poll offset
+	0,	   // millis at last poll
 	(unsigned char *)&buttonSensorSettings,
 	sizeof(struct ButtonSensorSettings),
 	&buttonSensorSettingItems,
@@ -240,6 +240,21 @@ struct SettingItem interval2SingleShot = {
 	setTrue,
 	validateYesNo};
 
+void defaultClockPollInterval(void *dest)
+{
+	int *destInt = (int *)dest;
+	*destInt = CLOCK_DEFAULT_POLL_INTERVAL_MILLIS;
+}
+
+struct SettingItem clockPollInterval = {
+	"Clock millis between updates (0 for every loop)",
+	"clockpollmillis",
+	&clockSensorSettings.pollIntervalMillis,
+	NUMBER_INPUT_LENGTH,
+	integerValue,
+	defaultClockPollInterval,
+	validateInt};
+
 struct SettingItem *clockSettingItemPointers[] =
 	{
 		&timeZoneSetting,
@@ -260,7 +275,8 @@ struct SettingItem *clockSettingItemPointers[] =
 		&interval1SingleShot,
 		&interval2,
 		&interval2Enabled,
-		&interval2SingleShot};
+		&interval2SingleShot,
+		&clockPollInterval};
 
 struct SettingItemCollection clockSensorSettingItems = {
 	"clock",
@@ -594,6 +610,15 @@ void startClockSensor()
 {
 	needToInitialiseAlarmsAndTimers = true;
 
+	if (clockSensorSettings.pollIntervalMillis > 0)
+	{
+		clockSensor.pollIntervalMillis = clockSensorSettings.pollIntervalMillis;
+	}
+	else
+	{
+		clockSensor.pollIntervalMillis = 0;
+	}
+
 	timeZoneSet=false;
 
 	struct ClockReading *clockActiveReading;
@@ -745,8 +770,7 @@ void addClockSensorReading(char *jsonBuffer, int jsonBufferSize)
 		// 	clockActiveReading->minute,
 		// 	clockActiveReading->second);
 
-		appendFormattedString(jsonBuffer, jsonBufferSize, ",\"timestamp\":\"%s\"",
-				 UTC.dateTime(RFC3339).c_str());
+		addSensorReadingText(jsonBuffer, jsonBufferSize, "timestamp", UTC.dateTime(RFC3339).c_str());
 	}
 }
 
@@ -854,6 +878,9 @@ struct sensor clockSensor = {
 	false, // being updated
 	NULL,  // active reading - set in setup
 	0,	   // active time
+	0,	   // poll interval - set from settings when the sensor starts
+	CLOCK_POLL_OFFSET_MILLIS, // poll offset
+	0,	   // millis at last poll
 	(unsigned char *)&clockSensorSettings,
 	sizeof(struct ClockSensorSettings),
 	&clockSensorSettingItems,
@@ -4,6 +4,7 @@
 #include <WiFi.h>
 #include <WiFiClient.h>
 #include <WebServer.h>
+#include <WebSocketsServer.h>
 
 #ifdef ARDUINO_ARCH_ESP32
 #include <ESPmDNS.h>
@@ -18,6 +19,7 @@
 #include "settings.h"
 #include "codeEditorProcess.h"
 #include "codeEditorWebPage.h"
+#include "version.h"
 #include "processes.h"
 #include "mqtt.h"
 #include "errors.h"
@@ -30,6 +32,8 @@
 #include "HullOS.h"
 #include "PythonIsh.h"
 #include "HullOSScript.h"
+#include "HullOSCommands.h"
+#include "ArduinoJson-v5.13.2.h"
 
 struct CodeEditorSettings codeEditorSettings;
 
@@ -84,11 +88,30 @@ bool serverActive = false;
 
 WebServer server(80);
 
+// The page is held gzip compressed. Its ETag changes with the firmware
+// version and the page contents, so a browser that already has the
+// page is sent a 304 reply rather than the page.
+
+const char *codeEditorPageETag = "\"" Version "-" CODE_EDITOR_PAGE_HASH "\"";
+
+const char *codeEditorRequestHeaders[] = {"If-None-Match"};
+
 void handleRoot()
 {
+    server.sendHeader("ETag", codeEditorPageETag);
+    server.sendHeader("Cache-Control", "no-cache");
+
+    if (server.header("If-None-Match") == codeEditorPageETag)
+    {
+        displayMessageWithNewline(F("Server root hit - page not modified"));
+        server.send(304, "text/html", "");
+        return;
+    }
+
     displayMessageWithNewline(F("Server root hit"));
 
-    server.send(200, "text/html", webPage);
+    server.sendHeader("Content-Encoding", "gzip");
+    server.send_P(200, PSTR("text/html"), (PGM_P)codeEditorPageGzip, CODE_EDITOR_PAGE_GZIP_LENGTH);
 }
 
 void handleNotFound()
@@ -124,6 +147,8 @@ bool loadCodeFromFile()
     return loadFromFile(CODE_EDIT_PROGRAM_FILE_NAME, codeEditSource, CODE_EDIT_PROGRAM_SIZE);
 }
 
+void sendCodeEditorError(int lineNo, const char *error);
+
 bool sendTextToPythonIsh(char * text){
 
     char * chPos = text;
@@ -184,6 +209,7 @@ bool sendTextToPythonIsh(char * text){
         if(result != ERROR_OK){
             const char * error = getErrorMessage(result);
             displayMessage(F("%d line:%s\n"),lineCount,error);
+            sendCodeEditorError(lineCount, error);
             return false;
         }
         lineCount++;
@@ -218,6 +244,278 @@ bool sendStringToCodeBuffer(String str)
     return true;
 }
 
+//////////////////////////////////////////////////////////////////
+/////// Live channel
+//////////////////////////////////////////////////////////////////
+
+// The editor page keeps a WebSocket open to the device. The page sends
+// its edits as they are made and the run and stop requests. The device
+// sends back compile errors, program output and program state changes.
+// Messages are JSON objects with a cmd (from the page) or type (to it).
+
+WebSocketsServer codeEditorSocket(CODE_EDITOR_SOCKET_PORT);
+
+char codeEditorSocketBuffer[CODE_EDITOR_SOCKET_BUFFER_SIZE];
+
+StaticJsonBuffer<CODE_EDITOR_SOCKET_JSON_SIZE> codeEditorJsonBuffer;
+
+ProgramState codeEditorReportedState = PROGRAM_STOPPED;
+
+// control characters are escaped so that the text arrives unchanged,
+// the longest escape is \u00XX
+
+int appendCodeEditorJsonString(int pos, const char *text)
+{
+    while (*text != 0 && pos < CODE_EDITOR_SOCKET_BUFFER_SIZE - 7)
+    {
+        unsigned char ch = *text++;
+
+        switch (ch)
+        {
+        case '"':
+        case '\\':
+            codeEditorSocketBuffer[pos++] = '\\';
+            codeEditorSocketBuffer[pos++] = ch;
+            break;
+        case '\n':
+            codeEditorSocketBuffer[pos++] = '\\';
+            codeEditorSocketBuffer[pos++] = 'n';
+            break;
+        case '\r':
+            codeEditorSocketBuffer[pos++] = '\\';
+            codeEditorSocketBuffer[pos++] = 'r';
+            break;
+        case '\t':
+            codeEditorSocketBuffer[pos++] = '\\';
+            codeEditorSocketBuffer[pos++] = 't';
+            break;
+        default:
+            if (ch < ' ')
+            {
+                pos += snprintf(codeEditorSocketBuffer + pos, 7, "\\u%04x", ch);
+            }
+            else
+            {
+                codeEditorSocketBuffer[pos++] = ch;
+            }
+            break;
+        }
+    }
+
+    codeEditorSocketBuffer[pos] = 0;
+    return pos;
+}
+
+// sends {"type":"<type>","<name>":"<text>"} to all the open editors
+
+void sendCodeEditorText(const char *type, const char *name, const char *text)
+{
+    if (codeEditorSocket.connectedClients() == 0)
+    {
+        return;
+    }
+
+    int pos = snprintf(codeEditorSocketBuffer, CODE_EDITOR_SOCKET_BUFFER_SIZE,
+                       "{\"type\":\"%s\",\"%s\":\"", type, name);
+    pos = appendCodeEditorJsonString(pos, text);
+    snprintf(codeEditorSocketBuffer + pos, CODE_EDITOR_SOCKET_BUFFER_SIZE - pos, "\"}");
+
+    codeEditorSocket.broadcastTXT(codeEditorSocketBuffer);
+}
+
+void sendCodeEditorError(int lineNo, const char *error)
+{
+    if (codeEditorSocket.connectedClients() == 0)
+    {
+        return;
+    }
+
+    int pos = snprintf(codeEditorSocketBuffer, CODE_EDITOR_SOCKET_BUFFER_SIZE,
+                       "{\"type\":\"error\",\"line\":%d,\"message\":\"", lineNo);
+    pos = appendCodeEditorJsonString(pos, error);
+    snprintf(codeEditorSocketBuffer + pos, CODE_EDITOR_SOCKET_BUFFER_SIZE - pos, "\"}");
+
+    codeEditorSocket.broadcastTXT(codeEditorSocketBuffer);
+}
+
+void sendCodeEditorProgramOutput(const char *text)
+{
+    sendCodeEditorText("output", "text", text);
+}
+
+const char *codeEditorStateName(ProgramState state)
+{
+    switch (state)
+    {
+    case PROGRAM_STOPPED:
+        return "stopped";
+    case PROGRAM_PAUSED:
+        return "paused";
+    case PROGRAM_ACTIVE:
+        return "active";
+    case PROGRAM_AWAITING_DELAY_COMPLETION:
+        return "delay";
+    case PROGRAM_AWAITING_MOVE_COMPLETION:
+        return "move";
+    default:
+        return "unknown";
+    }
+}
+
+void sendCodeEditorState()
+{
+    codeEditorReportedState = programState;
+    sendCodeEditorText("state", "state", codeEditorStateName(programState));
+}
+
+// Applies an edit from the page. The page sends the length it expects
+// the source to have afterwards so a missed edit is spotted and the
+// page can be asked for the whole source.
+
+bool applyCodeEditorEdit(int at, int removeLength, const char *insertText, int expectedLength)
+{
+    int sourceLength = strlen(codeEditSource);
+    int insertLength = strlen(insertText);
+
+    if (at < 0 || removeLength < 0 || at + removeLength > sourceLength)
+    {
+        return false;
+    }
+
+    if (sourceLength - removeLength + insertLength > CODE_EDIT_PROGRAM_SIZE - 1)
+    {
+        return false;
+    }
+
+    // move the text after the edit, including the terminator
+    memmove(codeEditSource + at + insertLength,
+            codeEditSource + at + removeLength,
+            sourceLength - at - removeLength + 1);
+
+    memcpy(codeEditSource + at, insertText, insertLength);
+
+    return (int)strlen(codeEditSource) == expectedLength;
+}
+
+// The program is compiled into the running program store and started in
+// the same way as the editor page does over HTTP
+
+void runCodeEditorSource()
+{
+    unsigned long startMillis = millis();
+
+    saveCode();
+
+    if (!sendTextToPythonIsh("begin\n"))
+    {
+        return;
+    }
+
+    if (!sendTextToPythonIsh(codeEditSource))
+    {
+        return;
+    }
+
+    if (!sendTextToPythonIsh("end\nsave \"active.txt\"\nload \"active.txt\"\n"))
+    {
+        return;
+    }
+
+    snprintf(codeEditorSocketBuffer, CODE_EDITOR_SOCKET_BUFFER_SIZE,
+             "{\"type\":\"compiled\",\"millis\":%lu}", ulongDiff(millis(), startMillis));
+    codeEditorSocket.broadcastTXT(codeEditorSocketBuffer);
+
+    sendCodeEditorState();
+}
+
+void actOnCodeEditorMessage(uint8_t clientNo, char *json)
+{
+    codeEditorJsonBuffer.clear();
+
+    JsonObject &root = codeEditorJsonBuffer.parseObject(json);
+
+    if (!root.success())
+    {
+        codeEditorSocket.sendTXT(clientNo, "{\"type\":\"error\",\"line\":0,\"message\":\"Invalid message\"}");
+        return;
+    }
+
+    const char *cmd = root["cmd"];
+
+    if (cmd == NULL)
+    {
+        return;
+    }
+
+    if (strcasecmp(cmd, "edit") == 0)
+    {
+        const char *insertText = root["insert"] | "";
+
+        if (!applyCodeEditorEdit(root["at"], root["remove"], insertText, root["length"]))
+        {
+            codeEditorSocket.sendTXT(clientNo, "{\"type\":\"resync\"}");
+        }
+        return;
+    }
+
+    if (strcasecmp(cmd, "source") == 0)
+    {
+        const char *code = root["code"] | "";
+
+        if (strlen(code) > CODE_EDIT_PROGRAM_SIZE - 1)
+        {
+            codeEditorSocket.sendTXT(clientNo, "{\"type\":\"error\",\"line\":0,\"message\":\"Program too long\"}");
+            return;
+        }
+
+        strcpy(codeEditSource, code);
+        return;
+    }
+
+    if (strcasecmp(cmd, "run") == 0)
+    {
+        runCodeEditorSource();
+        return;
+    }
+
+    if (strcasecmp(cmd, "stop") == 0)
+    {
+        haltProgramExecution();
+        sendCodeEditorState();
+        return;
+    }
+
+    if (strcasecmp(cmd, "save") == 0)
+    {
+        saveCode();
+        return;
+    }
+}
+
+void codeEditorSocketEvent(uint8_t clientNo, WStype_t type, uint8_t *payload, size_t length)
+{
+    switch (type)
+    {
+    case WStype_CONNECTED:
+        displayMessage(F("Code editor %d connected\n"), clientNo);
+        sendCodeEditorText("source", "code", codeEditSource);
+        sendCodeEditorState();
+        break;
+
+    case WStype_DISCONNECTED:
+        displayMessage(F("Code editor %d disconnected\n"), clientNo);
+        break;
+
+    case WStype_TEXT:
+        // the library terminates the payload so it can be parsed in place
+        actOnCodeEditorMessage(clientNo, (char *)payload);
+        break;
+
+    default:
+        break;
+    }
+}
+
 void setupCodeEditorServer()
 {
 
@@ -254,7 +552,14 @@ void setupCodeEditorServer()
 
     server.onNotFound(handleNotFound);
 
+    server.collectHeaders(codeEditorRequestHeaders, 1);
+
     server.begin();
+
+    codeEditorSocket.begin();
+    codeEditorSocket.onEvent(codeEditorSocketEvent);
+    bindProgramOutputHandler(sendCodeEditorProgramOutput);
+
     serverActive = true;
 }
 
@@ -398,6 +703,18 @@ void startcodeEditorProcess()
 
 void updatecodeEditorProcess()
 {
+    // the live channel is serviced on every update so that a run request
+    // isn't held up by the web server polling interval
+
+    if (codeEditorProcess.status == CODE_EDITOR_CONNECTED)
+    {
+        codeEditorSocket.loop();
+
+        if (programState != codeEditorReportedState)
+        {
+            sendCodeEditorState();
+        }
+    }
 
     unsigned long currentMillis = millis();
     unsigned long millisSinceLastUpdate = ulongDiff(currentMillis, millisOfLastCodeEditorUpdate);
@@ -476,7 +793,7 @@ struct process codeEditorProcess = {
     NULL,
     (unsigned char *)&codeEditorSettings, sizeof(codeEditorSettings), &codeEditorMessagesSettingItems,
     &codeEditorCommands,
-    BOOT_PROCESS + ACTIVE_PROCESS + CONFIG_PROCESS + WIFI_CONFIG_PROCESS,
+    BOOT_PROCESS + ACTIVE_PROCESS + CONFIG_PROCESS + WIFI_CONFIG_PROCESS + DEFERRED_START_PROCESS,
     NULL,
     NULL,
     NULL,
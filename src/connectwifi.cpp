@@ -8,6 +8,7 @@
 #include "boot.h"
 #include "pixels.h"
 #include "controller.h"
+#include "metrics.h"
 
 #if defined(ARDUINO_ARCH_ESP32)
 
@@ -72,9 +73,19 @@ struct SettingItem wifi5SSIDSetting = {
 struct SettingItem wifi5PWDSetting = {
 	"WiFiPassword5", "wifipwd5", wifiConnectionSettings.wifi5PWD, WIFI_PASSWORD_LENGTH, password, setEmptyString, validateWifiPWD};
 
+struct SettingItem wifiFastConnectSetting = {
+	"WiFi fast reconnect (yes or no)",
+	"wififastconnect",
+	&wifiConnectionSettings.wifiFastConnect,
+	YESNO_INPUT_LENGTH,
+	yesNo,
+	setFalse,
+	validateYesNo};
+
 struct SettingItem *wifiConnectionSettingItemPointers[] =
 	{
 		&wifiOnOff,
+		&wifiFastConnectSetting,
 		&wifi1SSIDSetting,
 		&wifi1PWDSetting,
 
@@ -157,6 +168,151 @@ unsigned long WiFiTimerStart;
 
 int wifiConnectAttempts = 0;
 
+// Timing of the most recent connection, from when the device started
+// looking for a network to when it was connected
+
+unsigned long wifiConnectStartMillis;
+unsigned long wifiConnectMillis = 0;
+bool wifiConnectWasFast = false;
+
+unsigned long getWiFiConnectStartMillis()
+{
+	return wifiConnectStartMillis;
+}
+
+long readWiFiConnectMillisGauge()
+{
+	return (long)wifiConnectMillis;
+}
+
+// The access point and channel of the last connection are kept in a file
+// so that the next connection can go straight to the access point without
+// a scan. The address still comes from DHCP. If that fails the device
+// scans as normal and the cache isn't tried again until it has been
+// refreshed.
+
+struct WiFiConnectionCache
+{
+	unsigned long magic;
+	char ssid[WIFI_SSID_LENGTH];
+	uint8_t bssid[WIFI_BSSID_LENGTH];
+	int32_t channel;
+};
+
+struct WiFiConnectionCache wifiConnectionCache;
+
+bool wifiConnectionCacheValid = false;
+bool wifiFastConnectFailed = false;
+
+void loadWiFiConnectionCache()
+{
+	wifiConnectionCacheValid = false;
+
+	File cacheFile = fileOpen(WIFI_CACHE_FILENAME, "r");
+
+	if (!cacheFile)
+	{
+		return;
+	}
+
+	int bytesRead = cacheFile.read((uint8_t *)&wifiConnectionCache, sizeof(struct WiFiConnectionCache));
+	cacheFile.close();
+
+	if (bytesRead == sizeof(struct WiFiConnectionCache) && wifiConnectionCache.magic == WIFI_CACHE_MAGIC)
+	{
+		wifiConnectionCacheValid = true;
+	}
+}
+
+// only written when the connection details change to save flash wear
+
+void saveWiFiConnectionCache()
+{
+	struct WiFiConnectionCache newCache;
+
+	memset(&newCache, 0, sizeof(struct WiFiConnectionCache));
+
+	newCache.magic = WIFI_CACHE_MAGIC;
+	snprintf(newCache.ssid, WIFI_SSID_LENGTH, "%s", wifiActiveAPName);
+
+	uint8_t *bssid = WiFi.BSSID();
+
+	if (bssid == NULL)
+	{
+		return;
+	}
+
+	memcpy(newCache.bssid, bssid, WIFI_BSSID_LENGTH);
+	newCache.channel = WiFi.channel();
+
+	if (wifiConnectionCacheValid && memcmp(&newCache, &wifiConnectionCache, sizeof(struct WiFiConnectionCache)) == 0)
+	{
+		return;
+	}
+
+	File cacheFile = fileOpen(WIFI_CACHE_FILENAME, "w");
+
+	if (!cacheFile)
+	{
+		return;
+	}
+
+	cacheFile.write((const uint8_t *)&newCache, sizeof(struct WiFiConnectionCache));
+	cacheFile.close();
+
+	wifiConnectionCache = newCache;
+	wifiConnectionCacheValid = true;
+}
+
+const char *findCachedWiFiPassword()
+{
+	for (unsigned int i = 0; i < sizeof(wifiSettings) / sizeof(struct WiFiSetting); i++)
+	{
+		if (wifiSettings[i].wifiSsid[0] != 0 && strcasecmp(wifiSettings[i].wifiSsid, wifiConnectionCache.ssid) == 0)
+		{
+			return wifiSettings[i].wifiPassword;
+		}
+	}
+	return NULL;
+}
+
+bool beginFastWiFiConnect()
+{
+#ifdef PICO
+	// the PICO WiFi library can't connect to a given access point
+	return false;
+#else
+	if (!wifiConnectionSettings.wifiFastConnect || !wifiConnectionCacheValid || wifiFastConnectFailed)
+	{
+		return false;
+	}
+
+	// the cached network might have been removed from the settings
+	const char *password = findCachedWiFiPassword();
+
+	if (password == NULL)
+	{
+		return false;
+	}
+
+	snprintf(wifiActiveAPName, WIFI_SSID_LENGTH, "%s", wifiConnectionCache.ssid);
+	displayMessage(F("*       Fast connect to %s on channel %d\n"), wifiActiveAPName, (int)wifiConnectionCache.channel);
+
+	WiFi.begin(wifiConnectionCache.ssid, password, wifiConnectionCache.channel, wifiConnectionCache.bssid);
+
+	WiFiTimerStart = millis();
+	WiFiProcessDescriptor.status = WIFI_FAST_CONNECTING;
+	return true;
+#endif
+}
+
+void handleFastConnectFailure()
+{
+	displayMessage(F("*       Fast connect failed - scanning\n"));
+	wifiFastConnectFailed = true;
+	WiFi.disconnect();
+}
+
 void beginWiFiScanning()
 {
 	if (wifiConnectionSettings.wiFiOn == false)
@@ -179,6 +335,11 @@ void beginWiFiScanning()
 		wifiConnectAttempts = 0;
 	}
 
+	if (beginFastWiFiConnect())
+	{
+		return;
+	}
+
 	WiFi.scanNetworks(true);
 	WiFiProcessDescriptor.status = WIFI_SCANNING;
 }
@@ -346,6 +507,23 @@ void handleConnectTimeout()
 	hardwareDisplayMessage(WIFI_STATUS_CONNECT_FAILED_MESSAGE_NUMBER, ledFlashAlertState, WIFI_STATUS_CONNECT_FAILED_MESSAGE_TEXT);
 }
 
+void checkWiFiConnectResult();
+
+void checkWiFiFastConnectResult()
+{
+	if (WiFi.status() == WL_CONNECTED)
+	{
+		checkWiFiConnectResult();
+		return;
+	}
+
+	if (ulongDiff(millis(), WiFiTimerStart) > WIFI_FAST_CONNECT_TIMEOUT_MILLIS)
+	{
+		handleFastConnectFailure();
+		beginWiFiScanning();
+	}
+}
+
 void checkWiFiConnectResult()
 {
 	if (WiFi.status() != WL_CONNECTED)
@@ -366,11 +544,22 @@ void checkWiFiConnectResult()
 	if (wifiError == WL_CONNECTED)
 	{
 		TRACELOGLN("Wifi OK");
+
+		wifiConnectWasFast = WiFiProcessDescriptor.status == WIFI_FAST_CONNECTING;
+		wifiConnectMillis = ulongDiff(millis(), wifiConnectStartMillis);
+		displayMessage(F("*       WiFi connected in %lu millis%s\n"), wifiConnectMillis, wifiConnectWasFast ? " (fast)" : "");
 		WiFiProcessDescriptor.status = WIFI_OK;
 		char messageBuffer[WIFI_MESSAGE_BUFFER_SIZE];
 		snprintf(messageBuffer, WIFI_MESSAGE_BUFFER_SIZE, "%s %s", WIFI_STATUS_OK_MESSAGE_TEXT, WiFi.localIP().toString().c_str());
 		hardwareDisplayMessage(WIFI_STATUS_OK_MESSAGE_NUMBER, ledFlashNormalState, messageBuffer);
 		wifiConnectAttempts = 0;
+
+		if (wifiConnectionSettings.wifiFastConnect)
+		{
+			saveWiFiConnectionCache();
+			wifiFastConnectFailed = false;
+		}
+
 		performCommandsInStore(WIFI_CONNECT_COMMAND_STORE);
 		return;
 	}
@@ -419,6 +608,7 @@ void checkWiFIOK()
 
 	if (wifiStatusValue != WL_CONNECTED)
 	{
+		wifiConnectStartMillis = millis();
 		performCommandsInStore(WIFI_DISCONNECT_COMMAND_STORE);
 		startReconnectTimer();
 	}
@@ -445,11 +635,18 @@ void initWifi()
 	#endif
 
 	WiFiProcessDescriptor.status = WIFI_TURNED_OFF;
+	addGaugeMetric("wificonnectmillis", readWiFiConnectMillisGauge);
 }
 
 void startWifi()
 {
 	millisOfLastWiFiUpdate = millis();
+	wifiConnectStartMillis = millis();
+
+	if (wifiConnectionSettings.wifiFastConnect)
+	{
+		loadWiFiConnectionCache();
+	}
 
 	if (wifiConnectionSettings.wiFiOn)
 	{
@@ -479,7 +676,11 @@ void wifiStatusMessage(char *buffer, int bufferLength)
 	switch (WiFiProcessDescriptor.status)
 	{
 	case WIFI_OK:
-		snprintf(buffer, bufferLength, "%s: %s", wifiActiveAPName, WiFi.localIP().toString().c_str());
+		snprintf(buffer, bufferLength, "%s: %s connected in %lu millis%s", wifiActiveAPName, WiFi.localIP().toString().c_str(),
+				 wifiConnectMillis, wifiConnectWasFast ? " (fast)" : "");
+		break;
+	case WIFI_FAST_CONNECTING:
+		snprintf(buffer, bufferLength, "Fast connecting to %s", wifiActiveAPName);
 		break;
 	case WIFI_TURNED_OFF:
 		snprintf(buffer, bufferLength, "Wifi OFF");
@@ -539,6 +740,10 @@ void updateWifi()
 		checkWiFiConnectResult();
 		break;
 
+	case WIFI_FAST_CONNECTING:
+		checkWiFiFastConnectResult();
+		break;
+
 	case WIFI_ERROR_CONNECT_TIMEOUT:
 		startReconnectTimer();
 		break;
@@ -12,6 +12,7 @@
 #include "settingsWebServer.h"
 #include "HullOS.h"
 #include "boot.h"
+#include "metrics.h"
 #include "utils.h"
 #include <LittleFS.h>
 #include "RFID.h"
@@ -115,6 +116,46 @@ void doStartWebServer(char *commandLine)
 #endif
 }
 
+void doDumpMetrics(char *commandLine)
+{
+	dumpMetrics();
+}
+
+// mqttload [messages] [burst size] [json command]
+
+void doMQTTLoadTest(char *commandLine)
+{
+	int noOfMessages = MQTT_LOAD_TEST_DEFAULT_MESSAGES;
+	int burstSize = 1;
+	const char *command = NULL;
+
+	char *item = skipCommand(commandLine);
+
+	if (*item != 0)
+	{
+		noOfMessages = atoi(item);
+		item = skipCommand(item);
+	}
+
+	if (*item != 0)
+	{
+		burstSize = atoi(item);
+		item = skipCommand(item);
+	}
+
+	if (*item != 0)
+	{
+		command = item;
+	}
+
+	runMQTTLoadTest(noOfMessages, burstSize, command);
+}
+
+void doDumpBootTimes(char *commandLine)
+{
+	dumpBootPhases();
+}
+
 void doDumpStatus(char *commandLine)
 {
 	char *filterStart = skipCommand(commandLine);
@@ -168,9 +209,48 @@ void doClear(char *commandLine)
 void doSaveSettings(char *commandline)
 {
 	saveSettings();
+	flushSettings();
 	displayMessage(F("\nSettings saved"));
 }
 
+void doImportSettings(char *commandLine)
+{
+	char *pathStart = skipCommand(commandLine);
+
+	if (*pathStart == 0)
+	{
+		pathStart = SETTINGS_FILENAME;
+	}
+
+	if (importSettingsFromFile(pathStart))
+	{
+		displayMessage(F("\nSettings imported from %s"), pathStart);
+	}
+	else
+	{
+		displayMessage(F("\nSettings file %s not found"), pathStart);
+	}
+}
+
+void doExportSettings(char *commandLine)
+{
+	char *pathStart = skipCommand(commandLine);
+
+	if (*pathStart == 0)
+	{
+		pathStart = SETTINGS_FILENAME;
+	}
+
+	if (exportSettingsToFile(pathStart))
+	{
+		displayMessage(F("\nSettings exported to %s"), pathStart);
+	}
+	else
+	{
+		displayMessage(F("\nSettings store unavailable"));
+	}
+}
+
 #ifdef SENSOR_BUTTON
 void doTestButtonSensor(char *commandline)
 {
@@ -393,6 +473,75 @@ void doClearAllListeners(char *commandLine)
 	clearAllListeners();
 }
 
+// log
+// log level <debug|info|warning|error|none>
+// log <module|all> <on|off>
+
+void doLog(char *commandLine)
+{
+	char *item = skipCommand(commandLine);
+
+	if (*item == 0)
+	{
+		dumpLogSettings();
+		return;
+	}
+
+	char *value = skipCommand(item);
+
+	// terminate the item name at the space
+
+	if (value > item && *(value - 1) == ' ')
+	{
+		*(value - 1) = 0;
+	}
+
+	if (strcasecmp(item, "level") == 0)
+	{
+		int level = findLogLevelByName(value);
+
+		if (level < 0)
+		{
+			displayMessage(F("Invalid log level %s\n"), value);
+			return;
+		}
+
+		if (level < LOG_LEVEL)
+		{
+			displayMessage(F("Messages below %s are not built into this device\n"), logLevelName(LOG_LEVEL));
+		}
+
+		messagesSettings.logLevel = level;
+	}
+	else
+	{
+		int module = findLogModuleByName(item);
+
+		if (module < 0)
+		{
+			displayMessage(F("Invalid log module %s\n"), item);
+			return;
+		}
+
+		if (strcasecmp(value, "on") == 0)
+		{
+			messagesSettings.logModuleMask |= module;
+		}
+		else if (strcasecmp(value, "off") == 0)
+		{
+			messagesSettings.logModuleMask &= ~module;
+		}
+		else
+		{
+			displayMessage(F("Use on or off to set a log module\n"));
+			return;
+		}
+	}
+
+	saveSettings();
+	dumpLogSettings();
+}
+
 void doClearSensorListeners(char *commandLine)
 {
 	char *sensorName = skipCommand(commandLine);
@@ -606,6 +755,7 @@ void doFirmwareUpgradeReset(char *commandLine)
 {
 	displayMessage(F("Booting into USB drive mode for firmware update..."));
 	saveSettings();
+	flushSettings();
 	delay(2000);
 	reset_usb_boot(1, 0);
 }
@@ -649,6 +799,7 @@ struct consoleCommand userCommands[] =
 #ifdef PROCESS_HULLOS
 		{"begin", "begin receiving a PythonIsh program", doPythonIshBegin},
 #endif
+		{"boottimes", "show the time taken by each boot phase", doDumpBootTimes},
 #ifdef SENSOR_BUTTON
 		{"buttontest", "test the button sensor", doTestButtonSensor},
 #endif
@@ -662,7 +813,9 @@ struct consoleCommand userCommands[] =
 		{"commandsjson", "show all the remote commands in json", doShowRemoteCommandsJson},
 		{"deletecommand", "delete the named command", doDeleteCommand},
 		{"dump", "dump all the setting values", doDumpSettings},
+		{"exportsettings", "save the setting values to a text settings file", doExportSettings},
 		{"help", "show all the commands", doHelp},
+		{"importsettings", "load the setting values from a text settings file", doImportSettings},
 #ifdef PROCESS_HULLOS
 		{"hullos", "start the HullOS language interpreter", doStartHullOS},
 #endif
@@ -670,6 +823,9 @@ struct consoleCommand userCommands[] =
 		{"host", "start the configuration web host", doStartWebServer},
 #endif
 		{"listeners", "list the command listeners", doDumpListeners},
+		{"metrics", "show the performance metrics in json", doDumpMetrics},
+		{"mqttload", "time a stream of commands through the MQTT receive queue e.g. mqttload 100 4", doMQTTLoadTest},
+		{"log", "show or set the log level and modules e.g. log level debug or log mqtt off", doLog},
 		{"help", "show all the commands", doHelp},
 #if defined(WEMOSD1MINI) || defined(ESP32DOIT)
 		{"otaupdate", "start an over-the-air firmware update", doOTAUpdate},
@@ -910,10 +1066,22 @@ void bufferSerialChar(char ch)
 
 void checkSerialBuffer()
 {
+	if (!Serial.available())
+	{
+		return;
+	}
+
+	// the user is waiting for the response to a command so
+	// console output is not queued
+
+	beginSynchronousMessages();
+
 	while (Serial.available())
 	{
 		bufferSerialChar(Serial.read());
 	}
+
+	endSynchronousMessages();
 }
 
 void sendMessageToConsole(char *message)
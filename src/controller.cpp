@@ -101,7 +101,7 @@ bool matchListenerConfigurationName(struct sensorListenerConfiguration *commandI
 	return (strcasecmp(commandItem->listenerName, name) == 0);
 }
 
-bool matchEmptyListener(struct sensorListenerConfiguration *commandItem, void *critereon)
+bool matchEmptyListener(struct sensorListenerConfiguration *commandItem, void * /* critereon */)
 {
 	return commandItem->listenerName[0] == 0;
 }
@@ -240,7 +240,7 @@ boolean setDefaultEmptyString(void *dest)
 	return true;
 }
 
-bool noDefaultAvailable(void *dest)
+bool noDefaultAvailable(void * /* dest */)
 {
 	return false;
 }
@@ -387,7 +387,7 @@ void build_text_value_command_reply(int errorNo, const char *result, JsonObject
 		// Got a sequence number in the command - must return the same number
 		// so that the sender can identify the command that was sent
 		int sequenceNo = root["seq"];
-		sprintf(replyBuffer, "\"val\":%s\",\"error\":%d,\"seq\":%d", result, errorNo, sequenceNo);
+		sprintf(replyBuffer, "\"val\":%s,\"error\":%d,\"seq\":%d", result, errorNo, sequenceNo);
 	}
 	else
 	{
@@ -894,7 +894,7 @@ float commandParameterBufferf[OPTION_STORAGE_SIZE / sizeof(float)];
 
 unsigned char *commandParameterBuffer = (unsigned char *)commandParameterBufferf;
 
-int decodeCommand(const char *rawCommandText, process *process, Command *command,
+int decodeCommand(const char * /* rawCommandText */, process *process, Command *command,
 				  unsigned char *parameterBuffer, JsonObject &root)
 {
 	TRACELOGLN("Decoding a command");
@@ -1193,7 +1193,7 @@ void act_onJson_message(const char *json, void (*deliverResult)(char *resultText
 	return;
 }
 
-void createJSONfromSettings(char *processName, struct Command *command, char *destination, unsigned char *settingBase, char *buffer, int bufferLength)
+void createJSONfromSettings(char *processName, struct Command *command, char * /* destination */, unsigned char *settingBase, char *buffer, int bufferLength)
 {
 	TRACELOG("Creating json for command:");
 	TRACELOG(command->name);
@@ -230,16 +230,19 @@ void updateDistance()
 
 	updateDistanceSensor();
 
-	int previousDistanceReading = distanceactiveReading->distance;
+	int newDistanceReading = getDistanceValueInt();
 
-	if (abs(previousDistanceReading - previousDistanceReading) < distanceSettings.deadZoneSize)
+	if (abs(newDistanceReading - distanceactiveReading->distance) < distanceSettings.deadZoneSize)
 	{
 		// we have read the distance but the change is less than the dead zone
 		// just return
 		return;
 	}
 
+	distanceactiveReading->distance = newDistanceReading;
+
 	Distance.millisAtLastReading = millis();
+	Distance.readingNumber++;
 
 	sensorListener *pos = Distance.listeners;
 
@@ -301,8 +304,7 @@ void addDistanceReading(char *jsonBuffer, int jsonBufferSize)
 {
 	if (Distance.status == SENSOR_OK)
 	{
-		appendFormattedString(jsonBuffer, jsonBufferSize, ",\"dist\":\"%d\"",
-							  readDistance());
+		addSensorReadingInt(jsonBuffer, jsonBufferSize, "dist", readDistance());
 	}
 }
 
@@ -351,6 +353,9 @@ struct sensor Distance = {
 	false, // being updated
 	NULL,  // active reading - set in setup
 	0,	   // active time
+	0,	   // poll interval - zero means every update
+	0,	   // poll offset
+	0,	   // millis at last poll
 	(unsigned char *)&distanceSettings,
 	sizeof(struct DistanceSettings),
 	&DistanceSettingItems,
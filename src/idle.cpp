@@ -0,0 +1,464 @@
+#include <Arduino.h>
+
+#include "idle.h"
+#include "utils.h"
+#include "settings.h"
+#include "processes.h"
+#include "sensors.h"
+#include "messages.h"
+#include "metrics.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#endif
+
+struct IdleSettings idleSettings;
+
+void setDefaultIdleMaxSleepMillis(void *dest)
+{
+	int *destInt = (int *)dest;
+	*destInt = 100;
+}
+
+void setDefaultIdleMinSleepMillis(void *dest)
+{
+	int *destInt = (int *)dest;
+	*destInt = IDLE_LOOP_DELAY_MILLIS;
+}
+
+struct SettingItem idleSleepEnabledSetting = {
+	"Sleep when idle (yes or no)",
+	"idlesleepactive",
+	&idleSettings.idleSleepEnabled,
+	ONOFF_INPUT_LENGTH,
+	yesNo,
+	setFalse,
+	validateYesNo};
+
+boolean validateIdleSleepMillis(void *dest, const char *newValueStr)
+{
+	int value;
+
+	if (!validateInt(&value, newValueStr))
+	{
+		return false;
+	}
+
+	if (value < 0 || value > IDLE_SLEEP_LIMIT_MILLIS)
+	{
+		return false;
+	}
+
+	*(int *)dest = value;
+
+	return true;
+}
+
+struct SettingItem idleMaxSleepMillisSetting = {
+	"Longest idle sleep in millis",
+	"idlemaxsleepmillis",
+	&idleSettings.idleMaxSleepMillis,
+	NUMBER_INPUT_LENGTH,
+	integerValue,
+	setDefaultIdleMaxSleepMillis,
+	validateIdleSleepMillis};
+
+struct SettingItem idleMinSleepMillisSetting = {
+	"Shortest idle sleep in millis",
+	"idleminsleepmillis",
+	&idleSettings.idleMinSleepMillis,
+	NUMBER_INPUT_LENGTH,
+	integerValue,
+	setDefaultIdleMinSleepMillis,
+	validateIdleSleepMillis};
+
+struct SettingItem idleLogWakesSetting = {
+	"Log each idle wake (yes or no)",
+	"idlelogwakes",
+	&idleSettings.idleLogWakes,
+	ONOFF_INPUT_LENGTH,
+	yesNo,
+	setFalse,
+	validateYesNo};
+
+struct SettingItem *idleSettingItemPointers[] =
+	{
+		&idleSleepEnabledSetting,
+		&idleMaxSleepMillisSetting,
+		&idleMinSleepMillisSetting,
+		&idleLogWakesSetting};
+
+struct SettingItemCollection idleSettingItems = {
+	"idle",
+	"Light sleep between loop updates for battery powered devices",
+	idleSettingItemPointers,
+	sizeof(idleSettingItemPointers) / sizeof(struct SettingItem *)};
+
+// enough room for the processes that have their own timing
+
+unsigned long (*idleDeadlineList[IDLE_MAX_NO_OF_DEADLINES])(unsigned long currentMillis) = {NULL};
+
+int idleWakePins[IDLE_MAX_NO_OF_WAKE_PINS] = {-1, -1, -1, -1};
+int idleWakePinLevels[IDLE_MAX_NO_OF_WAKE_PINS];
+
+unsigned long idleStartMillis;
+unsigned long idleTotalSleepMillis;
+unsigned long idleNoOfSleeps;
+unsigned long idleTimerWakes;
+unsigned long idleInputWakes;
+unsigned long idleOtherWakes;
+
+bool bindIdleDeadline(unsigned long (*millisToDeadline)(unsigned long currentMillis))
+{
+	for (int i = 0; i < IDLE_MAX_NO_OF_DEADLINES; i++)
+	{
+		if (idleDeadlineList[i] == millisToDeadline)
+		{
+			return true;
+		}
+
+		if (idleDeadlineList[i] == NULL)
+		{
+			idleDeadlineList[i] = millisToDeadline;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool bindIdleWakePin(int pinNo)
+{
+	for (int i = 0; i < IDLE_MAX_NO_OF_WAKE_PINS; i++)
+	{
+		if (idleWakePins[i] == pinNo)
+		{
+			return true;
+		}
+
+		if (idleWakePins[i] == -1)
+		{
+			idleWakePins[i] = pinNo;
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned long millisToNextIdleDeadline(unsigned long currentMillis)
+{
+	// sensors polled on every pass and processes without a deadline
+	// are serviced at least this often
+
+	unsigned long result = 0;
+
+	if (idleSettings.idleMaxSleepMillis > 0)
+	{
+		result = idleSettings.idleMaxSleepMillis;
+	}
+
+	unsigned long sensorMillis = millisToNextSensorPoll(currentMillis);
+
+	if (sensorMillis < result)
+	{
+		result = sensorMillis;
+	}
+
+	for (int i = 0; i < IDLE_MAX_NO_OF_DEADLINES; i++)
+	{
+		if (idleDeadlineList[i] == NULL)
+		{
+			break;
+		}
+
+		unsigned long deadlineMillis = idleDeadlineList[i](currentMillis);
+
+		if (deadlineMillis < result)
+		{
+			result = deadlineMillis;
+		}
+	}
+
+	return result;
+}
+
+// wake pins wake the device when they move away from the level
+// they had when the sleep started
+
+void recordWakePinLevels()
+{
+	for (int i = 0; i < IDLE_MAX_NO_OF_WAKE_PINS; i++)
+	{
+		if (idleWakePins[i] != -1)
+		{
+			idleWakePinLevels[i] = digitalRead(idleWakePins[i]);
+		}
+	}
+}
+
+bool wakePinChanged()
+{
+	for (int i = 0; i < IDLE_MAX_NO_OF_WAKE_PINS; i++)
+	{
+		if (idleWakePins[i] != -1)
+		{
+			if (digitalRead(idleWakePins[i]) != idleWakePinLevels[i])
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// Sleeps in short slices so that a change on a wake pin ends the sleep
+// early. The ESP8266 drops into automatic light sleep inside delay once
+// WIFI_LIGHT_SLEEP has been selected and the PICO core waits for an event.
+
+idleWakeReason sleepWithDelay(unsigned long sleepMillis)
+{
+	unsigned long sleepStart = millis();
+	unsigned long sliceMillis = idleSettings.idleMinSleepMillis;
+
+	if (sliceMillis < 1)
+	{
+		sliceMillis = 1;
+	}
+
+	while (true)
+	{
+		unsigned long sleptMillis = ulongDiff(millis(), sleepStart);
+
+		if (sleptMillis >= sleepMillis)
+		{
+			return idleWakeTimer;
+		}
+
+		unsigned long remainingMillis = sleepMillis - sleptMillis;
+
+		delay(remainingMillis < sliceMillis ? remainingMillis : sliceMillis);
+
+		if (wakePinChanged())
+		{
+			return idleWakeInput;
+		}
+	}
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+// A forced light sleep drops the WiFi association on the ESP32 so it is
+// only used when the device is not connected. When it is connected the
+// modem sleeps between beacons while we wait in delay.
+
+idleWakeReason sleepESP32(unsigned long sleepMillis)
+{
+	if (WiFi.status() == WL_CONNECTED)
+	{
+		return sleepWithDelay(sleepMillis);
+	}
+
+	esp_sleep_enable_timer_wakeup((uint64_t)sleepMillis * 1000);
+
+	bool gotWakePin = false;
+
+	for (int i = 0; i < IDLE_MAX_NO_OF_WAKE_PINS; i++)
+	{
+		if (idleWakePins[i] != -1)
+		{
+			gpio_int_type_t wakeLevel = idleWakePinLevels[i] == HIGH ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+			gpio_wakeup_enable((gpio_num_t)idleWakePins[i], wakeLevel);
+			gotWakePin = true;
+		}
+	}
+
+	if (gotWakePin)
+	{
+		esp_sleep_enable_gpio_wakeup();
+	}
+
+	esp_light_sleep_start();
+
+	for (int i = 0; i < IDLE_MAX_NO_OF_WAKE_PINS; i++)
+	{
+		if (idleWakePins[i] != -1)
+		{
+			gpio_wakeup_disable((gpio_num_t)idleWakePins[i]);
+		}
+	}
+
+	switch (esp_sleep_get_wakeup_cause())
+	{
+	case ESP_SLEEP_WAKEUP_TIMER:
+		return idleWakeTimer;
+	case ESP_SLEEP_WAKEUP_GPIO:
+		return idleWakeInput;
+	default:
+		return idleWakeOther;
+	}
+}
+
+#endif
+
+const char *idleWakeReasonName(idleWakeReason reason)
+{
+	switch (reason)
+	{
+	case idleWakeTimer:
+		return "timer";
+	case idleWakeInput:
+		return "input";
+	case idleWakeOther:
+		return "other";
+	default:
+		return "none";
+	}
+}
+
+void idle()
+{
+	if (idleProcess.status != IDLE_OK)
+	{
+		delay(IDLE_LOOP_DELAY_MILLIS);
+		return;
+	}
+
+	unsigned long sleepStart = millis();
+
+	unsigned long sleepMillis = millisToNextIdleDeadline(sleepStart);
+
+	if (sleepMillis < (unsigned long)idleSettings.idleMinSleepMillis)
+	{
+		// not worth sleeping - just give the network stack a chance
+		delay(sleepMillis);
+		return;
+	}
+
+	recordWakePinLevels();
+
+#if defined(ARDUINO_ARCH_ESP32)
+	idleWakeReason reason = sleepESP32(sleepMillis);
+#else
+	idleWakeReason reason = sleepWithDelay(sleepMillis);
+#endif
+
+	unsigned long sleptMillis = ulongDiff(millis(), sleepStart);
+
+	idleTotalSleepMillis += sleptMillis;
+	idleNoOfSleeps++;
+
+	switch (reason)
+	{
+	case idleWakeTimer:
+		idleTimerWakes++;
+		break;
+	case idleWakeInput:
+		idleInputWakes++;
+		break;
+	default:
+		idleOtherWakes++;
+		break;
+	}
+
+	if (idleSettings.idleLogWakes)
+	{
+		displayMessage(F("Idle slept %lu of %lu millis woken by %s\n"),
+					   sleptMillis, sleepMillis, idleWakeReasonName(reason));
+	}
+}
+
+void initIdle()
+{
+	idleProcess.status = IDLE_STOPPED;
+	addCounterMetric("idlesleepmillis", &idleTotalSleepMillis);
+	addCounterMetric("idletimerwakes", &idleTimerWakes);
+	addCounterMetric("idleinputwakes", &idleInputWakes);
+	addCounterMetric("idleotherwakes", &idleOtherWakes);
+}
+
+void startIdle()
+{
+	idleStartMillis = millis();
+	idleTotalSleepMillis = 0;
+	idleNoOfSleeps = 0;
+	idleTimerWakes = 0;
+	idleInputWakes = 0;
+	idleOtherWakes = 0;
+
+	if (!idleSettings.idleSleepEnabled)
+	{
+		idleProcess.status = IDLE_SLEEPING_OFF;
+		return;
+	}
+
+#if defined(ARDUINO_ARCH_ESP8266)
+	WiFi.setSleepMode(WIFI_LIGHT_SLEEP);
+#endif
+
+	idleProcess.status = IDLE_OK;
+}
+
+void updateIdle()
+{
+}
+
+void stopIdle()
+{
+	idleProcess.status = IDLE_STOPPED;
+}
+
+bool idleStatusOK()
+{
+	return idleProcess.status == IDLE_OK;
+}
+
+void idleStatusMessage(char *buffer, int bufferLength)
+{
+	switch (idleProcess.status)
+	{
+	case IDLE_OK:
+	{
+		unsigned long runMillis = ulongDiff(millis(), idleStartMillis);
+		unsigned long residency = 0;
+		if (runMillis > 0)
+		{
+			residency = (unsigned long)((idleTotalSleepMillis * 100ULL) / runMillis);
+		}
+		snprintf(buffer, bufferLength, "Idle sleep residency:%lu%% sleeps:%lu timer wakes:%lu input wakes:%lu other wakes:%lu",
+				 residency, idleNoOfSleeps, idleTimerWakes, idleInputWakes, idleOtherWakes);
+		break;
+	}
+	case IDLE_SLEEPING_OFF:
+		snprintf(buffer, bufferLength, "Idle sleep off");
+		break;
+	case IDLE_STOPPED:
+		snprintf(buffer, bufferLength, "Idle stopped");
+		break;
+	default:
+		snprintf(buffer, bufferLength, "Idle status invalid");
+		break;
+	}
+}
+
+struct process idleProcess = {
+	"idle",
+	initIdle,
+	startIdle,
+	updateIdle,
+	stopIdle,
+	idleStatusOK,
+	idleStatusMessage,
+	false,
+	0,
+	0,
+	0,
+	NULL,
+	(unsigned char *)&idleSettings, sizeof(IdleSettings), &idleSettingItems,
+	NULL,
+	BOOT_PROCESS + ACTIVE_PROCESS,
+	NULL,
+	NULL,
+	NULL,
+	NULL, // no command options
+	0	  // no command options
+};
@@ -409,7 +409,7 @@ void startLcdPanel()
 
     if (lcdPanelSettings.printMessages)
     {
-        bindMessageHandler(displayMessageOnStatusLcdPanel);
+        bindQueuedMessageHandler(displayMessageOnStatusLcdPanel);
     }
 }
 
@@ -419,6 +419,8 @@ void updateLcdPanel()
     {
         return;
     }
+
+    deliverQueuedMessage(displayMessageOnStatusLcdPanel);
 }
 
 void stopLcdPanel()
@@ -97,11 +97,14 @@ void loop()
 #include "codeEditorProcess.h"
 #include "lcdPanel.h"
 #include "remoteRobotProcess.h"
+#include "idle.h"
+#include "metrics.h"
 
 // This function will be different for each build of the device.
 
 void populateProcessList()
 {
+  addProcessToAllProcessList(&bootProcessDescriptor);
 #if defined(PROCESS_CONSOLE)
   addProcessToAllProcessList(&consoleProcessDescriptor);
 #endif
@@ -156,6 +159,12 @@ void populateProcessList()
 #if defined(PROCESS_REMOTE_ROBOT_DRIVE)
   addProcessToAllProcessList(&robotProcess);
 #endif
+#if defined(PROCESS_IDLE)
+  addProcessToAllProcessList(&idleProcess);
+#endif
+#if defined(PROCESS_METRICS)
+  addProcessToAllProcessList(&metricsProcess);
+#endif
 }
 
 void populateSensorList()
@@ -234,19 +243,11 @@ void startDevice()
 
 #endif
 
-  Serial.printf("\n\nStarting\n\n");
-
-  char deviceNameBuffer[DEVICE_NAME_LENGTH];
-  PrintSystemDetails(deviceNameBuffer, DEVICE_NAME_LENGTH);
-  Serial.printf("%s\n", deviceNameBuffer);
-  Serial.printf("Connected Little Boxes Device\n");
-  Serial.printf("Powered by HULLOS-X\n");
-  Serial.printf("www.connectedlittleboxes.com\n");
-  Serial.printf("Version %s build date: %s %s\n", Version, __DATE__, __TIME__);
+  // nothing is sent until the serial port has settled, or the settings
+  // have been loaded and fast boot is on
+  holdMessages();
 
-#ifdef DEBUG
-  messageLogf("**** Debug output enabled");
-#endif
+  recordBootPhase("Serial start");
 
   START_MEMORY_MONITOR();
 
@@ -258,13 +259,42 @@ void startDevice()
 
   DISPLAY_MEMORY_MONITOR("Populate sensor list");
 
-  Serial.printf("Setup settings complete\n");
+  recordBootPhase("Populate lists");
 
   // set the parameter to true to force a setting request
   // useful if one of the settings as broken the boot
 
   SettingsSetupStatus status = setupSettings(false);
 
+  recordBootPhase("Load settings");
+
+  // settings are loaded before the serial settle delay so that
+  // fast boot can skip it. The messages made so far are in the ring.
+
+  if (!bootSettings.fastBoot)
+  {
+    delay(BOOT_SERIAL_SETTLE_MILLIS);
+    recordBootPhase("Serial settle");
+  }
+
+  Serial.printf("\n\nStarting\n\n");
+
+  char deviceNameBuffer[DEVICE_NAME_LENGTH];
+  PrintSystemDetails(deviceNameBuffer, DEVICE_NAME_LENGTH);
+  Serial.printf("%s\n", deviceNameBuffer);
+  Serial.printf("Connected Little Boxes Device\n");
+  Serial.printf("Powered by HULLOS-X\n");
+  Serial.printf("www.connectedlittleboxes.com\n");
+  Serial.printf("Version %s build date: %s %s\n", Version, __DATE__, __TIME__);
+
+  releaseMessages();
+
+#ifdef DEBUG
+  messageLogf("**** Debug output enabled");
+#endif
+
+  Serial.printf("Setup settings complete\n");
+
   switch (status)
   {
   case SETTINGS_SETUP_OK:
@@ -322,11 +352,15 @@ void startDevice()
 
   DISPLAY_MEMORY_MONITOR("Initialise all processes\n");
 
+  recordBootPhase("Initialise processes");
+
   buildActiveProcessListFromMask(BOOT_PROCESS);
 
   startProcesses();
 
-  DISPLAY_MEMORY_MONITOR("Initialise all processes\n");
+  DISPLAY_MEMORY_MONITOR("Start processes\n");
+
+  recordBootPhase("Start processes");
 
   bindMessageHandler(displayControlMessage);
 
@@ -334,7 +368,12 @@ void startDevice()
 
   DISPLAY_MEMORY_MONITOR("Start all sensors\n");
 
-  delay(1000); // show the status for a while
+  recordBootPhase("Start sensors");
+
+  if (!bootSettings.fastBoot)
+  {
+    delay(BOOT_STATUS_DISPLAY_MILLIS); // show the status for a while
+  }
 
   displayMessage(F("Start complete\n\nType help and press enter for help\n\n"));
 }
@@ -363,7 +402,6 @@ void heapMonitor()
 
 void setup()
 {
-  delay(3000);
   startDevice();
 }
 
@@ -371,7 +409,9 @@ void loop()
 {
   updateSensors();
   updateProcesses();
-  delay(5);
+  updateSettings();
+  completeBoot();
+  idle();
   //  DISPLAY_MEMORY_MONITOR("System");
 }
 
@@ -1,5 +1,3 @@
-#pragma once
-
 #include <Arduino.h>
 
 #if defined(PICO_USE_UART)
@@ -11,9 +9,12 @@
 #include "settings.h"
 #include "messages.h"
 #include "processes.h"
+#include "idle.h"
+#include "metrics.h"
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 
 struct MessagesSettings messagesSettings;
 
@@ -36,10 +37,52 @@ struct SettingItem speedMessagesEnabled = {
     validateYesNo};
 
 
+struct SettingItem asyncMessagesEnabled = {
+    "Queue messages and send them when idle",
+    "asyncmessagesactive",
+    &messagesSettings.asyncMessagesEnabled,
+    ONOFF_INPUT_LENGTH,
+    yesNo,
+    setFalse,
+    validateYesNo};
+
+void setDefaultLogLevel(void *dest)
+{
+    int *destInt = (int *)dest;
+    *destInt = LOG_LEVEL;
+}
+
+void setDefaultLogModuleMask(void *dest)
+{
+    int *destInt = (int *)dest;
+    *destInt = LOG_MODULE_ALL;
+}
+
+struct SettingItem logLevelSetting = {
+    "Lowest log level displayed (0=debug 1=info 2=warning 3=error 4=none)",
+    "loglevel",
+    &messagesSettings.logLevel,
+    NUMBER_INPUT_LENGTH,
+    integerValue,
+    setDefaultLogLevel,
+    validateInt};
+
+struct SettingItem logModuleMaskSetting = {
+    "Log module mask (use the log command to set)",
+    "logmodulemask",
+    &messagesSettings.logModuleMask,
+    NUMBER_INPUT_LENGTH,
+    integerValue,
+    setDefaultLogModuleMask,
+    validateInt};
+
     struct SettingItem *messagesSettingItemPointers[] =
     {
         &messagesEnabled,
-        &speedMessagesEnabled
+        &speedMessagesEnabled,
+        &asyncMessagesEnabled,
+        &logLevelSetting,
+        &logModuleMaskSetting
     };
 
 struct SettingItemCollection messagesSettingItems = {
@@ -68,11 +111,162 @@ void messagesOn()
 #define MSG_FLASH_FMT_BUF 160
 #endif
 
+// Message text is formatted when the message is created because the
+// arguments are often pointers into buffers that will not be there
+// later. The text is then copied into a ring that is written to the
+// serial port as space becomes free in the transmit buffer. There is a
+// single writer and a single reader, both running in the loop.
+
+char messageRing[MESSAGE_RING_SIZE];
+volatile unsigned int messageRingHead = 0; // next byte to write
+volatile unsigned int messageRingTail = 0; // next byte to send
+
+unsigned long messagesQueued = 0;
+unsigned long messagesDropped = 0;
+unsigned int messageRingHighWater = 0;
+
+int synchronousMessageDepth = 0;
+
+// messages made at boot before the serial port has settled are kept in
+// the ring until releaseMessages is called
+bool messagesHeld = false;
+
+unsigned int messageRingUsed()
+{
+    return (messageRingHead - messageRingTail + MESSAGE_RING_SIZE) % MESSAGE_RING_SIZE;
+}
+
+bool messagesAsyncActive()
+{
+    return messagesProcess.status == MESSAGES_OK &&
+           messagesSettings.asyncMessagesEnabled &&
+           synchronousMessageDepth == 0;
+}
+
+void copyIntoMessageRing(const char *text, unsigned int length)
+{
+    unsigned int head = messageRingHead;
+
+    for (unsigned int i = 0; i < length; i++)
+    {
+        messageRing[head] = text[i];
+        head = (head + 1) % MESSAGE_RING_SIZE;
+    }
+
+    // publish the bytes only once they are all in place
+    messageRingHead = head;
+}
+
+// writes as much of the ring as will fit in the serial transmit buffer
+// or all of it if wait is true
+
+void sendMessageRing(bool wait)
+{
+    if (messagesHeld)
+    {
+        return;
+    }
+
+    while (messageRingTail != messageRingHead)
+    {
+        unsigned int tail = messageRingTail;
+        unsigned int head = messageRingHead;
+        unsigned int length = (head > tail) ? head - tail : MESSAGE_RING_SIZE - tail;
+
+        if (!wait)
+        {
+            int space = Serial.availableForWrite();
+
+            if (space <= 0)
+            {
+                return;
+            }
+
+            if ((unsigned int)space < length)
+            {
+                length = space;
+            }
+        }
+
+        Serial.write((const uint8_t *)(messageRing + tail), length);
+
+        messageRingTail = (tail + length) % MESSAGE_RING_SIZE;
+    }
+}
+
+void flushMessages()
+{
+    sendMessageRing(true);
+}
+
+void holdMessages()
+{
+    messagesHeld = true;
+}
+
+void releaseMessages()
+{
+    messagesHeld = false;
+    flushMessages();
+}
+
+void beginSynchronousMessages()
+{
+    flushMessages();
+    synchronousMessageDepth++;
+}
+
+void endSynchronousMessages()
+{
+    if (synchronousMessageDepth > 0)
+    {
+        synchronousMessageDepth--;
+    }
+}
+
+static void outputMessageText(const char *text, bool newline)
+{
+    if (!messagesHeld && !messagesAsyncActive())
+    {
+        // anything already queued goes out first to keep messages in order
+        flushMessages();
+        if (newline) Serial.println(text);
+        else         Serial.print(text);
+        return;
+    }
+
+    unsigned int length = strlen(text);
+    unsigned int needed = newline ? length + 2 : length;
+
+    // one byte is always left empty so that a full ring can be told apart from an empty one
+
+    if (needed > MESSAGE_RING_SIZE - 1 - messageRingUsed())
+    {
+        messagesDropped++;
+        return;
+    }
+
+    copyIntoMessageRing(text, length);
+
+    if (newline)
+    {
+        copyIntoMessageRing("\r\n", 2);
+    }
+
+    messagesQueued++;
+
+    unsigned int used = messageRingUsed();
+
+    if (used > messageRingHighWater)
+    {
+        messageRingHighWater = used;
+    }
+}
+
 static void vprintFromRamFmt(const char* fmt, va_list ap, bool newline) {
   char out[MSG_FMT_BUF];
   vsnprintf(out, sizeof(out), fmt ? fmt : "", ap);
-  if (newline) Serial.println(out);
-  else         Serial.print(out);
+  outputMessageText(out, newline);
 }
 
 static void vprintFromFlashFmt(const __FlashStringHelper* ffmt, va_list ap, bool newline) {
@@ -83,8 +277,7 @@ static void vprintFromFlashFmt(const __FlashStringHelper* ffmt, va_list ap, bool
 
   char out[MSG_FMT_BUF];
   vsnprintf(out, sizeof(out), fmt, ap);
-  if (newline) Serial.println(out);
-  else         Serial.print(out);
+  outputMessageText(out, newline);
 }
 
 // -------- printf-style (flash) --------
@@ -113,13 +306,98 @@ void displayMessageWithNewline(const char* fmt, ...) {
   va_end(ap);
 }
 
+// -------- levelled and tagged log messages --------
+
+struct logName
+{
+    const char *name;
+    int value;
+};
+
+struct logName logLevelNames[] = {
+    {"debug", LOG_LEVEL_DEBUG},
+    {"info", LOG_LEVEL_INFO},
+    {"warning", LOG_LEVEL_WARNING},
+    {"error", LOG_LEVEL_ERROR},
+    {"none", LOG_LEVEL_NONE}};
+
+struct logName logModuleNames[] = {
+    {"mqtt", LOG_MODULE_MQTT},
+    {"wifi", LOG_MODULE_WIFI},
+    {"sensors", LOG_MODULE_SENSORS},
+    {"processes", LOG_MODULE_PROCESSES},
+    {"hullos", LOG_MODULE_HULLOS},
+    {"settings", LOG_MODULE_SETTINGS},
+    {"pixels", LOG_MODULE_PIXELS},
+    {"boot", LOG_MODULE_BOOT},
+    {"all", LOG_MODULE_ALL}};
+
+#define NO_OF_LOG_LEVEL_NAMES (int)(sizeof(logLevelNames) / sizeof(struct logName))
+#define NO_OF_LOG_MODULE_NAMES (int)(sizeof(logModuleNames) / sizeof(struct logName))
+
+int findLogName(struct logName *names, int noOfNames, const char *name)
+{
+    for (int i = 0; i < noOfNames; i++)
+    {
+        if (strcasecmp(names[i].name, name) == 0)
+        {
+            return names[i].value;
+        }
+    }
+    return -1;
+}
+
+int findLogLevelByName(const char *name)
+{
+    return findLogName(logLevelNames, NO_OF_LOG_LEVEL_NAMES, name);
+}
+
+int findLogModuleByName(const char *name)
+{
+    return findLogName(logModuleNames, NO_OF_LOG_MODULE_NAMES, name);
+}
+
+const char *logLevelName(int level)
+{
+    for (int i = 0; i < NO_OF_LOG_LEVEL_NAMES; i++)
+    {
+        if (logLevelNames[i].value == level)
+        {
+            return logLevelNames[i].name;
+        }
+    }
+    return "unknown";
+}
+
+void dumpLogSettings()
+{
+    displayMessage(F("Log level: %s (lowest built in: %s)\n"),
+                   logLevelName(messagesSettings.logLevel), logLevelName(LOG_LEVEL));
+
+    // leave out the "all" entry at the end
+
+    for (int i = 0; i < NO_OF_LOG_MODULE_NAMES - 1; i++)
+    {
+        displayMessage(F("   %s: %s\n"), logModuleNames[i].name,
+                       (messagesSettings.logModuleMask & logModuleNames[i].value) ? "on" : "off");
+    }
+}
+
+void logMessage(int level, int module, const __FlashStringHelper* fmt, ...) {
+  if (level < messagesSettings.logLevel) return;
+  if ((module & messagesSettings.logModuleMask) == 0) return;
+  va_list ap; va_start(ap, fmt);
+  vprintFromFlashFmt(fmt, ap, /*newline*/false);
+  va_end(ap);
+}
+
 // -------- String convenience (no formatting) --------
 void displayMessage(const String& s) {
-  Serial.print(s);
+  outputMessageText(s.c_str(), false);
 }
 
 void displayMessageWithNewline(const String& s) {
-  Serial.println(s);
+  outputMessageText(s.c_str(), true);
 }
 
 
@@ -140,6 +418,117 @@ bool bindMessageHandler(void (*newHandler)(int messageNumber, ledFlashBehaviour
     return false;
 }
 
+struct queuedMessage
+{
+    bool pending;
+    int messageNumber;
+    unsigned long sequenceNumber;
+    char messageText[QUEUED_MESSAGE_TEXT_LENGTH];
+};
+
+struct queuedMessageHandler
+{
+    void (*handler)(int messageNumber, ledFlashBehaviour severity, char *messageText);
+    struct queuedMessage messages[NO_OF_MESSAGE_SEVERITIES];
+};
+
+struct queuedMessageHandler queuedMessageHandlerList[MAX_NO_OF_QUEUED_MESSAGE_HANDLERS];
+
+unsigned long queuedMessageSequenceNumber = 0;
+unsigned long queuedMessagesDelivered = 0;
+unsigned long queuedMessagesSuperseded = 0;
+unsigned long queuedMessagesTruncated = 0;
+
+bool bindQueuedMessageHandler(void (*newHandler)(int messageNumber, ledFlashBehaviour severity, char *messageText))
+{
+    for (int i = 0; i < MAX_NO_OF_QUEUED_MESSAGE_HANDLERS; i++)
+    {
+        if (queuedMessageHandlerList[i].handler == newHandler)
+        {
+            return true;
+        }
+
+        if (queuedMessageHandlerList[i].handler == NULL)
+        {
+            queuedMessageHandlerList[i].handler = newHandler;
+            return true;
+        }
+    }
+    return false;
+}
+
+// a newer message of the same severity replaces one that has not been delivered yet
+
+void queueMessageForHandlers(int messageNumber, ledFlashBehaviour severity, char *messageText)
+{
+    if (severity < 0 || severity >= NO_OF_MESSAGE_SEVERITIES)
+    {
+        return;
+    }
+
+    queuedMessageSequenceNumber++;
+
+    for (int i = 0; i < MAX_NO_OF_QUEUED_MESSAGE_HANDLERS; i++)
+    {
+        if (queuedMessageHandlerList[i].handler == NULL)
+        {
+            break;
+        }
+
+        struct queuedMessage *message = &queuedMessageHandlerList[i].messages[severity];
+
+        if (message->pending)
+        {
+            queuedMessagesSuperseded++;
+        }
+
+        message->messageNumber = messageNumber;
+        message->sequenceNumber = queuedMessageSequenceNumber;
+        if (strlen(messageText) >= QUEUED_MESSAGE_TEXT_LENGTH)
+        {
+            queuedMessagesTruncated++;
+        }
+        strncpy(message->messageText, messageText, QUEUED_MESSAGE_TEXT_LENGTH - 1);
+        message->messageText[QUEUED_MESSAGE_TEXT_LENGTH - 1] = 0;
+        message->pending = true;
+    }
+}
+
+bool deliverQueuedMessage(void (*handler)(int messageNumber, ledFlashBehaviour severity, char *messageText))
+{
+    for (int i = 0; i < MAX_NO_OF_QUEUED_MESSAGE_HANDLERS; i++)
+    {
+        if (queuedMessageHandlerList[i].handler != handler)
+        {
+            continue;
+        }
+
+        struct queuedMessage *messages = queuedMessageHandlerList[i].messages;
+        int oldest = -1;
+
+        for (int severity = 0; severity < NO_OF_MESSAGE_SEVERITIES; severity++)
+        {
+            if (messages[severity].pending &&
+                (oldest == -1 || messages[severity].sequenceNumber < messages[oldest].sequenceNumber))
+            {
+                oldest = severity;
+            }
+        }
+
+        if (oldest == -1)
+        {
+            return false;
+        }
+
+        // clear the flag first so that a message raised by the handler is not lost
+        messages[oldest].pending = false;
+        handler(messages[oldest].messageNumber, (ledFlashBehaviour)oldest, messages[oldest].messageText);
+        queuedMessagesDelivered++;
+        return true;
+    }
+    return false;
+}
+
 void ledFlashBehaviourToString(ledFlashBehaviour severity, char *dest, int length)
 {
     switch (severity)
@@ -175,11 +564,30 @@ void hardwareDisplayMessage(int messageNumber, ledFlashBehaviour severity, char
             messageHandlerList[i](messageNumber, severity, messageText);
         }
     }
+
+    queueMessageForHandlers(messageNumber, severity, messageText);
+}
+
+// the loop must come round again while there is text waiting to be sent
+
+unsigned long millisToNextMessageDrain(unsigned long /* currentMillis */)
+{
+    if (messageRingTail == messageRingHead)
+    {
+        return IDLE_NO_DEADLINE;
+    }
+
+    return MESSAGE_DRAIN_INTERVAL_MILLIS;
 }
 
 void initMessages()
 {
     messagesProcess.status = MESSAGES_STOPPED;
+    bindIdleDeadline(millisToNextMessageDrain);
+    addCounterMetric("messagesqueued", &messagesQueued);
+    addCounterMetric("messagesdropped", &messagesDropped);
+    addCounterMetric("displaysuperseded", &queuedMessagesSuperseded);
+    addCounterMetric("displaytruncated", &queuedMessagesTruncated);
 }
 
 void startMessages()
@@ -195,10 +603,12 @@ void startMessages()
 
 void updateMessages()
 {
+    sendMessageRing(false);
 }
 
 void stopmessages()
 {
+    flushMessages();
     messagesProcess.status = MESSAGES_STOPPED;
 }
 
@@ -215,7 +625,21 @@ void messagesStatusMessage(char *buffer, int bufferLength)
     }
     else
     {
-        snprintf(buffer, bufferLength, "Messages enabled");
+        if (messagesSettings.asyncMessagesEnabled)
+        {
+            snprintf(buffer, bufferLength, "Messages enabled queued:%lu dropped:%lu ring high water:%u of %d",
+                     messagesQueued, messagesDropped, messageRingHighWater, MESSAGE_RING_SIZE);
+        }
+        else
+        {
+            snprintf(buffer, bufferLength, "Messages enabled");
+        }
+
+        if (queuedMessageHandlerList[0].handler != NULL)
+        {
+            appendFormattedString(buffer, bufferLength, " display messages delivered:%lu superseded:%lu truncated:%lu",
+                                  queuedMessagesDelivered, queuedMessagesSuperseded, queuedMessagesTruncated);
+        }
     }
 }
 
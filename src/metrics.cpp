@@ -0,0 +1,452 @@
+#include <Arduino.h>
+
+#include "metrics.h"
+#include "utils.h"
+#include "settings.h"
+#include "processes.h"
+#include "sensors.h"
+#include "messages.h"
+#include "mqtt.h"
+
+struct MetricsSettings metricsSettings;
+
+void setDefaultMetricsPublishSecs(void *dest)
+{
+	int *destInt = (int *)dest;
+	*destInt = 0;
+}
+
+void setDefaultMetricsTopic(void *dest)
+{
+	snprintf((char *)dest, METRICS_TOPIC_LENGTH, "metrics");
+}
+
+boolean validateMetricsTopic(void *dest, const char *newValueStr)
+{
+	return (validateString((char *)dest, newValueStr, METRICS_TOPIC_LENGTH));
+}
+
+struct SettingItem metricsPublishSecsSetting = {
+	"Seconds between metrics publishes (0 for off)",
+	"metricspublishsecs",
+	&metricsSettings.metricsPublishSecs,
+	NUMBER_INPUT_LENGTH,
+	integerValue,
+	setDefaultMetricsPublishSecs,
+	validateInt};
+
+struct SettingItem metricsTopicSetting = {
+	"Metrics MQTT topic",
+	"metricstopic",
+	metricsSettings.metricsTopic,
+	METRICS_TOPIC_LENGTH,
+	text,
+	setDefaultMetricsTopic,
+	validateMetricsTopic};
+
+struct SettingItem *metricsSettingItemPointers[] =
+	{
+		&metricsPublishSecsSetting,
+		&metricsTopicSetting};
+
+struct SettingItemCollection metricsSettingItems = {
+	"metrics",
+	"Performance metrics published over MQTT",
+	metricsSettingItemPointers,
+	sizeof(metricsSettingItemPointers) / sizeof(struct SettingItem *)};
+
+struct metric
+{
+	const char *name;
+	metricType type;
+	unsigned long *counter;
+	long (*readGauge)();
+	struct metricHistogram *histogram;
+};
+
+extern struct sensor *activeSensorList;
+
+struct metric metricList[METRICS_MAX_NO_OF_METRICS];
+int noOfMetrics = 0;
+
+// shared by the console command and the MQTT publish
+
+char metricsJsonBuffer[METRICS_JSON_BUFFER_SIZE];
+
+unsigned long millisAtLastMetricsPublish;
+
+// set when text would not fit in the buffer
+bool metricsTextOverflow = false;
+
+unsigned long metricsSplitPublishes = 0;
+unsigned long metricsOverflows = 0;
+
+bool addMetric(const char *name, metricType type, unsigned long *counter,
+			   long (*readGauge)(), struct metricHistogram *histogram)
+{
+	for (int i = 0; i < noOfMetrics; i++)
+	{
+		if (strcmp(metricList[i].name, name) == 0)
+		{
+			return true;
+		}
+	}
+
+	if (noOfMetrics >= METRICS_MAX_NO_OF_METRICS)
+	{
+		displayMessage(F("Too many metrics to add %s\n"), name);
+		return false;
+	}
+
+	metricList[noOfMetrics].name = name;
+	metricList[noOfMetrics].type = type;
+	metricList[noOfMetrics].counter = counter;
+	metricList[noOfMetrics].readGauge = readGauge;
+	metricList[noOfMetrics].histogram = histogram;
+	noOfMetrics++;
+	return true;
+}
+
+bool addCounterMetric(const char *name, unsigned long *counter)
+{
+	return addMetric(name, metricTypeCounter, counter, NULL, NULL);
+}
+
+bool addGaugeMetric(const char *name, long (*readGauge)())
+{
+	return addMetric(name, metricTypeGauge, NULL, readGauge, NULL);
+}
+
+bool addHistogramMetric(const char *name, struct metricHistogram *histogram)
+{
+	if (histogram->noOfLimits >= METRICS_MAX_HISTOGRAM_BUCKETS)
+	{
+		// leave room for the overflow bucket
+		histogram->noOfLimits = METRICS_MAX_HISTOGRAM_BUCKETS - 1;
+	}
+	return addMetric(name, metricTypeHistogram, NULL, NULL, histogram);
+}
+
+void recordMetricHistogram(struct metricHistogram *histogram, unsigned long value)
+{
+	int bucket = 0;
+
+	while (bucket < histogram->noOfLimits && value >= histogram->bucketLimits[bucket])
+	{
+		bucket++;
+	}
+
+	histogram->counts[bucket]++;
+	histogram->noOfValues++;
+
+	if (value > histogram->maxValue)
+	{
+		histogram->maxValue = value;
+	}
+}
+
+// Appends to the buffer without the large stack buffer that
+// appendFormattedString needs. Output that doesn't fit is cut off
+// and metricsTextOverflow is set.
+
+int appendMetricsText(char *buffer, int bufferLength, int pos, const char *format, ...)
+{
+	if (pos >= bufferLength - 1)
+	{
+		metricsTextOverflow = true;
+		return pos;
+	}
+
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(buffer + pos, bufferLength - pos, format, args);
+	va_end(args);
+
+	if (length < 0)
+	{
+		return pos;
+	}
+
+	pos += length;
+
+	if (pos > bufferLength - 1)
+	{
+		metricsTextOverflow = true;
+		pos = bufferLength - 1;
+	}
+
+	return pos;
+}
+
+int appendMetricsOfType(char *buffer, int bufferLength, int pos, metricType type, const char *sectionName)
+{
+	pos = appendMetricsText(buffer, bufferLength, pos, ",\"%s\":{", sectionName);
+
+	bool first = true;
+
+	for (int i = 0; i < noOfMetrics; i++)
+	{
+		struct metric *m = &metricList[i];
+
+		if (m->type != type)
+		{
+			continue;
+		}
+
+		pos = appendMetricsText(buffer, bufferLength, pos, "%s\"%s\":", first ? "" : ",", m->name);
+		first = false;
+
+		switch (type)
+		{
+		case metricTypeCounter:
+			pos = appendMetricsText(buffer, bufferLength, pos, "%lu", *m->counter);
+			break;
+
+		case metricTypeGauge:
+			pos = appendMetricsText(buffer, bufferLength, pos, "%ld", m->readGauge());
+			break;
+
+		case metricTypeHistogram:
+		{
+			struct metricHistogram *h = m->histogram;
+
+			pos = appendMetricsText(buffer, bufferLength, pos, "{\"n\":%lu,\"max\":%lu,\"b\":[",
+									h->noOfValues, h->maxValue);
+
+			for (int b = 0; b <= h->noOfLimits; b++)
+			{
+				pos = appendMetricsText(buffer, bufferLength, pos, "%s%lu", b == 0 ? "" : ",", h->counts[b]);
+			}
+
+			pos = appendMetricsText(buffer, bufferLength, pos, "]}");
+			break;
+		}
+		}
+	}
+
+	return appendMetricsText(buffer, bufferLength, pos, "}");
+}
+
+bool createMetricsJson(char *buffer, int bufferLength, int sections)
+{
+	char deviceNameBuffer[DEVICE_NAME_LENGTH];
+	PrintSystemDetails(deviceNameBuffer, DEVICE_NAME_LENGTH);
+
+	int pos = 0;
+
+	buffer[0] = 0;
+	metricsTextOverflow = false;
+
+	pos = appendMetricsText(buffer, bufferLength, pos, "{\"dev\":\"%s\",\"up\":%lu", deviceNameBuffer, millis());
+
+	if (sections & METRICS_SECTION_COUNTERS)
+	{
+		pos = appendMetricsOfType(buffer, bufferLength, pos, metricTypeCounter, "c");
+	}
+
+	if (sections & METRICS_SECTION_GAUGES)
+	{
+		pos = appendMetricsOfType(buffer, bufferLength, pos, metricTypeGauge, "g");
+	}
+
+	if (sections & METRICS_SECTION_HISTOGRAMS)
+	{
+		pos = appendMetricsOfType(buffer, bufferLength, pos, metricTypeHistogram, "h");
+	}
+
+	if (sections & METRICS_SECTION_TIMES)
+	{
+		// total update time in microseconds of each running process
+
+		pos = appendMetricsText(buffer, bufferLength, pos, ",\"p\":{");
+
+		bool first = true;
+
+		struct process *procPtr = getAllProcessList();
+
+		while (procPtr != NULL)
+		{
+			if (procPtr->beingUpdated)
+			{
+				pos = appendMetricsText(buffer, bufferLength, pos, "%s\"%s\":%lu",
+										first ? "" : ",", procPtr->processName, procPtr->totalTime);
+				first = false;
+			}
+			procPtr = procPtr->nextAllProcesses;
+		}
+
+		pos = appendMetricsText(buffer, bufferLength, pos, "},\"s\":{");
+
+		first = true;
+
+		struct sensor *sensorPtr = activeSensorList;
+
+		while (sensorPtr != NULL)
+		{
+			if (sensorPtr->beingUpdated)
+			{
+				pos = appendMetricsText(buffer, bufferLength, pos, "%s\"%s\":%u",
+										first ? "" : ",", sensorPtr->sensorName, sensorPtr->activeTime);
+				first = false;
+			}
+			sensorPtr = sensorPtr->nextActiveSensor;
+		}
+
+		pos = appendMetricsText(buffer, bufferLength, pos, "}");
+	}
+
+	appendMetricsText(buffer, bufferLength, pos, "}");
+
+	return !metricsTextOverflow;
+}
+
+// Each section that doesn't fit in one message with the others is sent in
+// a message of its own. A section too big for the buffer on its own is
+// not sent and is counted.
+
+void sendMetrics(void (*send)(char *json))
+{
+	if (createMetricsJson(metricsJsonBuffer, METRICS_JSON_BUFFER_SIZE, METRICS_ALL_SECTIONS))
+	{
+		send(metricsJsonBuffer);
+		return;
+	}
+
+	metricsSplitPublishes++;
+
+	for (int section = 1; section <= METRICS_ALL_SECTIONS; section = section << 1)
+	{
+		if (createMetricsJson(metricsJsonBuffer, METRICS_JSON_BUFFER_SIZE, section))
+		{
+			send(metricsJsonBuffer);
+		}
+		else
+		{
+			metricsOverflows++;
+			displayMessage(F("Metrics section %d too long for a %d byte message\n"), section, METRICS_JSON_BUFFER_SIZE);
+		}
+	}
+}
+
+void showMetricsJson(char *json)
+{
+	// the json is longer than the formatted message buffer
+	displayMessageWithNewline(String(json));
+}
+
+void publishMetricsJson(char *json)
+{
+	publishBufferToMQTTTopic(json, metricsSettings.metricsTopic);
+}
+
+void dumpMetrics()
+{
+	sendMetrics(showMetricsJson);
+}
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+
+long readFreeHeapGauge()
+{
+	return (long)ESP.getFreeHeap();
+}
+
+#endif
+
+void initMetrics()
+{
+	metricsProcess.status = METRICS_STOPPED;
+
+	addCounterMetric("metricssplits", &metricsSplitPublishes);
+	addCounterMetric("metricsoverflows", &metricsOverflows);
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(ARDUINO_ARCH_ESP32)
+	addGaugeMetric("heap", readFreeHeapGauge);
+#endif
+}
+
+void startMetrics()
+{
+	millisAtLastMetricsPublish = millis();
+
+	if (metricsSettings.metricsPublishSecs <= 0)
+	{
+		metricsProcess.status = METRICS_PUBLISH_OFF;
+		return;
+	}
+
+	metricsProcess.status = METRICS_OK;
+}
+
+void updateMetrics()
+{
+	if (metricsProcess.status != METRICS_OK)
+	{
+		return;
+	}
+
+	unsigned long currentMillis = millis();
+
+	if (ulongDiff(currentMillis, millisAtLastMetricsPublish) < (unsigned long)metricsSettings.metricsPublishSecs * 1000)
+	{
+		return;
+	}
+
+	millisAtLastMetricsPublish = currentMillis;
+
+	sendMetrics(publishMetricsJson);
+}
+
+void stopMetrics()
+{
+	metricsProcess.status = METRICS_STOPPED;
+}
+
+bool metricsStatusOK()
+{
+	return metricsProcess.status == METRICS_OK;
+}
+
+void metricsStatusMessage(char *buffer, int bufferLength)
+{
+	switch (metricsProcess.status)
+	{
+	case METRICS_OK:
+		snprintf(buffer, bufferLength, "Metrics publishing %d metrics every %d secs to %s split:%lu overflows:%lu",
+				 noOfMetrics, metricsSettings.metricsPublishSecs, metricsSettings.metricsTopic,
+				 metricsSplitPublishes, metricsOverflows);
+		break;
+	case METRICS_PUBLISH_OFF:
+		snprintf(buffer, bufferLength, "Metrics publishing off (%d metrics)", noOfMetrics);
+		break;
+	case METRICS_STOPPED:
+		snprintf(buffer, bufferLength, "Metrics stopped");
+		break;
+	default:
+		snprintf(buffer, bufferLength, "Metrics status invalid");
+		break;
+	}
+}
+
+struct process metricsProcess = {
+	"metrics",
+	initMetrics,
+	startMetrics,
+	updateMetrics,
+	stopMetrics,
+	metricsStatusOK,
+	metricsStatusMessage,
+	false,
+	0,
+	0,
+	0,
+	NULL,
+	(unsigned char *)&metricsSettings, sizeof(MetricsSettings), &metricsSettingItems,
+	NULL,
+	BOOT_PROCESS + ACTIVE_PROCESS,
+	NULL,
+	NULL,
+	NULL,
+	NULL, // no command options
+	0	  // no command options
+};
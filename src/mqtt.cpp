@@ -5,6 +5,9 @@
 #include "HullOS.h"
 #include "console.h"
 #include "boot.h"
+#include "metrics.h"
+#include "idle.h"
+#include "sensors.h"
 
 #include <PubSubClient.h>
 
@@ -26,13 +29,23 @@ void setDefaultMQTTport(void *dest)
 	*destInt = 1883; // use 8883 for secure MQTT connection
 }
 
+// set when a setting that goes into a topic changes - see buildMQTTTopics
+bool mqttTopicsStale = true;
+
 boolean validateMQTTtopic(void *dest, const char *newValueStr)
 {
 	return (validateString((char *)dest, newValueStr, MQTT_TOPIC_LENGTH));
 }
 
+boolean validateMQTTtopicSetting(void *dest, const char *newValueStr)
+{
+	mqttTopicsStale = true;
+	return (validateString((char *)dest, newValueStr, MQTT_TOPIC_LENGTH));
+}
+
 boolean validateMQTTtopicPrefix(void *dest, const char *newValueStr)
 {
+	mqttTopicsStale = true;
 	return (validateString((char *)dest, newValueStr, MQTT_TOPIC_PREFIX_LENGTH));
 }
 
@@ -82,6 +95,12 @@ void setDefaultMQTTsecsPerUpdate(void *dest)
 	*destInt = 360;
 }
 
+void setDefaultMQTTKeyframeSends(void *dest)
+{
+	int *destInt = (int *)dest;
+	*destInt = 10;
+}
+
 void setDefaultMQTTsecsPerRetry(void *dest)
 {
 	int *destInt = (int *)dest;
@@ -92,7 +111,8 @@ void setDefaultMQTTDeviceName(void *dest)
 {
 	char *destStr = (char *)dest;
 
-	char id_buffer[DEVICE_NAME_LENGTH];
+	// leaves room for the CLB- in front
+	char id_buffer[DEVICE_NAME_LENGTH-4];
 
 	getProcID(id_buffer,DEVICE_NAME_LENGTH-4);
 
@@ -101,6 +121,7 @@ void setDefaultMQTTDeviceName(void *dest)
 
 boolean validateMQTTDeviceName(void *dest, const char *newValueStr)
 {
+	mqttTopicsStale = true;
 	return (validateString((char *)dest, newValueStr, DEVICE_NAME_LENGTH));
 }
 
@@ -129,14 +150,26 @@ struct SettingItem mqttTopicPrefixSetting = {
 	"MQTT Topic prefix", "mqttpre", mqttSettings.mqttTopicPrefix, MQTT_TOPIC_PREFIX_LENGTH, text, setDefaultMQTTTopicPrefix, validateMQTTtopicPrefix};
 
 struct SettingItem mqttPublishTopicSetting = {
-	"MQTT Publish topic", "mqttpub", mqttSettings.mqttPublishTopic, MQTT_TOPIC_LENGTH, text, setDefaultMQTTpublishTopic, validateMQTTtopic};
+	"MQTT Publish topic", "mqttpub", mqttSettings.mqttPublishTopic, MQTT_TOPIC_LENGTH, text, setDefaultMQTTpublishTopic, validateMQTTtopicSetting};
 
 struct SettingItem mqttSubscribeTopicSetting = {
-	"MQTT Subscribe topic", "mqttsub", mqttSettings.mqttSubscribeTopic, MQTT_TOPIC_LENGTH, text, setDefaultMQTTsubscribeTopic, validateMQTTtopic};
+	"MQTT Subscribe topic", "mqttsub", mqttSettings.mqttSubscribeTopic, MQTT_TOPIC_LENGTH, text, setDefaultMQTTsubscribeTopic, validateMQTTtopicSetting};
 
 struct SettingItem mqttReportTopicSetting = {
 	"MQTT Reporting topic", "mqttreport", mqttSettings.mqttReportTopic, MQTT_TOPIC_LENGTH, text, setDefaultMQTTreportTopic, validateMQTTtopic};
 
+struct SettingItem mqttTelemetrySetting = {
+	"MQTT Send sensor readings (yes or no)", "mqtttelemetry", &mqttSettings.mqttTelemetry, ONOFF_INPUT_LENGTH, yesNo, setFalse, validateYesNo};
+
+struct SettingItem mqttTelemetryBinarySetting = {
+	"MQTT Send sensor readings as CBOR (yes or no)", "mqttbinary", &mqttSettings.mqttTelemetryBinary, ONOFF_INPUT_LENGTH, yesNo, setFalse, validateYesNo};
+
+struct SettingItem mqttTelemetryDeltaSetting = {
+	"MQTT Send only changed sensor readings (yes or no)", "mqttdelta", &mqttSettings.mqttTelemetryDelta, ONOFF_INPUT_LENGTH, yesNo, setFalse, validateYesNo};
+
+struct SettingItem mqttKeyframeSendsSetting = {
+	"MQTT Sends between full sets of readings", "mqttkeyframe", &mqttSettings.mqttKeyframeSends, NUMBER_INPUT_LENGTH, integerValue, setDefaultMQTTKeyframeSends, validateInt};
+
 struct SettingItem mqttSecsPerUpdateSetting = {
 	"MQTT Seconds per update", "mqttsecsperupdate", &mqttSettings.mqttSecsPerUpdate, NUMBER_INPUT_LENGTH, integerValue, setDefaultMQTTsecsPerUpdate, validateInt};
 
@@ -157,6 +190,10 @@ struct SettingItem *mqttSettingItemPointers[] =
 		&mqttSubscribeTopicSetting,
 		&mqttReportTopicSetting,
 		&mqttSecsPerUpdateSetting,
+		&mqttTelemetrySetting,
+		&mqttTelemetryBinarySetting,
+		&mqttTelemetryDeltaSetting,
+		&mqttKeyframeSendsSetting,
 		&seconds_per_mqtt_retrySetting};
 
 struct SettingItemCollection mqttSettingItems = {
@@ -169,21 +206,132 @@ unsigned long mqtt_timer_start;
 
 PubSubClient *mqttPubSubClient = NULL;
 
-#define MQTT_RECEIVE_BUFFER_SIZE 1000
-#define NO_OF_MQTT_RECEIVE_BUFFERS 1
+// Incoming messages are held in a ring of buffers so that a burst of
+// messages received in one call of loop is not lost. The callback adds
+// at the head and the process update removes from the tail.
 
 char mqtt_receive_buffers[NO_OF_MQTT_RECEIVE_BUFFERS][MQTT_RECEIVE_BUFFER_SIZE];
+char mqtt_receive_topics[NO_OF_MQTT_RECEIVE_BUFFERS][MQTT_RECEIVE_TOPIC_SIZE];
+unsigned int mqtt_receive_lengths[NO_OF_MQTT_RECEIVE_BUFFERS];
+
+volatile int mqttReceiveHead = 0;
+volatile int mqttReceiveTail = 0;
+volatile int mqttReceiveCount = 0;
 
-char * mqtt_receive_buffer = mqtt_receive_buffers[0];
+unsigned long mqttReceiveOverflows = 0;
+unsigned long mqttReceiveTruncations = 0;
+unsigned long mqttReceiveHighWater = 0;
+
+// outgoing message queue - see queueMQTTMessage
+
+#define MQTT_SEND_HEADER_SIZE 5
+
+char mqttSendQueue[MQTT_SEND_QUEUE_SIZE];
+
+int mqttSendHead = 0;
+int mqttSendTail = 0;
+int mqttSendWrapPos = -1;
+int mqttSendCount = 0;
+
+unsigned long mqttSendDropped = 0;
+unsigned long mqttSendFailed = 0;
+unsigned long mqttJournalled = 0;
+unsigned long mqttJournalTooLong = 0;
+
+unsigned long mqttJournalBytes = 0;
+unsigned long mqttJournalReadPos = 0;
+int mqttJournalRetries = 0;
+
+char mqttJournalRecord[MQTT_JOURNAL_RECORD_SIZE];
+
+// Topics built from the settings by buildMQTTTopics so that a publish
+// only has to copy them into the send queue
+
+char mqttTopicHead[MQTT_TOPIC_PREFIX_LENGTH + 1];
+char mqttDataTopic[MQTT_FULL_TOPIC_LENGTH];
+char mqttRemoteCommandTopicHead[MQTT_TOPIC_HEAD_LENGTH];
+char mqttSubscribeFullTopic[MQTT_FULL_TOPIC_LENGTH];
+
+// The buffers hold the longest settings, so a topic that doesn't fit
+// means that a setting is longer than its validation allows
+
+bool checkMQTTTopicLength(int length, int bufferLength, const char *topicName)
+{
+	if (length >= 0 && length < bufferLength)
+	{
+		return true;
+	}
+
+	LOG_ERROR(LOG_MODULE_MQTT, "MQTT %s topic cut off at %d characters\n", topicName, bufferLength - 1);
+	return false;
+}
+
+void buildMQTTTopics()
+{
+	int length;
+
+	if (mqttSettings.mqttTopicPrefix[0] == 0)
+	{
+		// no prefix - topics start with the topic itself
+		mqttTopicHead[0] = 0;
+	}
+	else
+	{
+		// the prefix is separated from the topic by a /
+		length = snprintf(mqttTopicHead, sizeof(mqttTopicHead), "%s/", mqttSettings.mqttTopicPrefix);
+		checkMQTTTopicLength(length, sizeof(mqttTopicHead), "prefix");
+	}
+
+	length = snprintf(mqttDataTopic, sizeof(mqttDataTopic), "%s%s/%s",
+					  mqttTopicHead, mqttSettings.mqttPublishTopic, mqttSettings.mqttDeviceName);
+	checkMQTTTopicLength(length, sizeof(mqttDataTopic), "data");
+
+	length = snprintf(mqttRemoteCommandTopicHead, sizeof(mqttRemoteCommandTopicHead), "%s%s/",
+					  mqttTopicHead, mqttSettings.mqttSubscribeTopic);
+	checkMQTTTopicLength(length, sizeof(mqttRemoteCommandTopicHead), "remote command");
+
+	length = snprintf(mqttSubscribeFullTopic, sizeof(mqttSubscribeFullTopic), "%s%s",
+					  mqttRemoteCommandTopicHead, mqttSettings.mqttDeviceName);
+	checkMQTTTopicLength(length, sizeof(mqttSubscribeFullTopic), "subscribe");
+
+	mqttTopicsStale = false;
+}
+
+void checkMQTTTopics()
+{
+	if (mqttTopicsStale)
+	{
+		buildMQTTTopics();
+	}
+}
 
 #define MQTT_SEND_BUFFER_SIZE 240
 
 char mqtt_send_buffer[MQTT_SEND_BUFFER_SIZE];
 
+char mqttTelemetryBuffer[MQTT_TELEMETRY_BUFFER_SIZE];
+unsigned long millisAtLastTelemetry;
+int telemetrySendsSinceKeyframe;
+unsigned long telemetryKeyframesSent = 0;
+unsigned long telemetryDeltasSent = 0;
+unsigned long telemetryDeltasSkipped = 0;
+
+unsigned long mqttConnectFailures = 0;
+unsigned long mqttWiFiRescans = 0;
+
+// time from the start of the WiFi connection to MQTT being connected
+unsigned long mqttConnectMillis = 0;
+unsigned long mqttTimedWiFiConnectStart = 0;
+
+long readMQTTConnectMillisGauge()
+{
+	return (long)mqttConnectMillis;
+}
+
 boolean first_mqtt_message = true;
 
-int messagesSent;
-int messagesReceived;
+unsigned long messagesSent;
+unsigned long messagesReceived;
 
 void mqtt_deliver_command_result(char *result)
 {
@@ -195,43 +343,259 @@ void mqtt_deliver_command_result(char *result)
 
 void callback(char *topic, byte *payload, unsigned int length)
 {
-	unsigned int i;
+	messagesReceived++;
+
+	if (mqttReceiveCount == NO_OF_MQTT_RECEIVE_BUFFERS)
+	{
+		// no room - drop the new message
+		mqttReceiveOverflows++;
+		return;
+	}
 
-	for (i = 0; i < length; i++)
+	if (length > MQTT_RECEIVE_BUFFER_SIZE - 1)
 	{
-		mqtt_receive_buffer[i] = (char)payload[i];
+		mqttReceiveTruncations++;
+		length = MQTT_RECEIVE_BUFFER_SIZE - 1;
 	}
 
+	char *receiveBuffer = mqtt_receive_buffers[mqttReceiveHead];
+
+	memcpy(receiveBuffer, payload, length);
+
 	// Put the terminator on the string
-	mqtt_receive_buffer[i] = 0;
+	receiveBuffer[length] = 0;
 
-	messagesReceived++;
+	mqtt_receive_lengths[mqttReceiveHead] = length;
+
+	strncpy(mqtt_receive_topics[mqttReceiveHead], topic, MQTT_RECEIVE_TOPIC_SIZE - 1);
+	mqtt_receive_topics[mqttReceiveHead][MQTT_RECEIVE_TOPIC_SIZE - 1] = 0;
+
+	mqttReceiveHead = (mqttReceiveHead + 1) % NO_OF_MQTT_RECEIVE_BUFFERS;
+	mqttReceiveCount++;
+
+	if ((unsigned long)mqttReceiveCount > mqttReceiveHighWater)
+	{
+		mqttReceiveHighWater = mqttReceiveCount;
+	}
 }
 
-void clearIncomingMQTTMessage()
+void clearIncomingMQTTMessages()
 {
-	mqtt_receive_buffer[0] = 0;
+	mqttReceiveHead = 0;
+	mqttReceiveTail = 0;
+	mqttReceiveCount = 0;
 }
 
 bool receivedIncomingMQTTMessage()
 {
-	return mqtt_receive_buffer[0] != 0;
+	return mqttReceiveCount > 0;
 }
 
-void handleIncomingMQTTMessage()
+void openMQTTJournal();
+bool mqttRetryPending();
+unsigned long millisToMQTTRetry(unsigned long currentMillis);
+
+// keeps the loop running while there are messages waiting
+
+unsigned long millisToNextMQTTMessage(unsigned long currentMillis)
 {
 	if (receivedIncomingMQTTMessage())
 	{
-		displayMessage(F("Received from MQTT: %s\n"), mqtt_receive_buffer);
+		return 0;
+	}
 
-		if((mqtt_receive_buffer[0]=='*') && (mqtt_receive_buffer[1]=='*')){
-			sendMessageToConsole(mqtt_receive_buffer+2);
+	if (MQTTProcessDescriptor.status == MQTT_OK && (mqttSendCount > 0 || mqttJournalBytes > 0))
+	{
+		return 0;
+	}
+
+	if (MQTTProcessDescriptor.status == MQTT_STARTING || MQTTProcessDescriptor.status == MQTT_CONNECTING)
+	{
+		return 0;
+	}
+
+	unsigned long result = IDLE_NO_DEADLINE;
+
+	if (mqttRetryPending())
+	{
+		result = millisToMQTTRetry(currentMillis);
+	}
+
+	if (mqttSettings.mqtt_enabled && mqttSettings.mqttTelemetry && mqttSettings.mqttSecsPerUpdate > 0)
+	{
+		unsigned long telemetryMillis = (unsigned long)mqttSettings.mqttSecsPerUpdate * 1000;
+		unsigned long sinceTelemetry = ulongDiff(currentMillis, millisAtLastTelemetry);
+
+		if (sinceTelemetry >= telemetryMillis)
+		{
+			return 0;
+		}
+
+		if (telemetryMillis - sinceTelemetry < result)
+		{
+			result = telemetryMillis - sinceTelemetry;
+		}
+	}
+
+	return result;
+}
+
+void handleIncomingMQTTMessages(int maxMessages, void (*deliverResult)(char *resultText))
+{
+	for (int i = 0; i < maxMessages; i++)
+	{
+		if (!receivedIncomingMQTTMessage())
+		{
+			return;
+		}
+
+		char *receiveBuffer = mqtt_receive_buffers[mqttReceiveTail];
+
+		LOG_DEBUG(LOG_MODULE_MQTT, "Received from MQTT topic %s: %s\n", mqtt_receive_topics[mqttReceiveTail], receiveBuffer);
+
+		if((receiveBuffer[0]=='*') && (receiveBuffer[1]=='*')){
+			sendMessageToConsole(receiveBuffer+2);
 		}
 		else {
-			act_onJson_message(mqtt_receive_buffer, mqtt_deliver_command_result);
+			act_onJson_message(receiveBuffer, deliverResult);
+		}
+
+		mqttReceiveTail = (mqttReceiveTail + 1) % NO_OF_MQTT_RECEIVE_BUFFERS;
+		mqttReceiveCount--;
+	}
+}
+
+void handleIncomingMQTTMessage()
+{
+	// a limited number of messages are handled in each update so that
+	// a burst of commands does not hold up the rest of the device
+
+	handleIncomingMQTTMessages(MQTT_RECEIVE_MESSAGES_PER_UPDATE, mqtt_deliver_command_result);
+}
+
+// The load test pushes a stream of commands through the receive callback
+// in bursts and handles them as the MQTT update would, so it measures the
+// queue and the command decoding without a broker. The default stream
+// reads settings and sends commands that fail, so it doesn't change
+// anything on the device. Results are counted rather than published.
+
+const char *mqttLoadTestCommands[] = {
+	"{\"setting\":\"mqttpub\"}",
+	"{\"setting\":\"mqttdevicename\"}",
+	"{\"process\":\"loadtest\",\"command\":\"none\"}",
+	"{\"setting\":"};
+
+#define NO_OF_MQTT_LOAD_TEST_COMMANDS (sizeof(mqttLoadTestCommands) / sizeof(const char *))
+
+unsigned long mqttLoadTestResults;
+
+void countMQTTLoadTestResult(char * /* resultText */)
+{
+	mqttLoadTestResults++;
+}
+
+int compareMQTTLoadTestLatencies(const void *a, const void *b)
+{
+	unsigned long la = *(const unsigned long *)a;
+	unsigned long lb = *(const unsigned long *)b;
+	return (la > lb) - (la < lb);
+}
+
+void runMQTTLoadTest(int noOfMessages, int burstSize, const char *command)
+{
+	if (mqttReceiveCount > 0)
+	{
+		displayMessage(F("MQTT messages waiting - try the load test again\n"));
+		return;
+	}
+
+	if (noOfMessages < 1 || noOfMessages > MQTT_LOAD_TEST_MAX_MESSAGES)
+	{
+		noOfMessages = MQTT_LOAD_TEST_MAX_MESSAGES;
+	}
+
+	if (burstSize < 1)
+	{
+		burstSize = 1;
+	}
+
+	unsigned long *latencies = (unsigned long *)malloc(noOfMessages * sizeof(unsigned long));
+
+	if (latencies == NULL)
+	{
+		displayMessage(F("No memory for the load test\n"));
+		return;
+	}
+
+	// time each message was put into each receive buffer
+	unsigned long injectMicros[NO_OF_MQTT_RECEIVE_BUFFERS];
+
+	unsigned long messagesReceivedAtStart = messagesReceived;
+	unsigned long overflowsAtStart = mqttReceiveOverflows;
+	unsigned long truncationsAtStart = mqttReceiveTruncations;
+
+	mqttLoadTestResults = 0;
+
+	int sent = 0;
+	int handled = 0;
+
+	unsigned long startMicros = micros();
+
+	while (sent < noOfMessages || mqttReceiveCount > 0)
+	{
+		for (int i = 0; i < burstSize && sent < noOfMessages; i++)
+		{
+			const char *message = command;
+
+			if (message == NULL)
+			{
+				message = mqttLoadTestCommands[sent % NO_OF_MQTT_LOAD_TEST_COMMANDS];
+			}
+
+			int slot = mqttReceiveHead;
+			int countBefore = mqttReceiveCount;
+			unsigned long messageMicros = micros();
+
+			callback((char *)"loadtest", (byte *)message, strlen(message));
+
+			if (mqttReceiveCount > countBefore)
+			{
+				injectMicros[slot] = messageMicros;
+			}
+			sent++;
+		}
+
+		// one update's worth of handling
+
+		for (int i = 0; i < MQTT_RECEIVE_MESSAGES_PER_UPDATE && mqttReceiveCount > 0; i++)
+		{
+			int slot = mqttReceiveTail;
+			handleIncomingMQTTMessages(1, countMQTTLoadTestResult);
+			latencies[handled++] = ulongDiff(micros(), injectMicros[slot]);
 		}
-		clearIncomingMQTTMessage();
 	}
+
+	unsigned long elapsedMicros = ulongDiff(micros(), startMicros);
+
+	// the test messages don't count as received traffic
+	messagesReceived = messagesReceivedAtStart;
+
+	displayMessage(F("MQTT load test sent:%d handled:%d dropped:%lu truncated:%lu results:%lu\n"),
+				   sent, handled, mqttReceiveOverflows - overflowsAtStart,
+				   mqttReceiveTruncations - truncationsAtStart, mqttLoadTestResults);
+
+	if (handled > 0 && elapsedMicros > 0)
+	{
+		qsort(latencies, handled, sizeof(unsigned long), compareMQTTLoadTestLatencies);
+
+		displayMessage(F("   %lu messages per second over %lu millis\n"),
+					   (unsigned long)(handled * 1000000ULL / elapsedMicros), elapsedMicros / 1000);
+		displayMessage(F("   latency (microsecs) 50%%:%lu 90%%:%lu 99%%:%lu max:%lu\n"),
+					   latencies[(handled - 1) * 50 / 100], latencies[(handled - 1) * 90 / 100],
+					   latencies[(handled - 1) * 99 / 100], latencies[handled - 1]);
+	}
+
+	free(latencies);
 }
 
 int mqttConnectErrorNumber;
@@ -239,17 +603,41 @@ bool mqttStartCommandsPerformed ;
 
 int mqttConnectFailedCount;
 
+// connect failures in a row that didn't reach the broker at all
+int mqttUnreachableCount;
+
 void initMQTT()
 {
 	MQTTProcessDescriptor.status = MQTT_OFF;
 	mqttStartCommandsPerformed = false;
 	mqttConnectFailedCount = 0;
+	mqttUnreachableCount = 0;
+	addCounterMetric("mqttsent", &messagesSent);
+	addCounterMetric("mqttreceived", &messagesReceived);
+	addCounterMetric("mqttreceiveoverflows", &mqttReceiveOverflows);
+	addCounterMetric("mqttreceivehighwater", &mqttReceiveHighWater);
+	addCounterMetric("mqttsenddropped", &mqttSendDropped);
+	addCounterMetric("mqttsendfailed", &mqttSendFailed);
+	addCounterMetric("mqttjournalled", &mqttJournalled);
+	addCounterMetric("mqttjournaltoolong", &mqttJournalTooLong);
+	addCounterMetric("mqttconnectfailures", &mqttConnectFailures);
+	addCounterMetric("mqttwifirescans", &mqttWiFiRescans);
+	addGaugeMetric("mqttconnectmillis", readMQTTConnectMillisGauge);
+	addCounterMetric("telemetrykeyframes", &telemetryKeyframesSent);
+	addCounterMetric("telemetrydeltas", &telemetryDeltasSent);
+	addCounterMetric("telemetryskipped", &telemetryDeltasSkipped);
+	bindIdleDeadline(millisToNextMQTTMessage);
 }
 
 void startMQTT()
 {
 	if (mqttSettings.mqtt_enabled)
 	{
+		openMQTTJournal();
+		buildMQTTTopics();
+		millisAtLastTelemetry = millis();
+		// start with a keyframe
+		telemetrySendsSinceKeyframe = mqttSettings.mqttKeyframeSends;
 		MQTTProcessDescriptor.status = MQTT_STARTING;
 	}
 	else
@@ -260,12 +648,112 @@ void startMQTT()
 
 
 
+// The connection is made in steps across updates so that an unreachable
+// broker doesn't hold up the loop. restartMQTT opens the network
+// connection and connectMQTTSession sends the MQTT connect on the next
+// update. A failed attempt is retried after a delay that starts at
+// mqttsecsperretry and doubles with each failure.
+
+Client *mqttNetworkClient = NULL;
+
+unsigned long millisAtMQTTConnectFailure;
+
+unsigned long mqttRetryDelayMillis()
+{
+	unsigned long delayMillis = 1000;
+
+	if (mqttSettings.seconds_per_mqtt_retry > 0)
+	{
+		delayMillis = (unsigned long)mqttSettings.seconds_per_mqtt_retry * 1000;
+	}
+
+	for (int i = 1; i < mqttConnectFailedCount && delayMillis < MQTT_CONNECT_RETRY_MAX_MILLIS; i++)
+	{
+		delayMillis = delayMillis * 2;
+	}
+
+	if (delayMillis > MQTT_CONNECT_RETRY_MAX_MILLIS)
+	{
+		delayMillis = MQTT_CONNECT_RETRY_MAX_MILLIS;
+	}
+
+	return delayMillis;
+}
+
+bool mqttRetryPending()
+{
+	switch (MQTTProcessDescriptor.status)
+	{
+	case MQTT_ERROR_BAD_PROTOCOL:
+	case MQTT_ERROR_BAD_CLIENT_ID:
+	case MQTT_ERROR_CONNECT_UNAVAILABLE:
+	case MQTT_ERROR_BAD_CREDENTIALS:
+	case MQTT_ERROR_CONNECT_UNAUTHORIZED:
+	case MQTT_ERROR_CONNECT_FAILED:
+	case MQTT_ERROR_CONNECT_ERROR:
+	case MQTT_ERROR_CONNECT_MESSAGE_FAILED:
+	case MQTT_ERROR_LOOP_FAILED:
+	case MQTT_ERROR_CONNECTION_TIMEOUT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+unsigned long millisToMQTTRetry(unsigned long currentMillis)
+{
+	unsigned long waitedMillis = ulongDiff(currentMillis, millisAtMQTTConnectFailure);
+	unsigned long delayMillis = mqttRetryDelayMillis();
+
+	if (waitedMillis >= delayMillis)
+	{
+		return 0;
+	}
+	return delayMillis - waitedMillis;
+}
+
+void scheduleMQTTRetry(int errorStatus)
+{
+	MQTTProcessDescriptor.status = errorStatus;
+	millisAtMQTTConnectFailure = millis();
+	mqttConnectFailedCount++;
+	mqttConnectFailures++;
+
+	if (mqttNetworkClient != NULL)
+	{
+		mqttNetworkClient->stop();
+	}
+
+	if (errorStatus != MQTT_ERROR_CONNECT_FAILED)
+	{
+		mqttUnreachableCount = 0;
+	}
+	else
+	{
+		mqttUnreachableCount++;
+
+		// the access point may have lost its route to the broker, so
+		// look for a better one. MQTT starts again when WiFi is back.
+		if (mqttUnreachableCount >= MQTT_UNREACHABLE_BEFORE_WIFI_RESCAN)
+		{
+			LOG_WARNING(LOG_MODULE_MQTT, "MQTT server unreachable %d times - rescanning WiFi\n", mqttUnreachableCount);
+			mqttUnreachableCount = 0;
+			mqttWiFiRescans++;
+			beginWiFiScanning();
+			MQTTProcessDescriptor.status = MQTT_ERROR_NO_WIFI;
+			return;
+		}
+	}
+
+	LOG_INFO(LOG_MODULE_MQTT, "MQTT retry in %lu secs\n", mqttRetryDelayMillis() / 1000);
+}
+
 void restartMQTT()
 {
-	displayMessage("Restarting MQTT\n");
+	LOG_INFO(LOG_MODULE_MQTT, "Restarting MQTT\n");
 	messagesReceived = 0;
 	messagesSent = 0;
-	clearIncomingMQTTMessage();
+	clearIncomingMQTTMessages();
 
 	if (mqttSettings.mqttServer[0]==0)
 	{
@@ -287,85 +775,119 @@ void restartMQTT()
 #if defined(ARDUINO_ARCH_ESP8266)
 			secureClient->setInsecure();
 #endif
-			mqttPubSubClient = new PubSubClient(*secureClient);
+			mqttNetworkClient = secureClient;
 		}
 		else
 		{
-			WiFiClient *espClient = new WiFiClient();
-			mqttPubSubClient = new PubSubClient(*espClient);
+			mqttNetworkClient = new WiFiClient();
 		}
 
+		// bounds the time spent in the network connect
+		mqttNetworkClient->setTimeout(MQTT_NETWORK_CONNECT_TIMEOUT_MILLIS);
+
+		mqttPubSubClient = new PubSubClient(*mqttNetworkClient);
+
 		mqttPubSubClient->setBufferSize(MQTT_BUFFER_SIZE_MAX);
 
 		mqttPubSubClient->setServer(mqttSettings.mqttServer, mqttSettings.mqttPort);
 		mqttPubSubClient->setCallback(callback);
-		mqttPubSubClient->setSocketTimeout(15);
+		mqttPubSubClient->setSocketTimeout(MQTT_SESSION_CONNECT_TIMEOUT_SECS);
+	}
+
+	LOG_DEBUG(LOG_MODULE_MQTT, "Connecting to %s\n", mqttSettings.mqttServer);
+
+	// PubSubClient uses the network connection if it is already open
+
+	if (!mqttNetworkClient->connect(mqttSettings.mqttServer, mqttSettings.mqttPort))
+	{
+		LOG_WARNING(LOG_MODULE_MQTT, "MQTT server %s not reachable\n", mqttSettings.mqttServer);
+		hardwareDisplayMessage(MQTT_STATUS_BAD_STATE_MESSAGE_NUMBER, ledFlashAlertState, MQTT_STATUS_BAD_STATE_MESSAGE_TEXT);
+		scheduleMQTTRetry(MQTT_ERROR_CONNECT_FAILED);
+		return;
+	}
+
+	MQTTProcessDescriptor.status = MQTT_CONNECTING;
+}
+
+void connectMQTTSession()
+{
+	if (!mqttNetworkClient->connected())
+	{
+		LOG_WARNING(LOG_MODULE_MQTT, "MQTT server closed the connection\n");
+		scheduleMQTTRetry(MQTT_ERROR_CONNECT_FAILED);
+		return;
 	}
 
-	displayMessage("Doing the connect\n");
+	LOG_DEBUG(LOG_MODULE_MQTT, "Doing the connect\n");
 
 	if (!mqttPubSubClient->connect(mqttSettings.mqttDeviceName, mqttSettings.mqttUser, mqttSettings.mqttPassword))
 	{
 		
 		int state =  mqttPubSubClient->state();
 
-		displayMessage(F("Bad MQTT client state %d "),state);
+		LOG_WARNING(LOG_MODULE_MQTT, "Bad MQTT client state %d ", state);
 
 		hardwareDisplayMessage(MQTT_STATUS_BAD_STATE_MESSAGE_NUMBER, ledFlashAlertState, MQTT_STATUS_BAD_STATE_MESSAGE_TEXT);
 
+		int errorStatus;
+
 		switch (state)
 		{
 		case MQTT_CONNECT_BAD_PROTOCOL:
-			displayMessage(F("bad protocol\n"));
-			MQTTProcessDescriptor.status = MQTT_ERROR_BAD_PROTOCOL;
+			LOG_WARNING(LOG_MODULE_MQTT, "bad protocol\n");
+			errorStatus = MQTT_ERROR_BAD_PROTOCOL;
 			break;
 		case MQTT_CONNECT_BAD_CLIENT_ID:
-			displayMessage(F("bad client ID\n"));
-			MQTTProcessDescriptor.status = MQTT_ERROR_BAD_CLIENT_ID;
+			LOG_WARNING(LOG_MODULE_MQTT, "bad client ID\n");
+			errorStatus = MQTT_ERROR_BAD_CLIENT_ID;
 			break;
 		case MQTT_CONNECT_UNAVAILABLE:
-			displayMessage(F("connect unavailable\n"));
-			MQTTProcessDescriptor.status = MQTT_ERROR_CONNECT_UNAVAILABLE;
+			LOG_WARNING(LOG_MODULE_MQTT, "connect unavailable\n");
+			errorStatus = MQTT_ERROR_CONNECT_UNAVAILABLE;
 			break;
 		case MQTT_CONNECT_BAD_CREDENTIALS:
-			displayMessage(F("bad credentials\n"));
-			MQTTProcessDescriptor.status = MQTT_ERROR_BAD_CREDENTIALS;
+			LOG_WARNING(LOG_MODULE_MQTT, "bad credentials\n");
+			errorStatus = MQTT_ERROR_BAD_CREDENTIALS;
 			break;
 		case MQTT_CONNECT_UNAUTHORIZED:
-			displayMessage(F("connect unauthorized\n"));
-			MQTTProcessDescriptor.status = MQTT_ERROR_CONNECT_UNAUTHORIZED;
+			LOG_WARNING(LOG_MODULE_MQTT, "connect unauthorized\n");
+			errorStatus = MQTT_ERROR_CONNECT_UNAUTHORIZED;
 			break;
 		case MQTT_CONNECTION_TIMEOUT:
-			displayMessage(F("connection timeout\n"));
-			MQTTProcessDescriptor.status = MQTT_ERROR_CONNECTION_TIMEOUT;
+			LOG_WARNING(LOG_MODULE_MQTT, "connection timeout\n");
+			errorStatus = MQTT_ERROR_CONNECTION_TIMEOUT;
 			break;
 		case MQTT_CONNECT_FAILED:
-			displayMessage(F("connect failed\n"));
-			MQTTProcessDescriptor.status = MQTT_ERROR_CONNECT_FAILED;
-			internalReboot(MQTT_CONNECT_FAILED_REBOOT);
-			delay(100);
-			beginWiFiScanning();
-			MQTTProcessDescriptor.status = MQTT_ERROR_NO_WIFI;
+			LOG_WARNING(LOG_MODULE_MQTT, "connect failed\n");
+			errorStatus = MQTT_ERROR_CONNECT_FAILED;
 			break;
 		default:
-			displayMessage(F("no error description\n"));
-			mqttConnectErrorNumber = mqttPubSubClient->state();
-			MQTTProcessDescriptor.status = MQTT_ERROR_CONNECT_ERROR;
+			LOG_WARNING(LOG_MODULE_MQTT, "no error description\n");
+			mqttConnectErrorNumber = state;
+			errorStatus = MQTT_ERROR_CONNECT_ERROR;
 			break;
 		}
+		scheduleMQTTRetry(errorStatus);
 		return;
 	}
 
-	char topicBuffer [MQTT_TOPIC_PREFIX_LENGTH+MQTT_TOPIC_LENGTH];
+	mqttConnectFailedCount = 0;
+	mqttUnreachableCount = 0;
 
-	snprintf(topicBuffer,MQTT_TOPIC_PREFIX_LENGTH+MQTT_TOPIC_LENGTH,"%s/%s/%s", 
-		mqttSettings.mqttTopicPrefix,
-		mqttSettings.mqttSubscribeTopic,
-		mqttSettings.mqttDeviceName);
+	// only timed for the first connection after WiFi connects
 
-	displayMessage(F("Subscribing to:%s\n"), topicBuffer);
+	if (getWiFiConnectStartMillis() != mqttTimedWiFiConnectStart)
+	{
+		mqttTimedWiFiConnectStart = getWiFiConnectStartMillis();
+		mqttConnectMillis = ulongDiff(millis(), mqttTimedWiFiConnectStart);
+		LOG_INFO(LOG_MODULE_MQTT, "MQTT connected %lu millis after WiFi start\n", mqttConnectMillis);
+	}
 
-	mqttPubSubClient->subscribe(topicBuffer);
+	buildMQTTTopics();
+
+	LOG_INFO(LOG_MODULE_MQTT, "Subscribing to:%s\n", mqttSubscribeFullTopic);
+
+	mqttPubSubClient->subscribe(mqttSubscribeFullTopic);
 
 	//snprintf(mqtt_send_buffer, MQTT_SEND_BUFFER_SIZE,
 	//	"{\"dev\":\"%s\", \"status\":\"starting\"}",
@@ -383,69 +905,490 @@ void restartMQTT()
 	MQTTProcessDescriptor.status = MQTT_OK;
 }
 
-int mqttRetries = 0;
+// Outbound messages are queued and published from the MQTT update so
+// that the code producing them does not wait for the network.
+//
+// Each queued message is stored as a header followed by the topic and
+// the payload, both zero terminated, so it can be published straight
+// from the queue. The payload length is held in the header because a
+// binary payload can contain zeros
+// A message is never split across the end of the
+// queue - if it doesn't fit at the end it goes at the start and the
+// position of the gap is recorded in mqttSendWrapPos.
+//
+// Messages that are kept while the connection is down are appended to a
+// journal file and replayed in order when the connection returns. While
+// the journal holds anything all new kept messages go to the journal too
+// so that they stay in order. The position of the next record to replay
+// is saved after each record so that a reboot part way through a replay
+// doesn't send the earlier records again.
+
+void writeMQTTSendHeader(char *dest, int topicLength, int payloadLength, int retries)
+{
+	dest[0] = topicLength & 0xff;
+	dest[1] = (topicLength >> 8) & 0xff;
+	dest[2] = payloadLength & 0xff;
+	dest[3] = (payloadLength >> 8) & 0xff;
+	dest[4] = retries;
+}
 
-int publishBufferToMQTTTopic(char *buffer, char *topic)
+int mqttSendRecordSize(char *header)
 {
+	int topicLength = (unsigned char)header[0] + ((unsigned char)header[1] << 8);
+	int payloadLength = (unsigned char)header[2] + ((unsigned char)header[3] << 8);
+	return MQTT_SEND_HEADER_SIZE + topicLength + 1 + payloadLength + 1;
+}
+
+// returns the position to write a record of this size or -1 if it won't fit
 
-	if (MQTTProcessDescriptor.status == MQTT_OK)
+int reserveMQTTSendSpace(int recordSize)
+{
+	if (mqttSendCount == 0)
 	{
-		messagesSent++;
+		mqttSendHead = 0;
+		mqttSendTail = 0;
+		mqttSendWrapPos = -1;
+		return recordSize <= MQTT_SEND_QUEUE_SIZE ? 0 : -1;
+	}
 
-		char topicBuffer [MQTT_TOPIC_PREFIX_LENGTH+MQTT_TOPIC_LENGTH];
+	if (mqttSendHead > mqttSendTail)
+	{
+		if (mqttSendHead + recordSize <= MQTT_SEND_QUEUE_SIZE)
+		{
+			return mqttSendHead;
+		}
 
-		if( mqttSettings.mqttTopicPrefix[0]==0)
+		if (recordSize <= mqttSendTail)
 		{
-			// no prefix - just send the topic
-			snprintf(topicBuffer,MQTT_TOPIC_PREFIX_LENGTH+MQTT_TOPIC_LENGTH,"%s", topic);
+			mqttSendWrapPos = mqttSendHead;
+			return 0;
 		}
-		else {
-			// send the prefix separated from the topic by a /
-			snprintf(topicBuffer,MQTT_TOPIC_PREFIX_LENGTH+MQTT_TOPIC_LENGTH,"%s/%s", mqttSettings.mqttTopicPrefix,topic);
+
+		return -1;
+	}
+
+	if (mqttSendHead < mqttSendTail && mqttSendHead + recordSize <= mqttSendTail)
+	{
+		return mqttSendHead;
+	}
+
+	// head has caught up with the tail - the queue is full
+	return -1;
+}
+
+// The topic is stored as a head and a tail so that the prebuilt topic
+// strings can be copied straight into the record.
+
+bool addToMQTTSendQueue(const char *buffer, int payloadLength, const char *topicHead, const char *topicTail)
+{
+	int topicHeadLength = strlen(topicHead);
+	int topicLength = topicHeadLength + strlen(topicTail);
+	int recordSize = MQTT_SEND_HEADER_SIZE + topicLength + 1 + payloadLength + 1;
+
+	int pos = reserveMQTTSendSpace(recordSize);
+
+	if (pos < 0)
+	{
+		return false;
+	}
+
+	char *record = mqttSendQueue + pos;
+
+	writeMQTTSendHeader(record, topicLength, payloadLength, 0);
+	memcpy(record + MQTT_SEND_HEADER_SIZE, topicHead, topicHeadLength);
+	memcpy(record + MQTT_SEND_HEADER_SIZE + topicHeadLength, topicTail, topicLength - topicHeadLength + 1);
+	memcpy(record + MQTT_SEND_HEADER_SIZE + topicLength + 1, buffer, payloadLength);
+	record[MQTT_SEND_HEADER_SIZE + topicLength + 1 + payloadLength] = 0;
+
+	mqttSendHead = pos + recordSize;
+	mqttSendCount++;
+	return true;
+}
+
+void removeMQTTSendQueueHead()
+{
+	mqttSendTail += mqttSendRecordSize(mqttSendQueue + mqttSendTail);
+	mqttSendCount--;
+
+	if (mqttSendTail == mqttSendWrapPos)
+	{
+		mqttSendTail = 0;
+		mqttSendWrapPos = -1;
+	}
+}
+
+bool addToMQTTJournal(const char *buffer, int payloadLength, const char *topicHead, const char *topicTail)
+{
+	int topicHeadLength = strlen(topicHead);
+	int topicLength = topicHeadLength + strlen(topicTail);
+	int recordSize = MQTT_SEND_HEADER_SIZE + topicLength + 1 + payloadLength + 1;
+
+	if (recordSize > MQTT_JOURNAL_RECORD_SIZE)
+	{
+		mqttJournalTooLong++;
+		LOG_WARNING(LOG_MODULE_MQTT, "MQTT message of %d bytes to topic:%s%s too long to journal\n", recordSize, topicHead, topicTail);
+		return false;
+	}
+
+	if (mqttJournalBytes + recordSize > MQTT_JOURNAL_MAX_BYTES)
+	{
+		return false;
+	}
+
+	File journal = fileOpen(MQTT_JOURNAL_FILENAME, "a");
+
+	if (!journal)
+	{
+		return false;
+	}
+
+	char header[MQTT_SEND_HEADER_SIZE];
+	writeMQTTSendHeader(header, topicLength, payloadLength, 0);
+
+	journal.write((const uint8_t *)header, MQTT_SEND_HEADER_SIZE);
+	journal.write((const uint8_t *)topicHead, topicHeadLength);
+	journal.write((const uint8_t *)topicTail, topicLength - topicHeadLength + 1);
+	journal.write((const uint8_t *)buffer, payloadLength);
+	journal.write((uint8_t)0);
+	journal.close();
+
+	mqttJournalBytes += recordSize;
+	mqttJournalled++;
+	return true;
+}
+
+void saveMQTTJournalReadPos()
+{
+	File posFile = fileOpen(MQTT_JOURNAL_POS_FILENAME, "w");
+
+	if (posFile)
+	{
+		posFile.write((const uint8_t *)&mqttJournalReadPos, sizeof(mqttJournalReadPos));
+		posFile.close();
+	}
+}
+
+void clearMQTTJournal()
+{
+	// opening for write empties the file
+	File journal = fileOpen(MQTT_JOURNAL_FILENAME, "w");
+	journal.close();
+	mqttJournalBytes = 0;
+	mqttJournalReadPos = 0;
+	mqttJournalRetries = 0;
+	saveMQTTJournalReadPos();
+}
+
+// picks up messages journalled before a reboot, starting after the
+// last one that was replayed
+
+void openMQTTJournal()
+{
+	mqttJournalBytes = 0;
+	mqttJournalReadPos = 0;
+	mqttJournalRetries = 0;
+
+	File journal = fileOpen(MQTT_JOURNAL_FILENAME, "r");
+
+	if (journal)
+	{
+		mqttJournalBytes = journal.size();
+		journal.close();
+	}
+
+	File posFile = fileOpen(MQTT_JOURNAL_POS_FILENAME, "r");
+
+	if (posFile)
+	{
+		unsigned long savedPos;
+
+		if (posFile.read((uint8_t *)&savedPos, sizeof(savedPos)) == sizeof(savedPos) &&
+			savedPos < mqttJournalBytes)
+		{
+			mqttJournalReadPos = savedPos;
+		}
+		posFile.close();
+	}
+}
+
+bool publishQueuedMQTTMessage(char *topic, char *payload, int payloadLength)
+{
+	if (mqttPubSubClient->publish(topic, (const uint8_t *)payload, payloadLength))
+	{
+		messagesSent++;
+		hardwareDisplayMessage(MQTT_STATUS_TRANSMIT_OK_MESSAGE_NUMBER, ledFlashNormalState, MQTT_STATUS_TRANSMIT_OK_MESSAGE_TEXT);
+		return true;
+	}
+
+	LOG_WARNING(LOG_MODULE_MQTT, "MQTT publish to topic:%s failed\n", topic);
+	hardwareDisplayMessage(MQTT_STATUS_PUBLISH_FAILED_MESSAGE_NUMBER, ledFlashAlertState, MQTT_STATUS_PUBLISH_FAILED_MESSAGE_TEXT);
+	return false;
+}
+
+// returns false if the message could not be sent and the batch should stop
+
+bool sendMQTTSendQueueHead()
+{
+	if (mqttSendTail == mqttSendWrapPos)
+	{
+		mqttSendTail = 0;
+		mqttSendWrapPos = -1;
+	}
+
+	char *record = mqttSendQueue + mqttSendTail;
+	int topicLength = (unsigned char)record[0] + ((unsigned char)record[1] << 8);
+	int payloadLength = (unsigned char)record[2] + ((unsigned char)record[3] << 8);
+	char *topic = record + MQTT_SEND_HEADER_SIZE;
+	char *payload = topic + topicLength + 1;
+
+	LOG_DEBUG(LOG_MODULE_MQTT, "MQTT publishing %d bytes to topic:%s\n", payloadLength, topic);
+
+	if (publishQueuedMQTTMessage(topic, payload, payloadLength))
+	{
+		removeMQTTSendQueueHead();
+		return true;
+	}
+
+	record[4]++;
+
+	if (record[4] >= MQTT_PUBLISH_MAX_RETRIES)
+	{
+		mqttSendFailed++;
+		removeMQTTSendQueueHead();
+	}
+
+	return false;
+}
+
+bool sendMQTTJournalHead()
+{
+	File journal = fileOpen(MQTT_JOURNAL_FILENAME, "r");
+
+	if (!journal || !journal.seek(mqttJournalReadPos))
+	{
+		// the journal has gone - nothing more to replay
+		clearMQTTJournal();
+		return false;
+	}
+
+	int bytesRead = journal.read((uint8_t *)mqttJournalRecord, MQTT_SEND_HEADER_SIZE);
+	int recordSize = mqttSendRecordSize(mqttJournalRecord);
+
+	if (bytesRead != MQTT_SEND_HEADER_SIZE || recordSize > MQTT_JOURNAL_RECORD_SIZE)
+	{
+		journal.close();
+		displayMessage(F("MQTT journal damaged - discarding it\n"));
+		clearMQTTJournal();
+		return false;
+	}
+
+	bytesRead = journal.read((uint8_t *)mqttJournalRecord + MQTT_SEND_HEADER_SIZE, recordSize - MQTT_SEND_HEADER_SIZE);
+	journal.close();
+
+	if (bytesRead != recordSize - MQTT_SEND_HEADER_SIZE)
+	{
+		clearMQTTJournal();
+		return false;
+	}
+
+	int topicLength = (unsigned char)mqttJournalRecord[0] + ((unsigned char)mqttJournalRecord[1] << 8);
+	int payloadLength = (unsigned char)mqttJournalRecord[2] + ((unsigned char)mqttJournalRecord[3] << 8);
+	char *topic = mqttJournalRecord + MQTT_SEND_HEADER_SIZE;
+	char *payload = topic + topicLength + 1;
+
+	bool sent = publishQueuedMQTTMessage(topic, payload, payloadLength);
+
+	if (!sent)
+	{
+		mqttJournalRetries++;
+		if (mqttJournalRetries < MQTT_PUBLISH_MAX_RETRIES)
+		{
+			return false;
 		}
+		mqttSendFailed++;
+	}
+
+	mqttJournalRetries = 0;
+	mqttJournalReadPos += recordSize;
+
+	if (mqttJournalReadPos >= mqttJournalBytes)
+	{
+		clearMQTTJournal();
+	}
+	else
+	{
+		saveMQTTJournalReadPos();
+	}
 
-		displayMessage(F("MQTT publishing:%s to topic:%s\n"), buffer, topicBuffer);
+	return sent;
+}
 
-		boolean result = mqttPubSubClient->publish(topicBuffer, buffer);
+// called from the MQTT update when the connection is up. The queue is
+// sent first because anything in it is older than the journal contents.
 
-		if(result)
+void sendQueuedMQTTMessages()
+{
+	for (int i = 0; i < MQTT_PUBLISH_BATCH_SIZE; i++)
+	{
+		if (mqttSendCount > 0)
 		{
-			displayMessage(F("\n"));
-			hardwareDisplayMessage(MQTT_STATUS_TRANSMIT_OK_MESSAGE_NUMBER, ledFlashNormalState, MQTT_STATUS_TRANSMIT_OK_MESSAGE_TEXT);
-			return MQTT_STATUS_TRANSMIT_OK_MESSAGE_NUMBER;
+			if (!sendMQTTSendQueueHead())
+			{
+				return;
+			}
+		}
+		else if (mqttJournalBytes > 0)
+		{
+			if (!sendMQTTJournalHead())
+			{
+				return;
+			}
 		}
 		else
 		{
-			displayMessage(F(" - Failed"));
-			hardwareDisplayMessage(MQTT_STATUS_PUBLISH_FAILED_MESSAGE_NUMBER, ledFlashAlertState, MQTT_STATUS_PUBLISH_FAILED_MESSAGE_TEXT);
-			return MQTT_STATUS_PUBLISH_FAILED_MESSAGE_NUMBER;
+			return;
 		}
 	}
+}
 
-	displayMessage(F("Not publishing message"));
+// Messages that are kept are journalled when the connection is down or
+// the queue is full. Other messages are dropped in these cases.
 
-	hardwareDisplayMessage(MQTT_STATUS_MESSAGE_CANT_SEND_MESSAGE_NUMBER, ledFlashAlertState, MQTT_STATUS_MESSAGE_CANT_SEND_MESSAGE_TEXT);
+int queueMQTTMessage(const char *buffer, int payloadLength, const char *topicHead, const char *topicTail, bool keepWhenOffline)
+{
+	bool connected = MQTTProcessDescriptor.status == MQTT_OK;
+
+	if (connected && !(keepWhenOffline && mqttJournalBytes > 0))
+	{
+		if (addToMQTTSendQueue(buffer, payloadLength, topicHead, topicTail))
+		{
+			return MQTT_STATUS_QUEUED_MESSAGE_NUMBER;
+		}
+	}
+
+	if (keepWhenOffline)
+	{
+		if (addToMQTTJournal(buffer, payloadLength, topicHead, topicTail))
+		{
+			return MQTT_STATUS_QUEUED_MESSAGE_NUMBER;
+		}
+	}
+
+	mqttSendDropped++;
 
+	if (connected)
+	{
+		LOG_WARNING(LOG_MODULE_MQTT, "MQTT send queue full - message dropped\n");
+		hardwareDisplayMessage(MQTT_STATUS_QUEUE_FULL_MESSAGE_NUMBER, ledFlashAlertState, MQTT_STATUS_QUEUE_FULL_MESSAGE_TEXT);
+		return MQTT_STATUS_QUEUE_FULL_MESSAGE_NUMBER;
+	}
+
+	LOG_WARNING(LOG_MODULE_MQTT, "MQTT not connected - not publishing message\n");
+	hardwareDisplayMessage(MQTT_STATUS_MESSAGE_CANT_SEND_MESSAGE_NUMBER, ledFlashAlertState, MQTT_STATUS_MESSAGE_CANT_SEND_MESSAGE_TEXT);
 	return MQTT_STATUS_MESSAGE_CANT_SEND_MESSAGE_NUMBER;
 }
 
+int publishBufferToMQTTTopic(char *buffer, char *topic)
+{
+	checkMQTTTopics();
+
+	return queueMQTTMessage(buffer, strlen(buffer), mqttTopicHead, topic, true);
+}
+
+// commands for other devices are not kept while the connection is down
+// because they would be out of date by the time they were delivered
+
 int publishCommandToRemoteDevice(char *buffer, char *remoteDeviceName)
 {
-	char topicBuffer [MQTT_TOPIC_LENGTH];
+	checkMQTTTopics();
+
+	return queueMQTTMessage(buffer, strlen(buffer), mqttRemoteCommandTopicHead, remoteDeviceName, false);
+}
 
-	snprintf(topicBuffer,MQTT_TOPIC_LENGTH,"%s/%s",mqttSettings.mqttSubscribeTopic,remoteDeviceName);
+int publishBufferToMQTT(char *buffer)
+{
+	checkMQTTTopics();
 
-	return publishBufferToMQTTTopic(buffer, topicBuffer);
+	return queueMQTTMessage(buffer, strlen(buffer), mqttDataTopic, "", true);
 }
 
+// Sensor readings are sent to the data topic every mqttsecsperupdate
+// seconds when telemetry is turned on, as JSON or as CBOR
 
-int publishBufferToMQTT(char *buffer)
+// In delta mode only the sensors with new readings are sent and nothing
+// is sent if no readings have changed. Every mqttkeyframe sends holds
+// all the readings so that a receiver that missed a delta catches up.
+
+void publishSensorTelemetry()
 {
-	char topicBuffer [MQTT_TOPIC_LENGTH];
+	bool changedOnly = false;
 
-	snprintf(topicBuffer,MQTT_TOPIC_LENGTH,"%s/%s",mqttSettings.mqttPublishTopic,mqttSettings.mqttDeviceName);
+	if (mqttSettings.mqttTelemetryDelta)
+	{
+		bool keyframeDue = telemetrySendsSinceKeyframe + 1 >= mqttSettings.mqttKeyframeSends;
+
+		if (!keyframeDue)
+		{
+			if (!sensorReadingsChanged())
+			{
+				telemetryDeltasSkipped++;
+				return;
+			}
+			changedOnly = true;
+		}
+	}
+
+	sensorTelemetryEncoding encoding = mqttSettings.mqttTelemetryBinary ? sensorTelemetryCbor : sensorTelemetryJson;
+
+	int length = createSensorTelemetry(mqttSettings.mqttDeviceName, mqttTelemetryBuffer, MQTT_TELEMETRY_BUFFER_SIZE, encoding, changedOnly);
+
+	if (length == 0)
+	{
+		LOG_WARNING(LOG_MODULE_MQTT, "Sensor readings too large for telemetry\n");
+		return;
+	}
 
-	return publishBufferToMQTTTopic(buffer,topicBuffer);
+	checkMQTTTopics();
+
+	int result = queueMQTTMessage(mqttTelemetryBuffer, length, mqttDataTopic, "", true);
+
+	if (result != MQTT_STATUS_QUEUED_MESSAGE_NUMBER)
+	{
+		// leave the readings marked as changed so they go next time
+		return;
+	}
+
+	markSensorReadingsTransmitted();
+
+	if (changedOnly)
+	{
+		telemetrySendsSinceKeyframe++;
+		telemetryDeltasSent++;
+	}
+	else
+	{
+		telemetrySendsSinceKeyframe = 0;
+		telemetryKeyframesSent++;
+	}
+}
+
+void updateMQTTTelemetry()
+{
+	if (!mqttSettings.mqttTelemetry || mqttSettings.mqttSecsPerUpdate <= 0)
+	{
+		return;
+	}
+
+	unsigned long currentMillis = millis();
+
+	if (ulongDiff(currentMillis, millisAtLastTelemetry) < (unsigned long)mqttSettings.mqttSecsPerUpdate * 1000)
+	{
+		return;
+	}
+
+	millisAtLastTelemetry = currentMillis;
+
+	publishSensorTelemetry();
 }
 
 void stopMQTT()
@@ -454,12 +1397,15 @@ void stopMQTT()
 	MQTTProcessDescriptor.status = MQTT_OFF;
 }
 
-unsigned long timeOfLastMQTTsuccess = 0;
-
 void updateMQTT()
 {
 	handleIncomingMQTTMessage();
 
+	if (mqttSettings.mqtt_enabled)
+	{
+		updateMQTTTelemetry();
+	}
+
 	switch (MQTTProcessDescriptor.status)
 	{
 
@@ -471,12 +1417,10 @@ void updateMQTT()
 			mqttPubSubClient->disconnect();
 		}
 
-		timeOfLastMQTTsuccess = millis();
-
 		if (!mqttPubSubClient->loop())
 		{
 			mqttPubSubClient->disconnect();
-			MQTTProcessDescriptor.status = MQTT_ERROR_LOOP_FAILED;
+			scheduleMQTTRetry(MQTT_ERROR_LOOP_FAILED);
 		}
 
 		if(!mqttStartCommandsPerformed)
@@ -485,6 +1429,11 @@ void updateMQTT()
 			mqttStartCommandsPerformed = true;
 		}
 
+		if (MQTTProcessDescriptor.status == MQTT_OK)
+		{
+			sendQueuedMQTTMessages();
+		}
+
 		break;
 
 	case MQTT_OFF:
@@ -496,12 +1445,17 @@ void updateMQTT()
 		restartMQTT();
 		break;
 
+	case MQTT_CONNECTING:
+		connectMQTTSession();
+		break;
+
 	case MQTT_ERROR_NOT_CONFIGURED:
 		if (mqttSettings.mqttServer[0]!=0)
 		{
 			MQTTProcessDescriptor.status = MQTT_STARTING;
 			return;
 		}
+		// fall through
 
 	case MQTT_ERROR_NO_WIFI:
 		if (WiFiProcessDescriptor.status == WIFI_OK)
@@ -519,11 +1473,11 @@ void updateMQTT()
 	case MQTT_ERROR_CONNECT_ERROR:
 	case MQTT_ERROR_CONNECT_MESSAGE_FAILED:
 	case MQTT_ERROR_LOOP_FAILED:
+	case MQTT_ERROR_CONNECTION_TIMEOUT:
 
-		if (ulongDiff(millis(), timeOfLastMQTTsuccess) > MQTT_CONNECT_RETRY_INTERVAL_MSECS)
+		if (millisToMQTTRetry(millis()) == 0)
 		{
-			internalReboot(MQTT_CONNECTION_TIMEOUT_REBOOT);
-			timeOfLastMQTTsuccess = millis();
+			MQTTProcessDescriptor.status = MQTT_STARTING;
 		}
 		break;
 
@@ -542,11 +1496,17 @@ void mqttStatusMessage(char *buffer, int bufferLength)
 	switch (MQTTProcessDescriptor.status)
 	{
 	case MQTT_OK:
-		snprintf(buffer, bufferLength, "MQTT OK sent: %d rec: %d", messagesSent, messagesReceived);
+		snprintf(buffer, bufferLength, "MQTT OK sent: %lu rec: %lu queue high water: %lu of %d overflows: %lu truncated: %lu send queue: %d journal: %lu bytes dropped: %lu failed: %lu",
+				 messagesSent, messagesReceived, mqttReceiveHighWater, NO_OF_MQTT_RECEIVE_BUFFERS,
+				 mqttReceiveOverflows, mqttReceiveTruncations,
+				 mqttSendCount, mqttJournalBytes, mqttSendDropped, mqttSendFailed);
 		break;
 	case MQTT_STARTING:
 		snprintf(buffer, bufferLength, "MQTT Starting");
 		break;
+	case MQTT_CONNECTING:
+		snprintf(buffer, bufferLength, "MQTT connecting");
+		break;
 	case MQTT_ERROR_NOT_CONFIGURED:
 		snprintf(buffer, bufferLength, "MQTT not configured");
 		break;
@@ -583,10 +1543,19 @@ void mqttStatusMessage(char *buffer, int bufferLength)
 	case MQTT_ERROR_LOOP_FAILED:
 		snprintf(buffer, bufferLength, "MQTT error loop failed");
 		break;
+	case MQTT_ERROR_CONNECTION_TIMEOUT:
+		snprintf(buffer, bufferLength, "MQTT error connection timeout");
+		break;
 	default:
 		snprintf(buffer, bufferLength, "MQTT failed but I'm not sure why: %d", MQTTProcessDescriptor.status);
 		break;
 	}
+
+	if (mqttRetryPending())
+	{
+		appendFormattedString(buffer, bufferLength, " - attempt %d retry in %lu secs",
+							  mqttConnectFailedCount + 1, millisToMQTTRetry(millis()) / 1000);
+	}
 }
 
 struct process MQTTProcessDescriptor = {
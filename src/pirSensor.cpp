@@ -8,6 +8,7 @@
 #include "mqtt.h"
 #include "controller.h"
 #include "pixels.h"
+#include "idle.h"
 
 struct PirSensorSettings pirSensorSettings;
 
@@ -106,6 +107,8 @@ void updatePIRSensor()
 		return;
 	}
 
+	pirSensor.readingNumber++;
+
 	sensorListener *pos = pirSensor.listeners;
 
 	while (pos != NULL)
@@ -214,6 +217,7 @@ void startPirSensor()
 	else
 	{
 		pinMode(pirSensorSettings.pirSensorPinNo, INPUT);
+		bindIdleWakePin(pirSensorSettings.pirSensorPinNo);
 		pirSensor.status = SENSOR_OK;
 	}
 }
@@ -246,8 +250,7 @@ void addPirSensorReading(char *jsonBuffer, int jsonBufferSize)
 
 	if (pirSensor.status == SENSOR_OK)
 	{
-		appendFormattedString(jsonBuffer, jsonBufferSize, ",\"pir\":\"%d\"",
-				 pirSensoractiveReading->triggered);
+		addSensorReadingInt(jsonBuffer, jsonBufferSize, "pir", pirSensoractiveReading->triggered);
 	}
 }
 
@@ -300,6 +303,9 @@ struct sensor pirSensor = {
 	false, // being updated
 	NULL,  // active reading - set in setup
 	0,	   // active time
+	0,	   // poll interval - zero means every update
+	0,	   // poll offset
+	0,	   // millis at last poll
 	(unsigned char *)&pirSensorSettings,
 	sizeof(struct PirSensorSettings),
 	&pirSensorSettingItems,
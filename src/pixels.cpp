@@ -14,6 +14,8 @@
 #include "Leds.h"
 #include "Sprite.h"
 #include "boot.h"
+#include "idle.h"
+#include "metrics.h"
 
 // Some of the colours have been commented out because they don't render well
 // on NeoPixels
@@ -22,9 +24,11 @@ Adafruit_NeoPixel *strip = NULL;
 
 struct PixelSettings pixelSettings;
 
-Leds *leds;
+Leds *leds = NULL;
 Frame *frame;
 
+neoPixelType pixelStripType;
+
 void setDefaultPixelName(void *dest)
 {
 	strcpy((char *)dest, "");
@@ -213,6 +217,45 @@ struct SettingItem pixelBrightnessSetting = {"Default pixel brightness",
 											 setDefaultPixelBrightness,
 											 validatePixelBrightness};
 
+void setDefaultPixelGamma(void *dest)
+{
+	float *destFloat = (float *)dest;
+	*destFloat = 1;
+}
+
+boolean validatePixelGamma(void *dest, const char *newValueStr)
+{
+	float value;
+
+	if (!validateFloat(&value, newValueStr))
+	{
+		return false;
+	}
+
+	if (value < 0.5 || value > 4)
+	{
+		return false;
+	}
+
+	*(float *)dest = value;
+
+	if (leds != NULL)
+	{
+		leds->setGamma(value);
+		frame->frameChanged = true;
+	}
+
+	return true;
+}
+
+struct SettingItem pixelGammaSetting = {"Pixel gamma (1 for none, 2.2 for perceptual)",
+										"pixelgamma",
+										&pixelSettings.gamma,
+										NUMBER_INPUT_LENGTH,
+										floatValue,
+										setDefaultPixelGamma,
+										validatePixelGamma};
+
 void setDefaultPixelConfig(void *dest)
 {
 	int *destConfig = (int *)dest;
@@ -255,6 +298,7 @@ struct SettingItem *pixelSettingItemPointers[] =
 		&pixelPanelHeight,
 		&pixelPixelConfig,
 		&pixelBrightnessSetting,
+		&pixelGammaSetting,
 		&pixelNameSetting};
 
 struct SettingItemCollection pixelSettingItems = {
@@ -265,6 +309,21 @@ struct SettingItemCollection pixelSettingItems = {
 
 unsigned long millisOfLastPixelUpdate;
 
+// time taken to update and render each frame
+
+const unsigned long pixelFrameLimitsMicros[] = {250, 500, 1000, 2000, 5000, 10000};
+
+struct metricHistogram pixelFrameHistogram = {
+	pixelFrameLimitsMicros,
+	sizeof(pixelFrameLimitsMicros) / sizeof(unsigned long),
+	{0}, // counts
+	0,	 // number of values
+	0};	 // largest value
+
+unsigned long pixelFrameTotalMicros;
+unsigned long pixelFrameCount;
+unsigned long pixelFramesSkipped;
+
 int *rasterLookup = NULL;
 
 int noOfPixels;
@@ -384,14 +443,16 @@ bool startPixelStrip()
 		// panel
 	case 4:
 		// multi-panel
+		pixelStripType = NEO_GRB + NEO_KHZ800;
 		strip = new Adafruit_NeoPixel(noOfPixels, pixelSettings.pixelControlPinNo,
-									  NEO_GRB + NEO_KHZ800);
+									  pixelStripType);
 
 		break;
 	case 2:
 		// strand
+		pixelStripType = NEO_KHZ400 + NEO_RGB;
 		strip = new Adafruit_NeoPixel(noOfPixels, pixelSettings.pixelControlPinNo,
-									  NEO_KHZ400 + NEO_RGB);
+									  pixelStripType);
 		break;
 	default:
 		strip = NULL;
@@ -1100,6 +1161,7 @@ struct CommandItemCollection pixelCommands =
 //////////////////////////////////////////////////////////////////////////
 
 bool busyPixelActive = false;
+bool busyPixelChanged = false;
 byte busyPixelPos = 0;
 byte busyRed, busyGreen, busyBlue;
 
@@ -1114,6 +1176,8 @@ void updateBusyPixel()
 
 	if (busyPixelPos == noOfPixels)
 		busyPixelPos = 0;
+
+	busyPixelChanged = true;
 }
 
 void setBusyPixelColour(byte red, byte green, byte blue)
@@ -1121,6 +1185,7 @@ void setBusyPixelColour(byte red, byte green, byte blue)
 	busyRed = red;
 	busyBlue = blue;
 	busyGreen = green;
+	busyPixelChanged = true;
 }
 
 void startBusyPixel(byte red, byte green, byte blue)
@@ -1133,6 +1198,7 @@ void startBusyPixel(byte red, byte green, byte blue)
 void stopBusyPixel()
 {
 	busyPixelActive = false;
+	busyPixelChanged = true;
 }
 
 void renderBusyPixel()
@@ -1153,29 +1219,64 @@ void show()
 	strip->show();
 }
 
+// The leds pass the position in the strip, having already been through
+// the raster lookup
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+
+void setPixel(int no, unsigned char r, unsigned char g, unsigned char b)
+{
+	strip->setPixelColor(no, r, g, b);
+}
+
+#else
+
 void setPixel(int no, float r, float g, float b)
 {
-	if (rasterLookup == NULL)
-	{
-		return;
-	}
 	unsigned char rs = (unsigned char)round(r * 255);
 	unsigned char gs = (unsigned char)round(g * 255);
 	unsigned char bs = (unsigned char)round(b * 255);
 	if (rs > 255 || gs > 255 || bs > 255)
-		displayMessage(F("setPixel no:%d raster:%d r:%f g:%f b:%f\n"), no, rasterLookup[no], r, g, b);
-	strip->setPixelColor(rasterLookup[no], rs, gs, bs);
+		displayMessage(F("setPixel no:%d r:%f g:%f b:%f\n"), no, r, g, b);
+	strip->setPixelColor(no, rs, gs, bs);
 }
 
+#endif
+
 void setAllLightsOff()
 {
 	frame->fadeSpritesToWalkingColours("K", 10);
 }
 
+// deadline for the idle sleep - the frame must be updated on time
+
+unsigned long millisToNextPixelFrame(unsigned long currentMillis)
+{
+	if (pixelProcess.status != PIXEL_OK)
+	{
+		return IDLE_NO_DEADLINE;
+	}
+
+	unsigned long millisSinceLastUpdate = ulongDiff(currentMillis, millisOfLastPixelUpdate);
+
+	if (millisSinceLastUpdate >= MILLIS_BETWEEN_UPDATES)
+	{
+		return 0;
+	}
+
+	return MILLIS_BETWEEN_UPDATES - millisSinceLastUpdate;
+}
+
 void initPixel()
 {
 	pixelProcess.status = PIXEL_OFF;
 
+	bindIdleDeadline(millisToNextPixelFrame);
+
+	addHistogramMetric("pixelframemicros", &pixelFrameHistogram);
+	addCounterMetric("pixelframes", &pixelFrameCount);
+	addCounterMetric("pixelframesskipped", &pixelFramesSkipped);
+
 	noOfPixels = pixelSettings.noOfXPixels * pixelSettings.noOfYPixels;
 
 	if (noOfPixels == 0)
@@ -1195,7 +1296,18 @@ void startPixel()
 		return;
 	}
 
-	leds = new Leds(pixelSettings.noOfXPixels, pixelSettings.noOfYPixels, show, setPixel);
+	leds = new Leds(pixelSettings.noOfXPixels, pixelSettings.noOfYPixels, rasterLookup, show, setPixel);
+
+	// The strip type holds the byte offset of each colour. If the white
+	// offset is the same as the red one the strip has no white channel.
+	int whiteOffset = (pixelStripType >> 6) & 3;
+	int redOffset = (pixelStripType >> 4) & 3;
+	int greenOffset = (pixelStripType >> 2) & 3;
+	int blueOffset = pixelStripType & 3;
+
+	leds->setOutputBuffer(strip->getPixels(), redOffset, greenOffset, blueOffset,
+						  whiteOffset == redOffset ? 3 : 4);
+	leds->setGamma(pixelSettings.gamma);
 
 	frame = new Frame(leds, BLACK_COLOUR);
 	frame->fadeUp(1000);
@@ -1248,9 +1360,26 @@ void updateFrame()
 
 	if (millisSinceLastUpdate >= MILLIS_BETWEEN_UPDATES)
 	{
+		unsigned long frameStartMicros = micros();
+
 		frame->update();
-		frame->render();
 		millisOfLastPixelUpdate = currentMillis;
+
+		// Sending the frame to the strip stops interrupts for the whole
+		// transfer, so don't send it again if nothing has changed.
+		if (!frame->frameChanged && !busyPixelChanged)
+		{
+			pixelFramesSkipped++;
+			return;
+		}
+
+		frame->render();
+		busyPixelChanged = false;
+
+		unsigned long frameMicros = ulongDiff(micros(), frameStartMicros);
+		recordMetricHistogram(&pixelFrameHistogram, frameMicros);
+		pixelFrameTotalMicros += frameMicros;
+		pixelFrameCount++;
 	}
 }
 
@@ -1288,8 +1417,21 @@ void pixelStatusMessage(char *buffer, int bufferLength)
 		snprintf(buffer, bufferLength, "No pixels connected");
 		break;
 	case PIXEL_OK:
-		snprintf(buffer, bufferLength, "PIXEL OK");
+	{
+		unsigned long averageFrameMicros = 0;
+		if (pixelFrameCount > 0)
+		{
+			averageFrameMicros = pixelFrameTotalMicros / pixelFrameCount;
+		}
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+		const char *framebufferType = "integer";
+#else
+		const char *framebufferType = "float";
+#endif
+		snprintf(buffer, bufferLength, "PIXEL OK %s framebuffer frames:%lu skipped:%lu average frame micros:%lu",
+				 framebufferType, pixelFrameCount, pixelFramesSkipped, averageFrameMicros);
 		break;
+	}
 	case PIXEL_OFF:
 		snprintf(buffer, bufferLength, "PIXEL OFF");
 		break;
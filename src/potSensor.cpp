@@ -126,6 +126,7 @@ void updatePOTSensor()
 	potSensoractiveReading->previousPotReading = potSensoractiveReading->counter;
 
 	potSensor.millisAtLastReading = currentMillis;
+	potSensor.readingNumber++;
 
 	// work through the listeners and post messages where requested
 
@@ -238,8 +239,7 @@ void addPotSensorReading(char *jsonBuffer, int jsonBufferSize)
 
 	if (potSensor.status == SENSOR_OK)
 	{
-		appendFormattedString(jsonBuffer, jsonBufferSize, ",\"pot\":\"%d\"",
-				 potSensoractiveReading->counter);
+		addSensorReadingInt(jsonBuffer, jsonBufferSize, "pot", potSensoractiveReading->counter);
 	}
 }
 
@@ -283,6 +283,9 @@ struct sensor potSensor = {
 	false, // being updated
 	NULL,  // active reading - set in setup
 	0,	   // active time
+	0,	   // poll interval - zero means every update
+	0,	   // poll offset
+	0,	   // millis at last poll
 	(unsigned char *)&potSensorSettings,
 	sizeof(struct PotSensorSettings),
 	&potSensorSettingItems,
@@ -281,7 +281,7 @@ void startPrinter()
 
     if (printerSettings.printMessages)
     {
-        bindMessageHandler(displayMessageOnStatusPrinter);
+        bindQueuedMessageHandler(displayMessageOnStatusPrinter);
     }
 }
 
@@ -291,6 +291,9 @@ void updatePrinter()
     {
         return;
     }
+
+    // one message per update so that the printer never holds up the loop for long
+    deliverQueuedMessage(displayMessageOnStatusPrinter);
 }
 
 void stopPrinter()
@@ -7,11 +7,22 @@
 #include "utils.h"
 #include "messages.h"
 #include "settings.h"
+#include "boot.h"
+#include "metrics.h"
 
 struct process *activeProcessList = NULL;
 
 struct process *allProcessList = NULL;
 
+const unsigned long processPassLimitsMicros[] = {100, 500, 1000, 5000, 20000, 100000};
+
+struct metricHistogram processPassMicros = {
+	processPassLimitsMicros,
+	sizeof(processPassLimitsMicros) / sizeof(unsigned long),
+	{0}, // counts
+	0,	 // number of values
+	0};	 // largest value
+
 struct process *getAllProcessList()
 {
 	return allProcessList;
@@ -164,6 +175,8 @@ void initialiseAllProcesses()
 		DISPLAY_MEMORY_MONITOR(procPtr->processName);
 		procPtr = procPtr->nextAllProcesses;
 	}
+
+	addHistogramMetric("processpassmicros", &processPassMicros);
 }
 
 void startProcesses()
@@ -174,22 +187,50 @@ void startProcesses()
 
 	while (procPtr != NULL)
 	{
-		if (procPtr->beingUpdated)
+		// only start processes that aren't active
+		if (!procPtr->beingUpdated)
 		{
-			// only start processes that aren't active
-			continue;
+			if (bootSettings.fastBoot && (procPtr->processStartMask & DEFERRED_START_PROCESS))
+			{
+				displayMessage(F("   %s: deferred\n"), procPtr->processName);
+			}
+			else
+			{
+				startProcess(procPtr);
+			}
+		}
+		procPtr = procPtr->nextActiveProcess;
+	}
+}
+
+void startDeferredProcesses()
+{
+	struct process *procPtr = activeProcessList;
+
+	while (procPtr != NULL)
+	{
+		if (!procPtr->beingUpdated && (procPtr->processStartMask & DEFERRED_START_PROCESS))
+		{
+			startProcess(procPtr);
 		}
-		startProcess(procPtr);
 		procPtr = procPtr->nextActiveProcess;
 	}
 }
 
 void updateProcesses()
 {
+	unsigned long passStartMicros = micros();
+
 	struct process *procPtr = activeProcessList;
 
 	while (procPtr != NULL)
 	{
+		if (!procPtr->beingUpdated)
+		{
+			// deferred processes are not updated until they have started
+			procPtr = procPtr->nextActiveProcess;
+			continue;
+		}
 		unsigned long startMicros = micros();
 		//		displayMessage(F("%s\n"), procPtr->processName);
 		procPtr->udpateProcess();
@@ -206,6 +247,8 @@ void updateProcesses()
 		DISPLAY_MEMORY_MONITOR(procPtr->processName);
 		procPtr = procPtr->nextActiveProcess;
 	}
+
+	recordMetricHistogram(&processPassMicros, ulongDiff(micros(), passStartMicros));
 }
 
 void dumpProcessStatus()
@@ -322,6 +365,19 @@ void iterateThroughProcessSettings(void (*func)(unsigned char *settings, int siz
 	}
 }
 
+void iterateThroughProcessSettingStores(void (*func)(unsigned char *settings, int size, SettingItemCollection *s))
+{
+	struct process *procPtr = allProcessList;
+
+	while (procPtr != NULL)
+	{
+		func(procPtr->settingsStoreBase,
+			 procPtr->settingsStoreLength,
+			 procPtr->settingItems);
+		procPtr = procPtr->nextAllProcesses;
+	}
+}
+
 void iterateThroughProcessSettingCollections(void (*func)(SettingItemCollection *s))
 {
 	struct process *procPtr = allProcessList;
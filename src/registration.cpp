@@ -389,7 +389,7 @@ struct process RegistrationProcess = {
 	NULL,
 	(unsigned char *)&RegistrationSettings, sizeof(RegistrationSettings), &registrationSettingItems,
 	&RegistrationCommands,
-	BOOT_PROCESS + ACTIVE_PROCESS + CONFIG_PROCESS + WIFI_CONFIG_PROCESS,
+	BOOT_PROCESS + ACTIVE_PROCESS + CONFIG_PROCESS + WIFI_CONFIG_PROCESS + DEFERRED_START_PROCESS,
 	NULL,
 	NULL,
 	NULL};
@@ -203,6 +203,11 @@ void updateROTARYSensor()
 
 	rotarySensor.millisAtLastReading = millis();
 
+	if (rotarySensoractiveReading->counter != previousCounter)
+	{
+		rotarySensor.readingNumber++;
+	}
+
 	// work through the listeners and post messages where requested
 
 	sensorListener *pos = rotarySensor.listeners;
@@ -341,8 +346,7 @@ void addRotarySensorReading(char *jsonBuffer, int jsonBufferSize)
 
 	if (rotarySensor.status == SENSOR_OK)
 	{
-		appendFormattedString(jsonBuffer, jsonBufferSize, ",\"rotary\":\"%d\"",
-				 rotarySensoractiveReading->counter);
+		addSensorReadingInt(jsonBuffer, jsonBufferSize, "rotary", rotarySensoractiveReading->counter);
 	}
 }
 
@@ -385,6 +389,9 @@ struct sensor rotarySensor = {
 	false, // being updated
 	NULL,  // active reading - set in setup
 	0,	   // active time
+	0,	   // poll interval - zero means every update
+	0,	   // poll offset
+	0,	   // millis at last poll
 	(unsigned char *)&rotarySensorSettings,
 	sizeof(struct RotarySensorSettings),
 	&rotarySensorSettingItems,
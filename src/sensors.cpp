@@ -1,4 +1,5 @@
 #include <strings.h>
+#include <limits.h>
 
 #include "debug.h"
 #include "sensors.h"
@@ -7,6 +8,8 @@
 #include "controller.h"
 #include "utils.h"
 #include "messages.h"
+#include "boot.h"
+#include "metrics.h"
 
 struct sensor *activeSensorList = NULL;
 struct sensor *allSensorList = NULL;
@@ -216,8 +219,103 @@ char sensorStatusBuffer[SENSOR_STATUS_BUFFER_SIZE];
 
 char sensorValueBuffer[SENSOR_VALUE_BUFFER_SIZE];
 
+// time taken by the most recent pass through the sensors and the worst
+// pass since the status was last displayed - the difference is the jitter
+// that sensor updates add to the loop
+
+unsigned long sensorPassMicros = 0;
+unsigned long sensorPassMaxMicros = 0;
+
+void scheduleSensorPolling(sensor *s)
+{
+	if (s->pollIntervalMillis == 0)
+	{
+		return;
+	}
+
+	// back date the last poll so that the first poll lands on the offset
+
+	unsigned long offset = s->pollOffsetMillis % s->pollIntervalMillis;
+	s->millisAtLastPoll = millis() + offset - s->pollIntervalMillis;
+}
+
+// returns true if the sensor should be updated on this pass
+// and moves the sensor on to its next poll time
+
+bool sensorPollDue(struct sensor *s, unsigned long currentMillis)
+{
+	if (s->pollIntervalMillis == 0)
+	{
+		return true;
+	}
+
+	unsigned long millisSinceLastPoll = ulongDiff(currentMillis, s->millisAtLastPoll);
+
+	if (millisSinceLastPoll < s->pollIntervalMillis)
+	{
+		return false;
+	}
+
+	if (millisSinceLastPoll < 2 * s->pollIntervalMillis)
+	{
+		// stay on the original phase so the sensors remain staggered
+		s->millisAtLastPoll = s->millisAtLastPoll + s->pollIntervalMillis;
+	}
+	else
+	{
+		// we have fallen a long way behind - start again from now
+		s->millisAtLastPoll = currentMillis;
+	}
+
+	return true;
+}
+
+// returns the number of millis until the next sensor with a polling
+// interval is due. Sensors polled on every pass are not included.
+
+unsigned long millisToNextSensorPoll(unsigned long currentMillis)
+{
+	unsigned long result = ULONG_MAX;
+
+	sensor *activeSensorPtr = activeSensorList;
+
+	while (activeSensorPtr != NULL)
+	{
+		if (activeSensorPtr->beingUpdated && activeSensorPtr->pollIntervalMillis != 0)
+		{
+			unsigned long millisSinceLastPoll = ulongDiff(currentMillis, activeSensorPtr->millisAtLastPoll);
+
+			if (millisSinceLastPoll >= activeSensorPtr->pollIntervalMillis)
+			{
+				return 0;
+			}
+
+			unsigned long millisToPoll = activeSensorPtr->pollIntervalMillis - millisSinceLastPoll;
+
+			if (millisToPoll < result)
+			{
+				result = millisToPoll;
+			}
+		}
+		activeSensorPtr = activeSensorPtr->nextActiveSensor;
+	}
+
+	return result;
+}
+
+const unsigned long sensorPassLimitsMicros[] = {100, 500, 1000, 5000, 20000, 100000};
+
+struct metricHistogram sensorPassHistogram = {
+	sensorPassLimitsMicros,
+	sizeof(sensorPassLimitsMicros) / sizeof(unsigned long),
+	{0}, // counts
+	0,	 // number of values
+	0};	 // largest value
+
 void startSensors()
 {
+	addHistogramMetric("sensorpassmicros", &sensorPassHistogram);
+
 	displayMessage(F("Starting sensors\n"));
 	// start all the sensor managers
 
@@ -227,6 +325,7 @@ void startSensors()
 	{
 		displayMessage(F("   %s: "), activeSensorPtr->sensorName);
 		activeSensorPtr->startSensor();
+		scheduleSensorPolling(activeSensorPtr);
 		activeSensorPtr->getStatusMessage(sensorStatusBuffer, SENSOR_STATUS_BUFFER_SIZE);
 		displayMessage(F("%s\n"), sensorStatusBuffer);
 		activeSensorPtr->beingUpdated = true;
@@ -254,6 +353,12 @@ void dumpSensorStatus()
 
 		activeSensorPtr = activeSensorPtr->nextActiveSensor;
 	}
+
+	displayMessage(F("    Sensor update pass (microsecs) last: %lu max: %lu\n"),
+				   sensorPassMicros, sensorPassMaxMicros);
+
+	// start a new measurement period for the worst case
+	sensorPassMaxMicros = 0;
 }
 
 bool dumpSensorStatusFiltered(const char *name)
@@ -297,37 +402,274 @@ void startSensorsReading()
 
 void updateSensors()
 {
+	unsigned long passStartMicros = micros();
+	unsigned long currentMillis = millis();
+
 	sensor *activeSensorPtr = activeSensorList;
 
 	while (activeSensorPtr != NULL)
 	{
-		if (activeSensorPtr->beingUpdated)
+		if (activeSensorPtr->beingUpdated && sensorPollDue(activeSensorPtr, currentMillis))
 		{
 			unsigned long startMicros = micros();
+			unsigned long millisAtLastReading = activeSensorPtr->millisAtLastReading;
 			activeSensorPtr->updateSensor();
+			if (activeSensorPtr->millisAtLastReading != millisAtLastReading)
+			{
+				recordBootFirstWork(activeSensorPtr->sensorName);
+			}
 			DISPLAY_MEMORY_MONITOR(activeSensorPtr->sensorName);
 			activeSensorPtr->activeTime = ulongDiff(micros(), startMicros);
 		}
 		activeSensorPtr = activeSensorPtr->nextActiveSensor;
 	}
+
+	sensorPassMicros = ulongDiff(micros(), passStartMicros);
+
+	recordMetricHistogram(&sensorPassHistogram, sensorPassMicros);
+
+	if (sensorPassMicros > sensorPassMaxMicros)
+	{
+		sensorPassMaxMicros = sensorPassMicros;
+	}
 }
 
-void createSensorJson(char *name, char *buffer, int bufferLength)
+// Sensors add their readings through the addSensorReading functions so
+// that the same addReading function produces either JSON text or CBOR.
+// JSON readings are appended to the string in the buffer. CBOR readings
+// are written at sensorCborLength because the buffer can contain zeros.
+// Either kind sets sensorTelemetryOverflow if it runs out of buffer.
+
+sensorTelemetryEncoding activeTelemetryEncoding = sensorTelemetryJson;
+
+int sensorCborLength;
+bool sensorTelemetryOverflow;
+
+void appendSensorJson(char *buffer, int bufferSize, const char *format, ...)
+{
+	int length = strlen(buffer);
+
+	if (length >= bufferSize - 1)
+	{
+		sensorTelemetryOverflow = true;
+		return;
+	}
+
+	va_list args;
+	va_start(args, format);
+	int added = vsnprintf(buffer + length, bufferSize - length, format, args);
+	va_end(args);
+
+	if (added < 0 || added >= bufferSize - length)
+	{
+		sensorTelemetryOverflow = true;
+	}
+}
+
+void writeSensorCborByte(char *buffer, int bufferSize, unsigned char value)
+{
+	if (sensorCborLength >= bufferSize)
+	{
+		sensorTelemetryOverflow = true;
+		return;
+	}
+	buffer[sensorCborLength++] = (char)value;
+}
+
+// writes a CBOR item head - the major type in the top three bits followed
+// by the value or length in the shortest form that holds it
+
+void writeSensorCborHead(char *buffer, int bufferSize, unsigned char majorType, unsigned long value)
+{
+	majorType = majorType << 5;
+
+	if (value < 24)
+	{
+		writeSensorCborByte(buffer, bufferSize, majorType | value);
+	}
+	else if (value < 0x100)
+	{
+		writeSensorCborByte(buffer, bufferSize, majorType | 24);
+		writeSensorCborByte(buffer, bufferSize, value);
+	}
+	else if (value < 0x10000)
+	{
+		writeSensorCborByte(buffer, bufferSize, majorType | 25);
+		writeSensorCborByte(buffer, bufferSize, value >> 8);
+		writeSensorCborByte(buffer, bufferSize, value & 0xff);
+	}
+	else
+	{
+		writeSensorCborByte(buffer, bufferSize, majorType | 26);
+		writeSensorCborByte(buffer, bufferSize, (value >> 24) & 0xff);
+		writeSensorCborByte(buffer, bufferSize, (value >> 16) & 0xff);
+		writeSensorCborByte(buffer, bufferSize, (value >> 8) & 0xff);
+		writeSensorCborByte(buffer, bufferSize, value & 0xff);
+	}
+}
+
+void writeSensorCborText(char *buffer, int bufferSize, const char *text)
 {
-	snprintf(buffer, bufferLength, "{ \"dev\":\"%s\"", name);
+	int length = strlen(text);
+
+	writeSensorCborHead(buffer, bufferSize, CBOR_MAJOR_TEXT, length);
+
+	for (int i = 0; i < length; i++)
+	{
+		writeSensorCborByte(buffer, bufferSize, text[i]);
+	}
+}
+
+void addSensorReadingInt(char *buffer, int bufferSize, const char *name, long value)
+{
+	if (activeTelemetryEncoding == sensorTelemetryJson)
+	{
+		// numbers have always been sent as strings in the JSON
+		appendSensorJson(buffer, bufferSize, ",\"%s\":\"%ld\"", name, value);
+		return;
+	}
+
+	writeSensorCborText(buffer, bufferSize, name);
+
+	if (value >= 0)
+	{
+		writeSensorCborHead(buffer, bufferSize, CBOR_MAJOR_UNSIGNED, (unsigned long)value);
+	}
+	else
+	{
+		writeSensorCborHead(buffer, bufferSize, CBOR_MAJOR_NEGATIVE, (unsigned long)(-1 - value));
+	}
+}
+
+void addSensorReadingFloat(char *buffer, int bufferSize, const char *name, float value)
+{
+	if (activeTelemetryEncoding == sensorTelemetryJson)
+	{
+		appendSensorJson(buffer, bufferSize, ",\"%s\":%.2f", name, value);
+		return;
+	}
+
+	writeSensorCborText(buffer, bufferSize, name);
 
+	// single precision float, most significant byte first
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	writeSensorCborByte(buffer, bufferSize, CBOR_FLOAT32);
+	writeSensorCborByte(buffer, bufferSize, (bits >> 24) & 0xff);
+	writeSensorCborByte(buffer, bufferSize, (bits >> 16) & 0xff);
+	writeSensorCborByte(buffer, bufferSize, (bits >> 8) & 0xff);
+	writeSensorCborByte(buffer, bufferSize, bits & 0xff);
+}
+
+void addSensorReadingText(char *buffer, int bufferSize, const char *name, const char *value)
+{
+	if (activeTelemetryEncoding == sensorTelemetryJson)
+	{
+		appendSensorJson(buffer, bufferSize, ",\"%s\":\"%s\"", name, value);
+		return;
+	}
+
+	writeSensorCborText(buffer, bufferSize, name);
+	writeSensorCborText(buffer, bufferSize, value);
+}
+
+// A sensor has a new reading to send when its reading number has moved
+// on since the last transmit
+
+bool sensorReadingChanged(sensor *s)
+{
+	return s->readingNumber != s->lastTransmittedReadingNumber;
+}
+
+bool sensorReadingsChanged()
+{
 	sensor *activeSensorPtr = activeSensorList;
 
 	while (activeSensorPtr != NULL)
 	{
-		if (activeSensorPtr->beingUpdated)
+		if (activeSensorPtr->beingUpdated && sensorReadingChanged(activeSensorPtr))
+		{
+			return true;
+		}
+		activeSensorPtr = activeSensorPtr->nextActiveSensor;
+	}
+	return false;
+}
+
+void markSensorReadingsTransmitted()
+{
+	sensor *activeSensorPtr = activeSensorList;
+
+	while (activeSensorPtr != NULL)
+	{
+		activeSensorPtr->lastTransmittedReadingNumber = activeSensorPtr->readingNumber;
+		activeSensorPtr = activeSensorPtr->nextActiveSensor;
+	}
+}
+
+// Returns the number of bytes in the buffer or zero if the readings
+// did not fit. A CBOR message is an indefinite length map with the
+// same names and values as the JSON. If changedOnly is set only the
+// sensors with a new reading since the last transmit are added.
+
+int createSensorTelemetry(char *name, char *buffer, int bufferLength, sensorTelemetryEncoding encoding, bool changedOnly)
+{
+	activeTelemetryEncoding = encoding;
+	sensorTelemetryOverflow = false;
+
+	if (encoding == sensorTelemetryJson)
+	{
+		buffer[0] = 0;
+		appendSensorJson(buffer, bufferLength, "{ \"dev\":\"%s\"", name);
+	}
+	else
+	{
+		sensorCborLength = 0;
+		writeSensorCborByte(buffer, bufferLength, CBOR_MAP_START);
+		writeSensorCborText(buffer, bufferLength, "dev");
+		writeSensorCborText(buffer, bufferLength, name);
+	}
+
+	sensor *activeSensorPtr = activeSensorList;
+
+	while (activeSensorPtr != NULL)
+	{
+		if (activeSensorPtr->beingUpdated && (!changedOnly || sensorReadingChanged(activeSensorPtr)))
 		{
 			activeSensorPtr->addReading(buffer, bufferLength);
 		}
 		activeSensorPtr = activeSensorPtr->nextActiveSensor;
 	}
 
-	appendFormattedString(buffer, bufferLength, "}");
+	// the console displays readings as JSON
+	activeTelemetryEncoding = sensorTelemetryJson;
+
+	if (encoding == sensorTelemetryJson)
+	{
+		appendSensorJson(buffer, bufferLength, "}");
+	}
+	else
+	{
+		writeSensorCborByte(buffer, bufferLength, CBOR_BREAK);
+	}
+
+	if (sensorTelemetryOverflow)
+	{
+		return 0;
+	}
+
+	if (encoding == sensorTelemetryJson)
+	{
+		return strlen(buffer);
+	}
+
+	return sensorCborLength;
+}
+
+void createSensorJson(char *name, char *buffer, int bufferLength)
+{
+	createSensorTelemetry(name, buffer, bufferLength, sensorTelemetryJson, false);
 }
 
 void stopSensors()
@@ -382,6 +724,19 @@ void iterateThroughSensorSettings(void (*func)(unsigned char *settings, int size
 	}
 }
 
+void iterateThroughSensorSettingStores(void (*func)(unsigned char *settings, int size, SettingItemCollection *s))
+{
+	sensor *allSensorPtr = allSensorList;
+
+	while (allSensorPtr != NULL)
+	{
+		func(allSensorPtr->settingsStoreBase,
+			 allSensorPtr->settingsStoreLength,
+			 allSensorPtr->settingItems);
+		allSensorPtr = allSensorPtr->nextAllSensors;
+	}
+}
+
 void iterateThroughSensorSettings(void (*func)(SettingItem *s))
 {
 	sensor *allSensorPtr = allSensorList;
@@ -22,6 +22,8 @@
 #include "controller.h"
 #include "registration.h"
 #include "HullOS.h"
+#include "idle.h"
+#include "metrics.h"
 
 SettingsStoreStatus settingsStoreStatus = SETTINGS_STATUS_JUST_BOOTED;
 
@@ -630,15 +632,20 @@ void saveSettingCollectionToFile(SettingItemCollection *settingCollection)
 	}
 }
 
-void saveAllSettingsToFile(char *path)
+bool saveAllSettingsToFile(char *path)
 {
 	TRACELOG("Saving all settings to the file:");
 	TRACELOGLN(path);
 	saveFile = fileOpen(path, "w");
+	if (!saveFile)
+	{
+		return false;
+	}
 	iterateThroughSensorSettingCollections(saveSettingCollectionToFile);
 	iterateThroughProcessSettingCollections(saveSettingCollectionToFile);
 	saveFile.close();
 	TRACELOGLN("Settings saved");
+	return true;
 }
 
 processSettingCommandResult decodeSettingCommand(char *commandStart)
@@ -870,7 +877,8 @@ void PrintSettingCollectionFiltered(SettingItemCollection *settingCollection)
 
 void PrintSystemDetails(char *buffer, int length)
 {
-	char id_buffer[DEVICE_NAME_LENGTH];
+	// leaves room for the CLB- in front
+	char id_buffer[DEVICE_NAME_LENGTH-4];
 
 	getProcID(id_buffer,DEVICE_NAME_LENGTH-4);
 
@@ -1009,6 +1017,395 @@ void validateSettingValues(SettingItem * s){
 	return defaultsApplied;
 }
 
+// The settings image holds each settings store block as it is held in
+// memory, behind a header with a hash of the layout of all the settings.
+// Each block has its own CRC. A firmware update that changes the layout
+// changes the hash, and the settings are then loaded from the text file,
+// which is written whenever the image changes.
+
+struct SettingsImageHeader
+{
+	uint32_t magic;
+	uint32_t schemaHash;
+	uint16_t version;
+	uint16_t noOfBlocks;
+};
+
+struct SettingsImageBlockHeader
+{
+	uint32_t length;
+	uint32_t crc;
+};
+
+uint32_t settingsSchemaHash;
+int settingsImageNoOfBlocks;
+
+// false if a setting value is not held in the store of its collection
+
+bool settingsImageUsable;
+
+// cleared when a block can't be read or written
+
+bool settingsImageOK;
+
+// set when a block from the image has been copied over the settings
+
+bool settingsImageBlockLoaded;
+
+// true when the image file matches the settings in memory and the
+// current layout, so that it need only be written when a store changes
+
+bool settingsImageInPlace = false;
+
+// set when a settings store differs from the image
+
+bool settingsStoreChangeFound;
+
+// CRC of each settings store as it was last loaded or written,
+// used to find the stores that have changed
+
+uint32_t settingsStoreCRCs[SETTINGS_MAX_NO_OF_STORES];
+int settingsStoreNo;
+
+const char *settingsLoadSource = "none";
+unsigned long settingsLoadMicros = 0;
+
+// Saves are deferred. The first call of saveSettings starts the save
+// delay and any other changes made during it are written with it.
+
+bool settingsSavePending = false;
+unsigned long settingsSaveRequestMillis;
+
+unsigned long settingsSaveRequests = 0;
+unsigned long settingsFlushes = 0;
+unsigned long settingsImageWrites = 0;
+unsigned long settingsTextWrites = 0;
+
+uint32_t hashSettingsBytes(uint32_t hash, const void *data, int length)
+{
+	const uint8_t *bytes = (const uint8_t *)data;
+
+	for (int i = 0; i < length; i++)
+	{
+		hash = (hash ^ bytes[i]) * 16777619UL;
+	}
+
+	return hash;
+}
+
+uint32_t hashSettingsString(uint32_t hash, const char *text)
+{
+	return hashSettingsBytes(hash, text, strlen(text) + 1);
+}
+
+void hashSettingStore(unsigned char *settings, int size, SettingItemCollection *collection)
+{
+	settingsImageNoOfBlocks++;
+
+	settingsSchemaHash = hashSettingsBytes(settingsSchemaHash, &size, sizeof(size));
+
+	if (collection == NULL)
+	{
+		return;
+	}
+
+	settingsSchemaHash = hashSettingsString(settingsSchemaHash, collection->collectionName);
+
+	for (int settingNo = 0; settingNo < collection->noOfSettings; settingNo++)
+	{
+		SettingItem *item = collection->settings[settingNo];
+
+		int offset = (unsigned char *)item->value - settings;
+
+		if (settings == NULL || offset < 0 || offset >= size)
+		{
+			TRACELOG("  setting outside its store:");
+			TRACELOGLN(item->formName);
+			settingsImageUsable = false;
+			continue;
+		}
+
+		int type = item->settingType;
+
+		settingsSchemaHash = hashSettingsString(settingsSchemaHash, item->formName);
+		settingsSchemaHash = hashSettingsBytes(settingsSchemaHash, &type, sizeof(type));
+		settingsSchemaHash = hashSettingsBytes(settingsSchemaHash, &item->maxLength, sizeof(item->maxLength));
+		settingsSchemaHash = hashSettingsBytes(settingsSchemaHash, &offset, sizeof(offset));
+	}
+}
+
+void calculateSettingsSchemaHash()
+{
+	settingsSchemaHash = 2166136261UL;
+	settingsImageNoOfBlocks = 0;
+	settingsImageUsable = true;
+	iterateThroughProcessSettingStores(hashSettingStore);
+	iterateThroughSensorSettingStores(hashSettingStore);
+}
+
+// passwords are encrypted in the image in the same way as in the text file
+
+void encryptSettingStorePasswords(SettingItemCollection *collection, bool encrypt)
+{
+	if (collection == NULL)
+	{
+		return;
+	}
+
+	char passwordBuffer[SETTING_VALUE_OUTPUT_LENGTH];
+
+	for (int settingNo = 0; settingNo < collection->noOfSettings; settingNo++)
+	{
+		SettingItem *item = collection->settings[settingNo];
+
+		if (item->settingType != password)
+		{
+			continue;
+		}
+
+		int length = item->maxLength < SETTING_VALUE_OUTPUT_LENGTH ? item->maxLength : SETTING_VALUE_OUTPUT_LENGTH;
+
+		if (encrypt)
+		{
+			encryptString(passwordBuffer, length, (char *)item->value);
+		}
+		else
+		{
+			decryptString(passwordBuffer, length, (char *)item->value);
+		}
+
+		// strncpy clears the rest of the value so that the image
+		// doesn't hold the tail of an old password
+		strncpy((char *)item->value, passwordBuffer, item->maxLength);
+	}
+}
+
+void recordSettingStoreCRC(int storeNo, unsigned char *settings, int size)
+{
+	if (storeNo < SETTINGS_MAX_NO_OF_STORES)
+	{
+		settingsStoreCRCs[storeNo] = calculateCRC32(0, settings, size);
+	}
+}
+
+bool settingStoreChanged(int storeNo, unsigned char *settings, int size)
+{
+	if (storeNo >= SETTINGS_MAX_NO_OF_STORES)
+	{
+		return true;
+	}
+
+	return settingsStoreCRCs[storeNo] != calculateCRC32(0, settings, size);
+}
+
+void writeSettingStoreBlock(int storeNo, unsigned char *settings, int size, SettingItemCollection *collection)
+{
+	struct SettingsImageBlockHeader blockHeader;
+
+	encryptSettingStorePasswords(collection, true);
+
+	blockHeader.length = size;
+	blockHeader.crc = calculateCRC32(0, settings, size);
+
+	if (saveFile.write((uint8_t *)&blockHeader, sizeof(blockHeader)) != sizeof(blockHeader))
+	{
+		settingsImageOK = false;
+	}
+	else if (size > 0 && saveFile.write(settings, size) != (size_t)size)
+	{
+		settingsImageOK = false;
+	}
+
+	encryptSettingStorePasswords(collection, false);
+
+	recordSettingStoreCRC(storeNo, settings, size);
+}
+
+void saveSettingStoreToImage(unsigned char *settings, int size, SettingItemCollection *collection)
+{
+	writeSettingStoreBlock(settingsStoreNo++, settings, size, collection);
+}
+
+bool saveAllSettingsToImage(char *path)
+{
+	settingsImageInPlace = false;
+
+	calculateSettingsSchemaHash();
+
+	if (!settingsImageUsable)
+	{
+		return false;
+	}
+
+	TRACELOG("Saving the settings image to the file:");
+	TRACELOGLN(path);
+
+	settingsImageWrites++;
+
+	saveFile = fileOpen(SETTINGS_TEMP_FILENAME, "w");
+
+	if (!saveFile)
+	{
+		TRACELOGLN("  failed to open the file");
+		return false;
+	}
+
+	struct SettingsImageHeader header;
+
+	header.magic = SETTINGS_IMAGE_MAGIC;
+	header.schemaHash = settingsSchemaHash;
+	header.version = SETTINGS_IMAGE_VERSION;
+	header.noOfBlocks = settingsImageNoOfBlocks;
+
+	settingsImageOK = saveFile.write((uint8_t *)&header, sizeof(header)) == sizeof(header);
+	settingsStoreNo = 0;
+
+	iterateThroughProcessSettingStores(saveSettingStoreToImage);
+	iterateThroughSensorSettingStores(saveSettingStoreToImage);
+
+	saveFile.close();
+
+	// the old image is only replaced once the new one is complete, so
+	// a power cut during the write leaves a good image
+
+	if (settingsImageOK)
+	{
+		settingsImageOK = fileRename(SETTINGS_TEMP_FILENAME, path);
+	}
+
+	if (!settingsImageOK)
+	{
+		displayMessage(F("Settings image write failed\n"));
+	}
+
+	settingsImageInPlace = settingsImageOK;
+
+	return settingsImageOK;
+}
+
+void checkSettingStoreInImage(unsigned char *settings, int size, SettingItemCollection * /* collection */)
+{
+	if (settingStoreChanged(settingsStoreNo++, settings, size))
+	{
+		settingsStoreChangeFound = true;
+	}
+}
+
+bool settingsImageChanged()
+{
+	if (!settingsImageInPlace)
+	{
+		return true;
+	}
+
+	settingsStoreChangeFound = false;
+	settingsStoreNo = 0;
+
+	iterateThroughProcessSettingStores(checkSettingStoreInImage);
+	iterateThroughSensorSettingStores(checkSettingStoreInImage);
+
+	return settingsStoreChangeFound;
+}
+
+// Each block is read straight into its settings store and then checked
+
+void loadSettingStoreFromImage(unsigned char *settings, int size, SettingItemCollection *collection)
+{
+	int storeNo = settingsStoreNo++;
+
+	if (!settingsImageOK)
+	{
+		return;
+	}
+
+	struct SettingsImageBlockHeader blockHeader;
+
+	if (loadFile.read((uint8_t *)&blockHeader, sizeof(blockHeader)) != sizeof(blockHeader) ||
+		blockHeader.length != (uint32_t)size)
+	{
+		settingsImageOK = false;
+		return;
+	}
+
+	if (size == 0)
+	{
+		recordSettingStoreCRC(storeNo, settings, size);
+		return;
+	}
+
+	settingsImageBlockLoaded = true;
+
+	if (loadFile.read(settings, size) != (size_t)size ||
+		calculateCRC32(0, settings, size) != blockHeader.crc)
+	{
+		settingsImageOK = false;
+		return;
+	}
+
+	encryptSettingStorePasswords(collection, false);
+
+	recordSettingStoreCRC(storeNo, settings, size);
+}
+
+bool loadAllSettingsFromImage(char *path)
+{
+	calculateSettingsSchemaHash();
+
+	if (!settingsImageUsable)
+	{
+		return false;
+	}
+
+	TRACELOG("Loading the settings image from the file:");
+	TRACELOGLN(path);
+
+	loadFile = fileOpen(path, "r");
+
+	if (!loadFile || loadFile.isDirectory())
+	{
+		TRACELOGLN("  failed to open the file");
+		return false;
+	}
+
+	struct SettingsImageHeader header;
+
+	if (loadFile.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+		header.magic != SETTINGS_IMAGE_MAGIC ||
+		header.version != SETTINGS_IMAGE_VERSION ||
+		header.schemaHash != settingsSchemaHash ||
+		header.noOfBlocks != settingsImageNoOfBlocks)
+	{
+		loadFile.close();
+		TRACELOGLN("  settings layout has changed");
+		return false;
+	}
+
+	settingsImageOK = true;
+	settingsImageBlockLoaded = false;
+	settingsStoreNo = 0;
+
+	iterateThroughProcessSettingStores(loadSettingStoreFromImage);
+	iterateThroughSensorSettingStores(loadSettingStoreFromImage);
+
+	loadFile.close();
+
+	if (!settingsImageOK)
+	{
+		displayMessage(F("Settings image damaged\n"));
+
+		if (settingsImageBlockLoaded)
+		{
+			// start the text file load from known values
+			resetProcessesToDefaultSettings();
+			resetSensorsToDefaultSettings();
+		}
+	}
+
+	settingsImageInPlace = settingsImageOK;
+
+	return settingsImageOK;
+}
+
 void saveSettings()
 {
 	if(settingsStoreStatus != SETTING_STATUS_OK)
@@ -1016,12 +1413,143 @@ void saveSettings()
 		displayMessage(F("Settings store unavailable %d\n"), settingsStoreStatus);
 		return;
 	}
-	saveAllSettingsToFile(SETTINGS_FILENAME);
+
+	settingsSaveRequests++;
+
+	if (!settingsSavePending)
+	{
+		settingsSavePending = true;
+		settingsSaveRequestMillis = millis();
+	}
+}
+
+void flushSettings()
+{
+	if (!settingsSavePending)
+	{
+		return;
+	}
+
+	settingsSavePending = false;
+
+	if(settingsStoreStatus != SETTING_STATUS_OK)
+	{
+		return;
+	}
+
+	settingsFlushes++;
+
+	if (!settingsImageChanged())
+	{
+		return;
+	}
+
+	saveAllSettingsToImage(SETTINGS_IMAGE_FILENAME);
+
+	// The text file is rewritten with any change to the image so that it
+	// is always current. Firmware with a different layout of settings
+	// can't use the image and loads the text file instead. It is also
+	// written to a temporary file first.
+
+	if (saveAllSettingsToFile(SETTINGS_TEMP_FILENAME) && fileRename(SETTINGS_TEMP_FILENAME, SETTINGS_FILENAME))
+	{
+		settingsTextWrites++;
+	}
+}
+
+void updateSettings()
+{
+	if (settingsSavePending &&
+		ulongDiff(millis(), settingsSaveRequestMillis) >= SETTINGS_SAVE_DELAY_MILLIS)
+	{
+		flushSettings();
+	}
+}
+
+unsigned long millisToSettingsSave(unsigned long currentMillis)
+{
+	if (!settingsSavePending)
+	{
+		return IDLE_NO_DEADLINE;
+	}
+
+	unsigned long waitedMillis = ulongDiff(currentMillis, settingsSaveRequestMillis);
+
+	if (waitedMillis >= SETTINGS_SAVE_DELAY_MILLIS)
+	{
+		return 0;
+	}
+
+	return SETTINGS_SAVE_DELAY_MILLIS - waitedMillis;
 }
 
 bool loadSettings()
 {
-	return loadAllSettingsFromFile(SETTINGS_FILENAME);
+	unsigned long startMicros = micros();
+
+	bool result = true;
+
+	if (loadAllSettingsFromImage(SETTINGS_IMAGE_FILENAME))
+	{
+		settingsLoadSource = "image";
+	}
+	else if (loadAllSettingsFromFile(SETTINGS_FILENAME))
+	{
+		settingsLoadSource = "text";
+	}
+	else
+	{
+		settingsLoadSource = "none";
+		result = false;
+	}
+
+	settingsLoadMicros = micros() - startMicros;
+
+	return result;
+}
+
+// Used by the console to bring in a text settings file that has been
+// edited or copied onto the device. The image is rebuilt from it.
+
+bool importSettingsFromFile(char *path)
+{
+	if (!loadAllSettingsFromFile(path))
+	{
+		return false;
+	}
+
+	validateSettings();
+	saveSettings();
+	flushSettings();
+	return true;
+}
+
+// Used by the console to write a copy of the settings as text
+
+bool exportSettingsToFile(char *path)
+{
+	if (settingsStoreStatus != SETTING_STATUS_OK)
+	{
+		return false;
+	}
+
+	if (!saveAllSettingsToFile(path))
+	{
+		return false;
+	}
+
+	settingsTextWrites++;
+	return true;
+}
+
+const char *getSettingsLoadSource()
+{
+	return settingsLoadSource;
+}
+
+unsigned long getSettingsLoadMicros()
+{
+	return settingsLoadMicros;
 }
 
 boolean matchSettingCollectionName(SettingItemCollection *settingCollection, const char *name)
@@ -1212,28 +1740,48 @@ SettingsSetupStatus setupSettings(bool completeReset)
 		}
 	}
 
+	// the store is usable once the file system is mounted, so that
+	// the settings can be saved while they are being set up
+
+	settingsStoreStatus = SETTING_STATUS_OK;
+
+	bindIdleDeadline(millisToSettingsSave);
+	addCounterMetric("settingssaverequests", &settingsSaveRequests);
+	addCounterMetric("settingsflushes", &settingsFlushes);
+	addCounterMetric("settingsimagewrites", &settingsImageWrites);
+	addCounterMetric("settingstextwrites", &settingsTextWrites);
+
 	if(completeReset){
 		displayMessage(F("Complete reset requested\n"));
 		resetSettings();
-		saveSettings();
-		settingsStoreStatus = SETTING_STATUS_OK;
+		flushSettings();
 		return SETTINGS_RESET_TO_DEFAULTS;
 	}
 
 	if (loadSettings())
 	{
-		if(validateSettings()){
-			// returns true if a setting was set to a default value - need to save the settings 
-  		    saveAllSettingsToFile(SETTINGS_FILENAME);
+		// the image was written from validated settings and has been
+		// checked by its CRC so only text settings need validating
+
+		if (strcmp(settingsLoadSource, "text") == 0)
+		{
+			// validateSettings returns true if a setting was set to a default value
+			if (validateSettings())
+			{
+				saveSettings();
+				flushSettings();
+			}
+			else
+			{
+				saveAllSettingsToImage(SETTINGS_IMAGE_FILENAME);
+			}
 		}
-		settingsStoreStatus = SETTING_STATUS_OK;
 		result = SETTINGS_SETUP_OK;
 	}
 	else
 	{
 		resetSettings();
-		saveSettings();
-		settingsStoreStatus = SETTING_STATUS_OK;
+		flushSettings();
 		result = SETTINGS_RESET_TO_DEFAULTS;
 	}
 
@@ -5,6 +5,7 @@
 #include "utils.h"
 
 #include "settingsWebServer.h"
+#include "settingsWebAssets.h"
 #include "settings.h"
 #include "sensors.h"
 #include "processes.h"
@@ -87,67 +88,21 @@ fs_WebServer *server;
 ESP8266WebServer *server;
 #endif
 
-void sendMasterHeader()
-{
-  server->sendContent(F(R"HEADER(
-<html>
-<head>
-<title>Connected Little Boxes</title>
-<style>
-	[type='radio'] {
-		height:2vw; 
-		width:2vw;
-	}
-
-	input {
-		margin: 5px auto;
-		font-size: 3vw;
-		font-family: Arial, Helvetica, sans-serif;
-	}
-
-	p {
-		font-size: 3vw;
-		font-family: Arial, Helvetica, sans-serif;
-	}
-
-	a {
-		font-size: 3vw;
-		font-family: Arial, Helvetica, sans-serif;
-	}
-
-	label {
-		font-size: 3vw;
-		font-family: Arial, Helvetica, sans-serif;
-	}
-
-	input {
-		font-size: 3vw;
-		font-family: Arial, Helvetica, sans-serif;
-	}
-
-	h1 {
-		font-size: 5vw;
-		font-family: Arial, Helvetica, sans-serif;
-	}
-
-	h2 {
-		font-size: 4vw;
-		font-family: Arial, Helvetica, sans-serif;
-	}
-</style>
-</header>
-<body>
-
-)HEADER"));
-}
+// The stylesheet is served gzip compressed from flash as /style.css
+// so the browser can cache it rather than it being sent with each page
 
-void sendMasterFooter()
-{
-  server->sendContent(F(R"FOOTER(
-</body>
-</html>
-)FOOTER"));
-}
+const char settingsPageHead[] PROGMEM =
+    "<!DOCTYPE html>\n"
+    "<html>\n"
+    "<head>\n"
+    "<title>Connected Little Boxes</title>\n"
+    "<link rel='stylesheet' href='/style.css'>\n"
+    "</head>\n"
+    "<body>\n";
+
+const char settingsPageFoot[] PROGMEM =
+    "</body>\n"
+    "</html>\n";
 
 const char *settingsPageHeader =
     "<h1>Settings</h1>"
@@ -160,13 +115,13 @@ const char *homePageHeader = R"HEADER(
 <form id='form' action='%s' method='post'> <!-- configuration short name goes here -->
 )HEADER";
 
-const char *allSettingsPageHeader = R"HEADER(
+const char allSettingsPageHeader[] PROGMEM = R"HEADER(
 <h1>Connected Little Boxes</h1>
 <h2>All Settings</h2> 
 <ul>
 )HEADER";
 
-const char *allSettingsPageFooter = R"FOOTER(
+const char allSettingsPageFooter[] PROGMEM = R"FOOTER(
 </ul>
 <p>
 Select the settings page you want to work with. 
@@ -174,7 +129,7 @@ Select the settings page you want to work with.
 <p><a href = "/">Return to the settings home screen </a></p>
 )FOOTER";
 
-const char *homePageFooter PROGMEM =
+const char homePageFooter[] PROGMEM =
     "<p>"
     "<input type='submit' value='Update'>"
     "</p>"
@@ -185,11 +140,11 @@ const char *homePageFooter PROGMEM =
     "<p>Select the reset link below to reset the device when you have finished.</p>"
     "<a href=reset> reset </a>";
 
-const char settingsPageFooter[] =
+const char settingsPageFooter[] PROGMEM =
     "<input type='submit' value='Update'>"
     "</form>";
 
-const char sensorResetMessage[] =
+const char sensorResetMessage[] PROGMEM =
     "<h1>Connected Little Boxes</h1>"
     "<h2>Reset</h2>"
     "<p>Your device will reset in a few seconds.</p>";
@@ -207,236 +162,257 @@ extern struct SettingItem pixelNoOfYPixelsSetting;
 
 #define SETTING_BUFFER_SIZE 400
 
-char settingBuffer[SETTING_BUFFER_SIZE];
-
 const char replyPageHeader[] =
-    "<html>"
-    "<head>"
-    "<style>input {margin: 5px auto; } </style>"
-    "</head>"
-    "<body>"
     "<h1>%s</h1>"
     "<h2>%s</h2>"; // configuration description goes here
 
-const char replyPageFooter[] =
+const char replyPageFooter[] PROGMEM =
     "<p>Settings updated.</p>"
     "<p><a href = \"/ \">return to the settings home screen </a></p>";
 
-void updateSettings(SettingItemCollection *settingCollection)
+// Pages are written into this buffer straight from the setting
+// descriptors. It is sent as one chunk of the reply each time it fills,
+// so there is no String built on the heap and no network write for each
+// small piece of a page.
+
+char settingsPageChunk[SETTINGS_PAGE_CHUNK_SIZE];
+int settingsPageChunkLength;
+
+unsigned long settingsPageStartMicros;
+int settingsPageBytes;
+int settingsPageChunks;
+uint32_t settingsPageLowestHeap;
+
+void sendSettingsPageChunk()
 {
-  char settingBuffer[SETTING_BUFFER_SIZE];
+  if (settingsPageChunkLength == 0)
+  {
+    return;
+  }
+
+  uint32_t freeHeap = ESP.getFreeHeap();
+
+  if (freeHeap < settingsPageLowestHeap)
+  {
+    settingsPageLowestHeap = freeHeap;
+  }
+
+  server->sendContent(settingsPageChunk, settingsPageChunkLength);
+
+  settingsPageBytes += settingsPageChunkLength;
+  settingsPageChunks++;
+  settingsPageChunkLength = 0;
+}
+
+// pgm_read_byte reads from RAM as well as flash so this is used
+// for both kinds of text
+
+void appendSettingsPageText(const char *text)
+{
+  char ch;
+
+  while ((ch = pgm_read_byte(text++)) != 0)
+  {
+    if (settingsPageChunkLength == SETTINGS_PAGE_CHUNK_SIZE)
+    {
+      sendSettingsPageChunk();
+    }
+    settingsPageChunk[settingsPageChunkLength++] = ch;
+  }
+}
+
+// Formatted text longer than the chunk buffer is cut off, so setting
+// values are added with appendSettingsPageText
+
+void appendSettingsPage(const char *format, ...)
+{
+  va_list args;
+
+  int space = SETTINGS_PAGE_CHUNK_SIZE - settingsPageChunkLength;
+
+  va_start(args, format);
+  int length = vsnprintf(settingsPageChunk + settingsPageChunkLength, space, format, args);
+  va_end(args);
+
+  if (length < 0)
+  {
+    return;
+  }
+
+  if (length < space)
+  {
+    settingsPageChunkLength += length;
+    return;
+  }
+
+  // didn't fit - send the buffer and format the text again at the start
+
+  sendSettingsPageChunk();
+
+  va_start(args, format);
+  length = vsnprintf(settingsPageChunk, SETTINGS_PAGE_CHUNK_SIZE, format, args);
+  va_end(args);
+
+  if (length < 0)
+  {
+    return;
+  }
+
+  if (length >= SETTINGS_PAGE_CHUNK_SIZE)
+  {
+    length = SETTINGS_PAGE_CHUNK_SIZE - 1;
+  }
+
+  settingsPageChunkLength = length;
+}
+
+void beginSettingsPage()
+{
+  settingsPageStartMicros = micros();
+  settingsPageLowestHeap = ESP.getFreeHeap();
+  settingsPageChunkLength = 0;
+  settingsPageBytes = 0;
+  settingsPageChunks = 0;
 
   server->chunkedResponseModeStart(200, F("text/html"));
 
-  sendMasterHeader();
+  appendSettingsPageText(settingsPageHead);
+}
+
+void endSettingsPage(const char *pageName)
+{
+  appendSettingsPageText(settingsPageFoot);
 
-  snprintf(settingBuffer, SETTING_BUFFER_SIZE, replyPageHeader,
-           settingCollection->collectionDescription,
-           settingCollection->collectionName);
+  sendSettingsPageChunk();
+
+  server->chunkedResponseFinalize();
+
+  displayMessage(F("Sent %s page: %d bytes in %d chunks in %lu micros lowest heap %lu\n"),
+                 pageName, settingsPageBytes, settingsPageChunks,
+                 ulongDiff(micros(), settingsPageStartMicros), (unsigned long)settingsPageLowestHeap);
+}
+
+void updateSettingsFromForm(SettingItemCollection *settingCollection)
+{
+  beginSettingsPage();
 
-  server->sendContent(settingBuffer);
+  appendSettingsPage(replyPageHeader,
+                     settingCollection->collectionDescription,
+                     settingCollection->collectionName);
 
   for (int i = 0; i < settingCollection->noOfSettings; i++)
   {
-    String fName = String(settingCollection->settings[i]->formName);
-    String argValue = server->arg(fName);
+    SettingItem *item = settingCollection->settings[i];
 
-    if (settingCollection->settings[i]->validateValue(
-            settingCollection->settings[i]->value,
-            argValue.c_str()))
+    String argValue = server->arg(item->formName);
+
+    if (item->validateValue(item->value, argValue.c_str()))
     {
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<p>Set %s</p> ",
-               settingCollection->settings[i]->prompt);
+      appendSettingsPage("<p>Set %s</p> ", item->prompt);
     }
     else
     {
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<p>Invalid value %s for %s</p> ",
-               argValue.c_str(), settingCollection->settings[i]->prompt);
+      appendSettingsPageText("<p>Invalid value ");
+      appendSettingsPageText(argValue.c_str());
+      appendSettingsPage(" for %s</p> ", item->prompt);
     }
-    server->sendContent(settingBuffer);
   }
 
   saveSettings();
 
-  server->sendContent(replyPageFooter);
-
-  sendMasterFooter();
+  appendSettingsPageText(replyPageFooter);
 
-  server->chunkedResponseFinalize();
+  endSettingsPage(settingCollection->collectionName);
 }
 
 void sendPageText(const char *text)
 {
-  server->chunkedResponseModeStart(200, F("text/html"));
+  beginSettingsPage();
 
-  sendMasterHeader();
+  appendSettingsPageText(text);
 
-  server->sendContent(text);
-
-  sendMasterFooter();
-
-  server->chunkedResponseFinalize();
+  endSettingsPage("text");
 }
 
-void sendCollectionSettingsPage(SettingItemCollection *settingCollection, const char *header, const char *footer)
+void appendSettingInput(SettingItem *item)
 {
-  int *intPointer;
-  float *floatPointer;
-  double *doublePointer;
-  boolean *boolPointer;
-  uint32_t *loraIDValuePointer;
-  char loraKeyBuffer[LORA_KEY_LENGTH * 2 + 1];
-
-  char *checked = "checked";
-  char *empty = "";
-  char *yesChecked;
-  char *noChecked;
+  char valueBuffer[SETTING_VALUE_OUTPUT_LENGTH];
 
-  char settingBuffer[SETTING_BUFFER_SIZE];
+  appendSettingsPage("<label for='%s'>%s</label> ", item->formName, item->prompt);
 
-  server->chunkedResponseModeStart(200, F("text/html"));
+  switch (item->settingType)
+  {
+  case yesNo:
+  {
+    bool value = *(boolean *)item->value;
+    appendSettingsPage("<input name='%s' id='%syes' type='radio' value='yes' %s><label for='%syes'>Yes</label>",
+                       item->formName, item->formName, value ? "checked" : "", item->formName);
+    appendSettingsPage("<input name='%s' id='%sno' type='radio' value='no' %s><label for='%sno'>No</label><br>",
+                       item->formName, item->formName, value ? "" : "checked", item->formName);
+    return;
+  }
 
-  sendMasterHeader();
+  case text:
+    appendSettingsPage("<input name='%s' id='%s' type='text' value='", item->formName, item->formName);
+    appendSettingsPageText((char *)item->value);
+    break;
 
-  snprintf(settingBuffer, SETTING_BUFFER_SIZE, header,
-           settingCollection->collectionDescription,
-           settingCollection->collectionName);
+  case password:
+    appendSettingsPage("<input name='%s' id='%s' type='password' value='", item->formName, item->formName);
+    appendSettingsPageText((char *)item->value);
+    break;
 
-  server->sendContent(settingBuffer);
+  default:
+    // numbers and lora values are short enough for the value buffer
+    printSettingValue(item, valueBuffer, SETTING_VALUE_OUTPUT_LENGTH);
+    appendSettingsPage("<input name='%s' id='%s' type='text' value='", item->formName, item->formName);
+    appendSettingsPageText(valueBuffer);
+    break;
+  }
+
+  appendSettingsPageText("'><br>");
+}
+
+void sendCollectionSettingsPage(SettingItemCollection *settingCollection, const char *header, const char *footer)
+{
+  beginSettingsPage();
+
+  appendSettingsPage(header,
+                     settingCollection->collectionDescription,
+                     settingCollection->collectionName);
 
-  // Start the search at setting collection 0 so that the quick settings are used to build the web page
   for (int i = 0; i < settingCollection->noOfSettings; i++)
   {
-    char *formName = settingCollection->settings[i]->formName;
-    char *prompt = settingCollection->settings[i]->prompt;
-    void *valueRef = settingCollection->settings[i]->value;
-
-    switch (settingCollection->settings[i]->settingType)
-    {
-    case text:
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%s'>%s</label> ",
-               formName, prompt);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name='%s' id='%s' type ='text' value='%s' style='margin-left: 20px; line-height: 50%%'><br>",
-               formName, formName, (char *)valueRef);
-      server->sendContent(settingBuffer);
-      break;
-    case password:
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%s'>%s</label> ",
-               formName, prompt);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name='%s' id='%s' type='password' value='%s' style='margin-left: 20px; line-height: 50%%'><br>",
-               formName, formName, (char *)valueRef);
-      server->sendContent(settingBuffer);
-      break;
-    case integerValue:
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%s'>%s</label> ",
-               formName, prompt);
-      server->sendContent(settingBuffer);
-      intPointer = (int *)valueRef;
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name='%s' id='%s' type='text' value='%d' style='margin-left: 20px; line-height: 50%%''><br>",
-               formName, formName, *intPointer);
-      server->sendContent(settingBuffer);
-      break;
-    case floatValue:
-      floatPointer = (float *)valueRef;
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%s'>%s</label> ",
-               formName, prompt);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name='%s' id='%s' type='text' value='%f' style='margin-left: 20px; line-height: 50%%'><br>",
-               formName, formName, *floatPointer);
-      server->sendContent(settingBuffer);
-      break;
-    case doubleValue:
-      doublePointer = (double *)valueRef;
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%s'>%s</label> ",
-               formName, prompt);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name='%s' id='%s' type='text' value='%lf' style='margin-left: 20px; line-height: 50%%'><br>",
-               formName, formName, *doublePointer);
-      server->sendContent(settingBuffer);
-      break;
-    case yesNo:
-      doublePointer = (double *)valueRef;
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%s'>%s</label> ",
-               formName, prompt);
-      server->sendContent(settingBuffer);
-      boolPointer = (boolean *)valueRef;
-      if (*boolPointer)
-      {
-        yesChecked = checked;
-        noChecked = empty;
-      }
-      else
-      {
-        yesChecked = empty;
-        noChecked = checked;
-      }
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name = '%s' id = '%syes' type = 'radio' value='yes' style='margin-left:40px' %s>",
-               formName, formName, yesChecked);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%syes'>Yes</label>",
-               formName);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name = '%s' id = '%sno' type = 'radio' value='no' style='margin-left:40px' %s>",
-               formName, formName, noChecked);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%sno'>No</label><br>",
-               formName);
-      server->sendContent(settingBuffer);
-      break;
-
-    case loraKey:
-      dumpHexString(loraKeyBuffer, (uint8_t *)valueRef, LORA_KEY_LENGTH);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%s'>%s</label> ",
-               formName, prompt);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name='%s' id='%s' type='text' value='%s'><br>",
-               formName, formName, loraKeyBuffer);
-      server->sendContent(settingBuffer);
-      break;
-
-    case loraID:
-      loraIDValuePointer = (uint32_t *)valueRef;
-      dumpUnsignedLong(loraKeyBuffer, *loraIDValuePointer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<label for='%s'>%s</label> ",
-               formName, prompt);
-      server->sendContent(settingBuffer);
-      snprintf(settingBuffer, SETTING_BUFFER_SIZE, "<input name='%s' id='%s' type='text' value='%s'><br>",
-               formName, formName, loraKeyBuffer);
-      server->sendContent(settingBuffer);
-      break;
-    }
+    appendSettingInput(settingCollection->settings[i]);
   }
 
-  server->sendContent(footer);
-
-  sendMasterFooter();
+  appendSettingsPageText(footer);
 
-  server->chunkedResponseFinalize();
+  endSettingsPage(settingCollection->collectionName);
 }
 
 void addItem(SettingItemCollection *settings)
 {
-  // messageLogf("    %s %s\n", settings->collectionName, settings->collectionDescription);
-  char settingBuffer[SETTING_BUFFER_SIZE];
-  snprintf(settingBuffer, SETTING_BUFFER_SIZE,
-           "<li><a href='%s'>%s</a></li>\n",
-           settings->collectionName,
-           settings->collectionDescription);
-  server->sendContent(settingBuffer);
+  appendSettingsPage("<li><a href='%s'>%s</a></li>\n",
+                     settings->collectionName,
+                     settings->collectionDescription);
 }
 
 void sendFullSettingsHomePage()
 {
-  server->chunkedResponseModeStart(200, F("text/html"));
-  sendMasterHeader();
-  server->sendContent(allSettingsPageHeader);
+  beginSettingsPage();
+  appendSettingsPageText(allSettingsPageHeader);
   iterateThroughProcessSettingCollections(addItem);
   iterateThroughSensorSettingCollections(addItem);
-  server->sendContent(allSettingsPageFooter);
-  sendMasterFooter();
-  server->chunkedResponseFinalize();
+  appendSettingsPageText(allSettingsPageFooter);
+  endSettingsPage("full");
+}
+
+void handleStyleSheet()
+{
+  server->sendHeader(F("Content-Encoding"), F("gzip"));
+  server->sendHeader(F("Cache-Control"), F("max-age=86400"));
+  server->send_P(200, PSTR("text/css"), (PGM_P)settingsWebStyleGzip, SETTINGS_WEB_STYLE_GZIP_LENGTH);
 }
 
 struct SettingItem *quickSettingPointers[] = {
@@ -453,8 +429,6 @@ struct SettingItemCollection QuickSettingItems = {
     quickSettingPointers,
     sizeof(quickSettingPointers) / sizeof(struct SettingItem *)};
 
-String bigChunk;
-
 bool timeoutActive;
 
 void handleRoot()
@@ -524,7 +498,7 @@ void handleNotFound()
     else
     {
       // update the settings from the POST
-      updateSettings(items);
+      updateSettingsFromForm(items);
     }
   }
   else
@@ -590,6 +564,8 @@ void startHostingConfigWebsite(bool timeout)
 
   server->on("/", handleRoot);
 
+  server->on("/style.css", handleStyleSheet);
+
   server->on("/inline", []()
              { server->send(200, "text/plain", "this works as well"); });
 
@@ -616,6 +592,9 @@ void startHostingConfigWebsite(bool timeout)
     
     consoleProcessDescriptor.udpateProcess();
 
+    // this loop replaces the main loop so it saves the settings
+    updateSettings();
+
 #if defined(ARDUINO_ARCH_ESP8266)
     MDNS.update();
 #endif
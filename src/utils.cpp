@@ -43,6 +43,26 @@ unsigned long ulongDiff(unsigned long end, unsigned long start)
     }
 }
 
+// Standard CRC-32 (as used by zip). Pass the result of the previous call
+// as crc to continue a calculation over several blocks, 0 to start one.
+
+uint32_t calculateCRC32(uint32_t crc, const uint8_t *data, int length)
+{
+    crc = ~crc;
+
+    for (int i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
+
 bool strContains(char *searchMe, char *findMe)
 {
     while (*searchMe != 0)
@@ -160,18 +180,17 @@ void getProcID (char * dest, int length)
 {
 #if defined(ESP32DOIT)
     snprintf(dest, length, "%06lx", (unsigned long)ESP.getEfuseMac());
-#endif
-
-#if defined(WEMOSD1MINI)
+#elif defined(WEMOSD1MINI)
     snprintf(dest, length, "%06lx", (unsigned long)ESP.getChipId());
-#endif
-
-#if defined(PICO)
+#elif defined(PICO)
 	char id_buffer [(2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES) + 1];
 
 	pico_get_unique_board_id_string(id_buffer,(2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES) + 1);
 
 	snprintf(dest, length, "%s", id_buffer);
+#else
+    // no chip id, as in the host tests
+    snprintf(dest, length, "000000");
 #endif
 }
 
@@ -180,23 +199,23 @@ unsigned long getProcIDSalt()
 
 #if defined(ESP32DOIT)
     return (unsigned long)ESP.getEfuseMac();
-#endif
-
-#if defined(WEMOSD1MINI)
+#elif defined(WEMOSD1MINI)
    return (unsigned long)ESP.getChipId();
-#endif
-
-#if defined(PICO)
+#elif defined(PICO)
     int bufferLength = (2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES) + 1;
 	char id_buffer [(2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES) + 1];
     unsigned long result = 0;
 
+	pico_get_unique_board_id_string(id_buffer,bufferLength);
+
     for(int i=0;i<(2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES);i++)
     {
         result = result + id_buffer[i];
     }
 
     return result;
+#else
+    return 0;
 #endif
 
 }
@@ -253,6 +272,27 @@ File fileOpen(const char * path, char * mode){
 #endif
 }
 
+// LittleFS replaces the destination in one step, so a reader sees either
+// the old file or the new one
+
+bool fileRename(const char * from, const char * to){
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+    char fromBuff [REMOTE_FILENAME_BUFFER_SIZE+1];
+    char toBuff [REMOTE_FILENAME_BUFFER_SIZE+1];
+
+    snprintf(fromBuff,REMOTE_FILENAME_BUFFER_SIZE+1,"/%s",from);
+    snprintf(toBuff,REMOTE_FILENAME_BUFFER_SIZE+1,"/%s",to);
+
+    return LittleFS.rename(fromBuff,toBuff);
+
+#else
+
+    return LittleFS.rename(from,to);
+
+#endif
+}
 
 void saveToFile(char * path, char * src){
 
@@ -0,0 +1,46 @@
+#include <Arduino.h>
+#include <LittleFS.h>
+
+unsigned long hostMicros = 0;
+int hostPinLevels[HOST_NO_OF_PINS];
+void (*hostDelayHook)(unsigned long delayMillis) = NULL;
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+EspClass ESP;
+FS LittleFS;
+long hostFileWriteBudget = -1;
+
+void hostAdvanceMillis(unsigned long millisToAdd)
+{
+	hostMicros += millisToAdd * 1000;
+}
+
+unsigned long millis() { return hostMicros / 1000; }
+unsigned long micros() { return hostMicros; }
+
+void delay(unsigned long ms)
+{
+	hostAdvanceMillis(ms);
+	if (hostDelayHook != NULL)
+	{
+		hostDelayHook(ms);
+	}
+}
+
+void delayMicroseconds(unsigned int us) { hostMicros += us; }
+void yield() {}
+
+void pinMode(int /* pin */, int /* mode */) {}
+void digitalWrite(int pin, int level) { hostPinLevels[pin] = level; }
+int digitalRead(int pin) { return hostPinLevels[pin]; }
+int analogRead(int /* pin */) { return 0; }
+int digitalPinToInterrupt(int pin) { return pin; }
+void attachInterrupt(int /* interrupt */, void (*)(), int /* mode */) {}
+void detachInterrupt(int /* interrupt */) {}
+void noInterrupts() {}
+void interrupts() {}
+
+long random(long high) { return high > 0 ? rand() % high : 0; }
+long random(long low, long high) { return high > low ? low + rand() % (high - low) : low; }
+void randomSeed(unsigned long seed) { srand(seed); }
@@ -0,0 +1,149 @@
+// The fake MQTT broker behind the WiFi and PubSubClient shims.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+
+WiFiClass WiFi;
+
+struct hostBrokerState hostBroker;
+
+void hostBrokerReset()
+{
+	memset(&hostBroker, 0, sizeof(hostBroker));
+	hostBroker.behaviour.acceptNetwork = true;
+	hostBroker.behaviour.sessionResult = MQTT_CONNECTED;
+	WiFi.wifiStatus = WL_CONNECTED;
+}
+
+int WiFiClient::connect(const char * /* host */, uint16_t /* port */)
+{
+	hostBroker.networkConnects++;
+
+	if (!hostBroker.behaviour.acceptNetwork)
+	{
+		// a refused or unanswered connection waits for the timeout
+		hostAdvanceMillis(timeoutMillis);
+		return 0;
+	}
+
+	hostAdvanceMillis(hostBroker.behaviour.networkDelayMillis);
+	isConnected = true;
+	return 1;
+}
+
+uint8_t WiFiClient::connected()
+{
+	return isConnected;
+}
+
+void WiFiClient::stop()
+{
+	isConnected = false;
+	hostBroker.sessionOpen = false;
+}
+
+boolean PubSubClient::connect(const char * /* id */, const char * /* user */, const char * /* pass */)
+{
+	hostBroker.sessionConnects++;
+	hostAdvanceMillis(hostBroker.behaviour.sessionDelayMillis);
+
+	if (!client->connected())
+	{
+		clientState = MQTT_CONNECT_FAILED;
+		return false;
+	}
+
+	clientState = hostBroker.behaviour.sessionResult;
+
+	if (clientState != MQTT_CONNECTED)
+	{
+		client->stop();
+		return false;
+	}
+
+	hostBroker.sessionOpen = true;
+	return true;
+}
+
+void PubSubClient::disconnect()
+{
+	clientState = MQTT_DISCONNECTED;
+	client->stop();
+}
+
+boolean PubSubClient::publish(const char *topic, const uint8_t *payload, unsigned int length)
+{
+	hostMicros += hostBroker.behaviour.publishDelayMicros;
+
+	if (!connected() || hostBroker.behaviour.refusePublish)
+	{
+		return false;
+	}
+
+	if (hostBroker.noOfPublished < HOST_BROKER_MAX_PUBLISHED)
+	{
+		struct hostBrokerMessage *message = &hostBroker.published[hostBroker.noOfPublished];
+		snprintf(message->topic, HOST_BROKER_TOPIC_LENGTH, "%s", topic);
+		message->length = length < HOST_BROKER_PAYLOAD_LENGTH ? length : HOST_BROKER_PAYLOAD_LENGTH - 1;
+		memcpy(message->payload, payload, message->length);
+		message->payload[message->length] = 0;
+	}
+
+	hostBroker.noOfPublished++;
+
+	if (hostBroker.onPublish != NULL)
+	{
+		hostBroker.onPublish(topic, (const char *)payload, length);
+	}
+	return true;
+}
+
+boolean PubSubClient::subscribe(const char * /* topic */)
+{
+	hostBroker.subscribes++;
+	return connected();
+}
+
+bool hostBrokerSend(const char *topic, const char *payload)
+{
+	if (hostBroker.inboundCount == HOST_BROKER_MAX_INBOUND)
+	{
+		return false;
+	}
+
+	int slot = (hostBroker.inboundHead + hostBroker.inboundCount) % HOST_BROKER_MAX_INBOUND;
+	struct hostBrokerMessage *message = &hostBroker.inbound[slot];
+	snprintf(message->topic, HOST_BROKER_TOPIC_LENGTH, "%s", topic);
+	snprintf(message->payload, HOST_BROKER_PAYLOAD_LENGTH, "%s", payload);
+	message->length = strlen(message->payload);
+	hostBroker.inboundCount++;
+	return true;
+}
+
+// like the real client, everything that has arrived is passed to the
+// callback in one loop call
+
+boolean PubSubClient::loop()
+{
+	if (hostBroker.behaviour.dropConnection)
+	{
+		hostBroker.behaviour.dropConnection = false;
+		clientState = MQTT_CONNECTION_LOST;
+		client->stop();
+	}
+
+	while (connected() && hostBroker.inboundCount > 0)
+	{
+		struct hostBrokerMessage *message = &hostBroker.inbound[hostBroker.inboundHead];
+		hostBroker.inboundHead = (hostBroker.inboundHead + 1) % HOST_BROKER_MAX_INBOUND;
+		hostBroker.inboundCount--;
+
+		if (callback != NULL)
+		{
+			callback(message->topic, (uint8_t *)message->payload, message->length);
+		}
+	}
+
+	return connected();
+}
@@ -0,0 +1,223 @@
+// Weak stand-ins for the firmware modules that a host test doesn't link.
+// A test that links the real module gets the real function.
+
+#include <Arduino.h>
+
+#include "hostTest.h"
+#include "messages.h"
+#include "metrics.h"
+#include "idle.h"
+#include "sensors.h"
+#include "connectwifi.h"
+#include "console.h"
+#include "boot.h"
+
+#define HOST_WEAK __attribute__((weak))
+
+int hostChecks = 0;
+int hostFailures = 0;
+
+// set to see the messages that the firmware displays
+bool hostShowMessages = getenv("HOST_SHOW_MESSAGES") != NULL;
+
+int hostTestResult(const char *testName)
+{
+	printf("%s: %d checks, %d failed\n", testName, hostChecks, hostFailures);
+	return hostFailures == 0 ? 0 : 1;
+}
+
+static void showMessage(const char *format, va_list args)
+{
+	if (hostShowMessages)
+	{
+		vprintf(format, args);
+	}
+}
+
+HOST_WEAK void displayMessage(const __FlashStringHelper *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	showMessage((const char *)format, args);
+	va_end(args);
+}
+
+HOST_WEAK void displayMessage(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	showMessage(format, args);
+	va_end(args);
+}
+
+HOST_WEAK void displayMessage(const String &s)
+{
+	if (hostShowMessages)
+		printf("%s", s.c_str());
+}
+
+HOST_WEAK void displayMessageWithNewline(const __FlashStringHelper *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	showMessage((const char *)format, args);
+	va_end(args);
+	if (hostShowMessages)
+		printf("\n");
+}
+
+HOST_WEAK void displayMessageWithNewline(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	showMessage(format, args);
+	va_end(args);
+	if (hostShowMessages)
+		printf("\n");
+}
+
+HOST_WEAK void displayMessageWithNewline(const String &s)
+{
+	if (hostShowMessages)
+		printf("%s\n", s.c_str());
+}
+
+HOST_WEAK void logMessage(int /* level */, int /* module */, const __FlashStringHelper *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	showMessage((const char *)format, args);
+	va_end(args);
+}
+
+HOST_WEAK bool addCounterMetric(const char * /* name */, unsigned long * /* counter */) { return true; }
+HOST_WEAK bool addGaugeMetric(const char * /* name */, long (*)()) { return true; }
+HOST_WEAK bool addHistogramMetric(const char * /* name */, struct metricHistogram * /* histogram */) { return true; }
+HOST_WEAK void recordMetricHistogram(struct metricHistogram * /* histogram */, unsigned long /* value */) {}
+
+HOST_WEAK void setFalse(void *dest) { *(boolean *)dest = false; }
+HOST_WEAK void setTrue(void *dest) { *(boolean *)dest = true; }
+
+HOST_WEAK boolean validateYesNo(void *dest, const char *newValueStr)
+{
+	if (strcasecmp(newValueStr, "yes") == 0)
+	{
+		*(boolean *)dest = true;
+		return true;
+	}
+	if (strcasecmp(newValueStr, "no") == 0)
+	{
+		*(boolean *)dest = false;
+		return true;
+	}
+	return false;
+}
+
+HOST_WEAK boolean validateInt(void *dest, const char *newValueStr)
+{
+	int value;
+	if (sscanf(newValueStr, "%d", &value) == 1)
+	{
+		*(int *)dest = value;
+		return true;
+	}
+	return false;
+}
+
+HOST_WEAK boolean validateFloat(void *dest, const char *newValueStr)
+{
+	float value;
+	if (sscanf(newValueStr, "%f", &value) == 1)
+	{
+		*(float *)dest = value;
+		return true;
+	}
+	return false;
+}
+
+HOST_WEAK boolean validateString(char *dest, const char *source, unsigned int maxLength)
+{
+	if (strlen(source) > (maxLength - 1))
+		return false;
+	strcpy(dest, source);
+	return true;
+}
+
+HOST_WEAK boolean validateServerName(void *dest, const char *newValueStr)
+{
+	return validateString((char *)dest, newValueStr, SERVER_NAME_LENGTH);
+}
+
+HOST_WEAK void hardwareDisplayMessage(int /* messageNumber */, ledFlashBehaviour /* severity */, char *messageText)
+{
+	if (hostShowMessages)
+		printf("%s\n", messageText);
+}
+
+HOST_WEAK bool bindIdleDeadline(unsigned long (*)(unsigned long currentMillis)) { return true; }
+
+HOST_WEAK int performCommandsInStore(char * /* commandStoreName */) { return 0; }
+
+HOST_WEAK void sendMessageToConsole(char *message)
+{
+	if (hostShowMessages)
+		printf("%s\n", message);
+}
+
+HOST_WEAK void act_onJson_message(const char * /* json */, void (*)(char *resultText)) {}
+
+// the WiFi process is up unless a test says otherwise
+
+HOST_WEAK struct process WiFiProcessDescriptor = {
+	"WiFi",
+	NULL, NULL, NULL, NULL, NULL, NULL,
+	false,
+	WIFI_OK,
+	0,
+	0,
+	NULL,
+	NULL, 0, NULL,
+	NULL,
+	0,
+	NULL,
+	NULL,
+	NULL,
+	NULL, // no command options
+	0	  // no command options
+};
+
+HOST_WEAK unsigned long getWiFiConnectStartMillis() { return 0; }
+
+HOST_WEAK int createSensorTelemetry(char * /* name */, char * /* buffer */, int /* bufferLength */, sensorTelemetryEncoding /* encoding */, bool /* changedOnly */)
+{
+	return 0;
+}
+
+HOST_WEAK bool sensorReadingsChanged() { return false; }
+HOST_WEAK void markSensorReadingsTransmitted() {}
+
+HOST_WEAK boolean matchSettingName(SettingItem *setting, const char *name)
+{
+	return strcasecmp(setting->formName, name) == 0;
+}
+
+HOST_WEAK void printSetting(SettingItem * /* item */) {}
+
+HOST_WEAK void recordBootFirstWork(const char * /* workName */) {}
+
+// passwords are stored as they are on the host
+
+HOST_WEAK void encryptString(char *destination, int destLength, char *source)
+{
+	snprintf(destination, destLength, "%s", source);
+}
+
+HOST_WEAK void decryptString(char *destination, int destLength, char *source)
+{
+	snprintf(destination, destLength, "%s", source);
+}
+
+HOST_WEAK struct BootSettings bootSettings;
+HOST_WEAK struct MessagesSettings messagesSettings;
+
+HOST_WEAK void performRemoteCommand(char * /* commandLine */) {}
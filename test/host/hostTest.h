@@ -0,0 +1,22 @@
+#pragma once
+
+// Minimal checks for the host tests. Each failed check is reported and the
+// test program exits with a non-zero status from hostTestResult.
+
+#include <stdio.h>
+
+extern int hostChecks;
+extern int hostFailures;
+
+#define CHECK(condition)                                                      \
+	do                                                                        \
+	{                                                                         \
+		hostChecks++;                                                         \
+		if (!(condition))                                                     \
+		{                                                                     \
+			hostFailures++;                                                   \
+			printf("  FAILED %s:%d %s\n", __FILE__, __LINE__, #condition);    \
+		}                                                                     \
+	} while (0)
+
+int hostTestResult(const char *testName);
@@ -0,0 +1,21 @@
+#pragma once
+
+// A stand-in for the Adafruit BME280 library. The test sets the values
+// that the sensor reads, as it would see them in the room.
+
+#include <Arduino.h>
+
+class Adafruit_BME280
+{
+public:
+	bool fitted = true;
+	float temperature = 20;
+	float humidity = 50;
+	// in pascals, as the library gives it
+	float pressure = 101300;
+
+	bool begin(uint8_t /* address */) { return fitted; }
+	float readTemperature() { return fitted ? temperature : NAN; }
+	float readHumidity() { return humidity; }
+	float readPressure() { return pressure; }
+};
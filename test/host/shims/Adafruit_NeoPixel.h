@@ -0,0 +1,54 @@
+#pragma once
+
+// A stand-in for the NeoPixel library. The pixels are held in memory so
+// that a test can read back what would have been sent to the strip.
+
+#include <Arduino.h>
+
+#define NEO_RGB ((0 << 6) | (0 << 4) | (1 << 2) | (2))
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+#define NEO_KHZ400 0x0100
+
+typedef uint16_t neoPixelType;
+
+class Adafruit_NeoPixel
+{
+public:
+	uint16_t numLEDs;
+	int bytesPerPixel;
+	uint8_t *pixels;
+	uint8_t rOffset;
+	uint8_t gOffset;
+	uint8_t bOffset;
+	unsigned long noOfShows = 0;
+
+	Adafruit_NeoPixel(uint16_t n, int16_t /* pin */ = 6, neoPixelType type = NEO_GRB + NEO_KHZ800)
+	{
+		numLEDs = n;
+		bytesPerPixel = 3;
+		pixels = new uint8_t[n * 3]();
+		rOffset = (type >> 4) & 3;
+		gOffset = (type >> 2) & 3;
+		bOffset = type & 3;
+	}
+
+	~Adafruit_NeoPixel() { delete[] pixels; }
+
+	void begin() {}
+	void show() { noOfShows++; }
+	void clear() { memset(pixels, 0, numLEDs * bytesPerPixel); }
+	void setBrightness(uint8_t /* brightness */) {}
+	uint16_t numPixels() const { return numLEDs; }
+	uint8_t *getPixels() const { return pixels; }
+
+	void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b)
+	{
+		if (n >= numLEDs)
+			return;
+		uint8_t *p = &pixels[n * bytesPerPixel];
+		p[rOffset] = r;
+		p[gOffset] = g;
+		p[bOffset] = b;
+	}
+};
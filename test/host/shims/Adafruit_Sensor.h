@@ -0,0 +1,3 @@
+#pragma once
+
+// only included by the Adafruit BME280 library
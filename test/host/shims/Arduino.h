@@ -0,0 +1,196 @@
+#pragma once
+
+// Just enough of the Arduino core to build firmware modules on the host.
+// The clock only moves when a test advances it or when delay is called.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <ctype.h>
+#include <string>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper *)(s))
+#define PSTR(s) (s)
+#define PROGMEM
+typedef const char *PGM_P;
+#define strncpy_P strncpy
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strcasecmp_P strcasecmp
+#define vsnprintf_P vsnprintf
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_byte_near(p) (*(const uint8_t *)(p))
+#define IRAM_ATTR
+
+#define HEX 16
+#define DEC 10
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define LED_BUILTIN 2
+#define CHANGE 1
+#define RISING 2
+#define FALLING 3
+
+#define HOST_NO_OF_PINS 40
+
+extern unsigned long hostMicros;
+extern int hostPinLevels[HOST_NO_OF_PINS];
+
+// called from delay so that a test can change inputs part way through a sleep
+extern void (*hostDelayHook)(unsigned long delayMillis);
+
+void hostAdvanceMillis(unsigned long millisToAdd);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int level);
+int digitalRead(int pin);
+int analogRead(int pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*handler)(), int mode);
+void detachInterrupt(int interrupt);
+void noInterrupts();
+void interrupts();
+
+long random(long high);
+long random(long low, long high);
+void randomSeed(unsigned long seed);
+
+class String
+{
+public:
+	std::string s;
+
+	String() {}
+	String(const char *text) : s(text ? text : "") {}
+	String(const __FlashStringHelper *text) : s((const char *)text) {}
+	String(const std::string &text) : s(text) {}
+	String(char c) : s(1, c) {}
+	String(int value) : s(std::to_string(value)) {}
+	String(unsigned int value) : s(std::to_string(value)) {}
+	String(long value) : s(std::to_string(value)) {}
+	String(unsigned long value) : s(std::to_string(value)) {}
+	String(double value) : s(std::to_string(value)) {}
+
+	const char *c_str() const { return s.c_str(); }
+	unsigned int length() const { return s.length(); }
+	char operator[](unsigned int i) const { return s[i]; }
+	char &operator[](unsigned int i) { return s[i]; }
+
+	String &operator+=(const String &other)
+	{
+		s += other.s;
+		return *this;
+	}
+	String &operator+=(const char *other)
+	{
+		s += other;
+		return *this;
+	}
+	String &operator+=(char c)
+	{
+		s += c;
+		return *this;
+	}
+
+	bool operator==(const String &other) const { return s == other.s; }
+	bool operator==(const char *other) const { return s == other; }
+	bool operator!=(const char *other) const { return s != other; }
+
+	void toCharArray(char *buffer, unsigned int length) const
+	{
+		snprintf(buffer, length, "%s", s.c_str());
+	}
+
+	int toInt() const { return atoi(s.c_str()); }
+};
+
+inline String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+inline String operator+(const char *a, const String &b) { return String(std::string(a) + b.s); }
+
+class Print
+{
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t /* c */) { return 1; }
+	virtual size_t write(const uint8_t * /* buffer */, size_t size) { return size; }
+	size_t print(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+	size_t print(const String &text) { return print(text.c_str()); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(int value, int /* base */ = DEC) { return print(String(value)); }
+	size_t print(unsigned long value, int /* base */ = DEC) { return print(String(value)); }
+	size_t print(double value) { return print(String(value)); }
+	size_t println(const char *text = "") { return print(text) + print('\n'); }
+	size_t println(const String &text) { return println(text.c_str()); }
+	size_t println(int value, int /* base */ = DEC) { return print(value) + print('\n'); }
+	int printf(const char *format, ...)
+	{
+		char buffer[256];
+		va_list args;
+		va_start(args, format);
+		int length = vsnprintf(buffer, sizeof(buffer), format, args);
+		va_end(args);
+		print(buffer);
+		return length;
+	}
+	void flush() {}
+};
+
+class HardwareSerial : public Print
+{
+public:
+	// everything written to the port, for the tests to check
+	std::string written;
+
+	size_t write(uint8_t c) override
+	{
+		written += (char)c;
+		return 1;
+	}
+	size_t write(const uint8_t *buffer, size_t size) override
+	{
+		written.append((const char *)buffer, size);
+		return size;
+	}
+	void begin(unsigned long) {}
+	int available() { return 0; }
+	int read() { return -1; }
+	int availableForWrite() { return 128; }
+	operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+class EspClass
+{
+public:
+	uint32_t getFreeHeap() { return 40000; }
+	uint32_t getChipId() { return 0x123456; }
+	void restart() {}
+};
+
+extern EspClass ESP;
+
+// settings.cpp has a version of these for each device and none for the
+// host, so the stand-ins in hostStubs.cpp are declared here
+void encryptString(char *destination, int destLength, char *source);
+void decryptString(char *destination, int destLength, char *source);
@@ -0,0 +1,6 @@
+#pragma once
+
+// The trace macros are not used by the host tests
+
+#define TRACE()
+#define DUMP(variable)
@@ -0,0 +1,3 @@
+#pragma once
+
+// settings.cpp includes EEPROM.h but keeps its settings in files
@@ -0,0 +1,146 @@
+#pragma once
+
+// An in-memory file system so that the settings code can be run on the host
+
+#include "Arduino.h"
+
+#include <map>
+#include <memory>
+
+// A power cut in the middle of writing. When this many bytes have been
+// written all later writes and renames fail. Less than zero for no limit.
+extern long hostFileWriteBudget;
+
+class File : public Print
+{
+public:
+	std::shared_ptr<std::string> data;
+	size_t pos = 0;
+	bool writable = false;
+
+	File() {}
+
+	operator bool() const { return data != nullptr; }
+	bool isDirectory() { return false; }
+	int available() { return data ? (int)(data->size() - pos) : 0; }
+	size_t size() { return data ? data->size() : 0; }
+	size_t position() { return pos; }
+
+	bool seek(uint32_t newPos)
+	{
+		if (!data || newPos > data->size())
+			return false;
+		pos = newPos;
+		return true;
+	}
+
+	int read()
+	{
+		if (!available())
+			return -1;
+		return (uint8_t)(*data)[pos++];
+	}
+
+	size_t read(uint8_t *buffer, size_t length)
+	{
+		size_t count = 0;
+		while (count < length && available())
+		{
+			buffer[count++] = (uint8_t)(*data)[pos++];
+		}
+		return count;
+	}
+
+	String readStringUntil(char terminator)
+	{
+		String result;
+		while (available())
+		{
+			char c = (*data)[pos++];
+			if (c == terminator)
+				break;
+			result += c;
+		}
+		return result;
+	}
+
+	using Print::write;
+
+	size_t write(uint8_t c) override
+	{
+		return write(&c, 1);
+	}
+
+	size_t write(const uint8_t *buffer, size_t length) override
+	{
+		if (!data || !writable)
+			return 0;
+		if (hostFileWriteBudget >= 0)
+		{
+			if ((long)length > hostFileWriteBudget)
+				length = hostFileWriteBudget;
+			hostFileWriteBudget -= length;
+		}
+		if (pos + length > data->size())
+			data->resize(pos + length);
+		memcpy(&(*data)[pos], buffer, length);
+		pos += length;
+		return length;
+	}
+
+	void close() { data = nullptr; }
+	File openNextFile() { return File(); }
+	const char *name() { return ""; }
+};
+
+class FS
+{
+public:
+	std::map<std::string, std::shared_ptr<std::string>> files;
+	unsigned long bytesWritten = 0;
+
+	bool begin() { return true; }
+
+	File open(const char *path, const char *mode)
+	{
+		File file;
+		auto existing = files.find(path);
+		if (mode[0] == 'r')
+		{
+			if (existing == files.end())
+				return file;
+			file.data = existing->second;
+			file.writable = mode[1] == '+';
+			return file;
+		}
+		if (mode[0] == 'a' && existing != files.end())
+		{
+			file.data = existing->second;
+			file.pos = file.data->size();
+			file.writable = true;
+			return file;
+		}
+		file.data = std::make_shared<std::string>();
+		file.writable = true;
+		files[path] = file.data;
+		return file;
+	}
+
+	bool exists(const char *path) { return files.count(path) != 0; }
+	bool mkdir(const char * /* path */) { return true; }
+	bool remove(const char *path) { return files.erase(path) != 0; }
+
+	bool rename(const char *from, const char *to)
+	{
+		if (hostFileWriteBudget == 0)
+			return false;
+		auto existing = files.find(from);
+		if (existing == files.end())
+			return false;
+		files[to] = existing->second;
+		files.erase(existing);
+		return true;
+	}
+};
+
+extern FS LittleFS;
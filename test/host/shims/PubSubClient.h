@@ -0,0 +1,109 @@
+#pragma once
+
+// A stand-in for the PubSubClient library that talks to the fake broker
+// in hostBroker rather than to the network.
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECT_BAD_PROTOCOL 1
+#define MQTT_CONNECT_BAD_CLIENT_ID 2
+#define MQTT_CONNECT_UNAVAILABLE 3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED 5
+
+#define HOST_BROKER_MAX_PUBLISHED 256
+#define HOST_BROKER_TOPIC_LENGTH 100
+#define HOST_BROKER_PAYLOAD_LENGTH 1600
+#define HOST_BROKER_MAX_INBOUND 64
+
+// How the broker behaves. Delays are added to the host clock inside the
+// calls that would block on a real network.
+
+struct hostBrokerBehaviour
+{
+	bool acceptNetwork;
+	unsigned long networkDelayMillis;
+
+	// MQTT_CONNECTED to accept the session or the state to fail with
+	int sessionResult;
+	unsigned long sessionDelayMillis;
+
+	// drops the connection in the next loop call
+	bool dropConnection;
+
+	bool refusePublish;
+	unsigned long publishDelayMicros;
+};
+
+struct hostBrokerMessage
+{
+	char topic[HOST_BROKER_TOPIC_LENGTH];
+	char payload[HOST_BROKER_PAYLOAD_LENGTH];
+	unsigned int length;
+};
+
+struct hostBrokerState
+{
+	struct hostBrokerBehaviour behaviour;
+
+	int networkConnects;
+	int sessionConnects;
+	int subscribes;
+	bool sessionOpen;
+
+	int noOfPublished;
+	struct hostBrokerMessage published[HOST_BROKER_MAX_PUBLISHED];
+
+	// called for every message the device publishes
+	void (*onPublish)(const char *topic, const char *payload, unsigned int length);
+
+	// messages for the device, delivered by the next loop call
+	struct hostBrokerMessage inbound[HOST_BROKER_MAX_INBOUND];
+	int inboundHead;
+	int inboundCount;
+};
+
+extern struct hostBrokerState hostBroker;
+
+// accepts connections and publishes straight away
+void hostBrokerReset();
+
+// queues a message for the device, returns false if the broker is full
+bool hostBrokerSend(const char *topic, const char *payload);
+
+class PubSubClient
+{
+public:
+	Client *client;
+	void (*callback)(char *topic, uint8_t *payload, unsigned int length) = NULL;
+	int clientState = MQTT_DISCONNECTED;
+
+	PubSubClient(Client &inClient) { client = &inClient; }
+
+	PubSubClient &setServer(const char * /* domain */, uint16_t /* port */) { return *this; }
+	PubSubClient &setCallback(void (*inCallback)(char *, uint8_t *, unsigned int))
+	{
+		callback = inCallback;
+		return *this;
+	}
+	PubSubClient &setSocketTimeout(uint16_t /* timeout */) { return *this; }
+	boolean setBufferSize(uint16_t /* size */) { return true; }
+
+	boolean connect(const char *id, const char *user, const char *pass);
+	void disconnect();
+	boolean publish(const char *topic, const uint8_t *payload, unsigned int length);
+	boolean publish(const char *topic, const char *payload)
+	{
+		return publish(topic, (const uint8_t *)payload, strlen(payload));
+	}
+	boolean subscribe(const char *topic);
+	boolean loop();
+	boolean connected() { return clientState == MQTT_CONNECTED; }
+	int state() { return clientState; }
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+// A stand-in for the WiFi library. The network client connects to the
+// fake broker in hostBroker, which a test sets up to accept, delay or
+// refuse connections.
+
+#include <Arduino.h>
+
+#define WL_IDLE_STATUS 0
+#define WL_NO_SSID_AVAIL 1
+#define WL_CONNECTED 3
+#define WL_CONNECT_FAILED 4
+#define WL_DISCONNECTED 6
+
+class IPAddress
+{
+public:
+	uint8_t bytes[4];
+
+	IPAddress() { memset(bytes, 0, 4); }
+	IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+	{
+		bytes[0] = a;
+		bytes[1] = b;
+		bytes[2] = c;
+		bytes[3] = d;
+	}
+	uint8_t operator[](int i) const { return bytes[i]; }
+	String toString() const
+	{
+		char buffer[16];
+		snprintf(buffer, 16, "%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3]);
+		return String(buffer);
+	}
+};
+
+class Client
+{
+public:
+	virtual ~Client() {}
+	virtual int connect(const char *host, uint16_t port) = 0;
+	virtual uint8_t connected() = 0;
+	virtual void stop() = 0;
+	virtual void setTimeout(unsigned long timeout) = 0;
+};
+
+class WiFiClient : public Client
+{
+public:
+	bool isConnected = false;
+	unsigned long timeoutMillis = 1000;
+
+	int connect(const char *host, uint16_t port);
+	uint8_t connected();
+	void stop();
+	void setTimeout(unsigned long timeout) { timeoutMillis = timeout; }
+};
+
+class WiFiClientSecure : public WiFiClient
+{
+public:
+	void setInsecure() {}
+};
+
+class WiFiClass
+{
+public:
+	int wifiStatus = WL_CONNECTED;
+
+	int status() { return wifiStatus; }
+	IPAddress localIP() { return IPAddress(192, 168, 1, 50); }
+	void disconnect() { wifiStatus = WL_DISCONNECTED; }
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,3 @@
+#pragma once
+
+// BME280Sensor.cpp includes Wire.h but the host BME280 needs no bus
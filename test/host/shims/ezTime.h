@@ -0,0 +1,4 @@
+#pragma once
+
+// clock.h includes ezTime.h for the clock process, which the host tests
+// replace with a clock reading of their own
@@ -0,0 +1,225 @@
+// Host test of the idle sleep: the deadline calculation, the sleep setting
+// limits and a simulation of a device with a pixel frame deadline and a
+// slow sensor, which reports the sleep residency.
+
+#include <Arduino.h>
+
+#include "hostTest.h"
+#include "idle.h"
+
+extern unsigned long idleTotalSleepMillis;
+extern unsigned long idleNoOfSleeps;
+extern unsigned long idleTimerWakes;
+extern unsigned long idleInputWakes;
+extern unsigned long idleOtherWakes;
+
+extern struct SettingItem idleMaxSleepMillisSetting;
+extern struct SettingItem idleMinSleepMillisSetting;
+
+unsigned long sensorPollMillis = IDLE_NO_DEADLINE;
+
+unsigned long millisToNextSensorPoll(unsigned long /* currentMillis */)
+{
+	return sensorPollMillis;
+}
+
+// a process that wants to run every frameMillis
+
+unsigned long frameMillis = 20;
+unsigned long lastFrameMillis = 0;
+
+unsigned long millisToNextFrame(unsigned long currentMillis)
+{
+	unsigned long sinceFrame = currentMillis - lastFrameMillis;
+
+	if (sinceFrame >= frameMillis)
+	{
+		return 0;
+	}
+
+	return frameMillis - sinceFrame;
+}
+
+unsigned long millisToNothing(unsigned long /* currentMillis */)
+{
+	return IDLE_NO_DEADLINE;
+}
+
+unsigned long fixedDeadline = 7;
+
+unsigned long millisToFixedDeadline(unsigned long /* currentMillis */)
+{
+	return fixedDeadline;
+}
+
+void startIdleSleeping(int maxSleepMillis, int minSleepMillis)
+{
+	idleSettings.idleSleepEnabled = true;
+	idleSettings.idleMaxSleepMillis = maxSleepMillis;
+	idleSettings.idleMinSleepMillis = minSleepMillis;
+	idleSettings.idleLogWakes = false;
+	idleProcess.startProcess();
+}
+
+void testDeadlines()
+{
+	startIdleSleeping(100, 5);
+
+	sensorPollMillis = IDLE_NO_DEADLINE;
+	CHECK(millisToNextIdleDeadline(millis()) == 100);
+
+	sensorPollMillis = 30;
+	CHECK(millisToNextIdleDeadline(millis()) == 30);
+
+	sensorPollMillis = IDLE_NO_DEADLINE;
+	CHECK(bindIdleDeadline(millisToNothing));
+	CHECK(millisToNextIdleDeadline(millis()) == 100);
+
+	CHECK(bindIdleDeadline(millisToFixedDeadline));
+	CHECK(millisToNextIdleDeadline(millis()) == 7);
+
+	// binding twice doesn't use up another slot
+	CHECK(bindIdleDeadline(millisToFixedDeadline));
+
+	fixedDeadline = 0;
+	CHECK(millisToNextIdleDeadline(millis()) == 0);
+	fixedDeadline = IDLE_NO_DEADLINE;
+
+	// a negative longest sleep that got past the settings must not turn
+	// into a huge unsigned sleep
+	idleSettings.idleMaxSleepMillis = -5;
+	CHECK(millisToNextIdleDeadline(millis()) == 0);
+	idleSettings.idleMaxSleepMillis = 100;
+}
+
+void testSleepSettingLimits()
+{
+	int value = 123;
+
+	CHECK(!idleMaxSleepMillisSetting.validateValue(&value, "-5"));
+	CHECK(value == 123);
+	CHECK(!idleMaxSleepMillisSetting.validateValue(&value, "70000"));
+	CHECK(!idleMinSleepMillisSetting.validateValue(&value, "-1"));
+	CHECK(!idleMaxSleepMillisSetting.validateValue(&value, "fred"));
+
+	CHECK(idleMaxSleepMillisSetting.validateValue(&value, "250"));
+	CHECK(value == 250);
+	CHECK(idleMinSleepMillisSetting.validateValue(&value, "0"));
+	CHECK(value == 0);
+}
+
+// Runs the main loop for runMillis with the work in each pass taking
+// workMillis. Returns the latest that a frame was run after it was due.
+
+unsigned long simulateLoop(unsigned long runMillis, unsigned long workMillis, unsigned long *noOfFrames)
+{
+	unsigned long startMillis = millis();
+	unsigned long worstLateness = 0;
+
+	lastFrameMillis = startMillis;
+	*noOfFrames = 0;
+
+	while (millis() - startMillis < runMillis)
+	{
+		unsigned long now = millis();
+
+		if (now - lastFrameMillis >= frameMillis)
+		{
+			unsigned long lateness = now - lastFrameMillis - frameMillis;
+			if (lateness > worstLateness)
+			{
+				worstLateness = lateness;
+			}
+			lastFrameMillis = now;
+			(*noOfFrames)++;
+			hostAdvanceMillis(workMillis);
+		}
+
+		idle();
+	}
+
+	return worstLateness;
+}
+
+void testDutyCycle()
+{
+	bindIdleDeadline(millisToNextFrame);
+
+	const unsigned long workMillis[] = {0, 2, 5, 10};
+
+	for (unsigned int i = 0; i < sizeof(workMillis) / sizeof(unsigned long); i++)
+	{
+		startIdleSleeping(100, 5);
+		sensorPollMillis = 500;
+
+		unsigned long startMillis = millis();
+		unsigned long noOfFrames;
+		unsigned long lateness = simulateLoop(10000, workMillis[i], &noOfFrames);
+		unsigned long runMillis = millis() - startMillis;
+		unsigned long residency = (idleTotalSleepMillis * 100) / runMillis;
+
+		printf("  frame work %2lu ms: residency %3lu%% frames %4lu sleeps %4lu timer wakes %4lu worst lateness %lu ms\n",
+			   workMillis[i], residency, noOfFrames, idleNoOfSleeps, idleTimerWakes, lateness);
+
+		// the deadline is met to within one sleep slice
+		CHECK(lateness <= (unsigned long)idleSettings.idleMinSleepMillis);
+
+		// each 20ms frame is run
+		CHECK(noOfFrames >= (runMillis / frameMillis) - 1);
+
+		// the time not spent working is slept
+		unsigned long expectedResidency = ((frameMillis - workMillis[i]) * 100) / frameMillis;
+		CHECK(residency + 5 >= expectedResidency);
+
+		CHECK(idleInputWakes == 0);
+		CHECK(idleOtherWakes == 0);
+	}
+}
+
+const int wakePin = 5;
+unsigned long pinChangeMillis;
+
+void changePinAfterDelay(unsigned long /* delayMillis */)
+{
+	if (millis() >= pinChangeMillis)
+	{
+		hostPinLevels[wakePin] = HIGH;
+	}
+}
+
+void testWakePin()
+{
+	startIdleSleeping(100, 5);
+	frameMillis = 1000;
+	lastFrameMillis = millis();
+	sensorPollMillis = IDLE_NO_DEADLINE;
+
+	hostPinLevels[wakePin] = LOW;
+	CHECK(bindIdleWakePin(wakePin));
+
+	unsigned long sleepStart = millis();
+	pinChangeMillis = sleepStart + 12;
+	hostDelayHook = changePinAfterDelay;
+
+	idle();
+
+	hostDelayHook = NULL;
+
+	unsigned long slept = millis() - sleepStart;
+
+	// woken within a slice of the pin change rather than after 100ms
+	CHECK(idleInputWakes == 1);
+	CHECK(slept >= 12 && slept <= 12 + (unsigned long)idleSettings.idleMinSleepMillis);
+}
+
+int main()
+{
+	idleProcess.initProcess();
+
+	testDeadlines();
+	testSleepSettingLimits();
+	testDutyCycle();
+	testWakePin();
+
+	return hostTestResult("idle");
+}
@@ -0,0 +1,45 @@
+// Host test of the messages made at boot. Nothing is written to the
+// serial port while messages are held, which startDevice does until the
+// port has settled, and the held messages then come out in order after
+// anything written straight to the port.
+
+#include <Arduino.h>
+
+#include "hostTest.h"
+#include "messages.h"
+
+void updateMessages();
+
+void saveSettings() {}
+
+void testHeldMessages()
+{
+	Serial.written = "";
+
+	holdMessages();
+
+	displayMessage(F("Populate lists\n"));
+	displayMessageWithNewline(F("Load settings %d"), 1);
+	updateMessages();
+	flushMessages();
+
+	CHECK(Serial.written == "");
+
+	Serial.printf("Starting\n");
+
+	releaseMessages();
+
+	CHECK(Serial.written == "Starting\nPopulate lists\nLoad settings 1\r\n");
+
+	// once released messages go straight out again
+	displayMessage(F("Running\n"));
+
+	CHECK(Serial.written == "Starting\nPopulate lists\nLoad settings 1\r\nRunning\n");
+}
+
+int main()
+{
+	testHeldMessages();
+
+	return hostTestResult("messages");
+}
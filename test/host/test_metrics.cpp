@@ -0,0 +1,156 @@
+// Host test of the metrics message: a message that fits is sent whole,
+// one that doesn't is sent a section at a time, and a section that can't
+// fit on its own is not sent and is counted.
+
+#include <Arduino.h>
+
+#include "hostTest.h"
+#include "metrics.h"
+#include "sensors.h"
+
+extern unsigned long metricsSplitPublishes;
+extern unsigned long metricsOverflows;
+
+void sendMetrics(void (*send)(char *json));
+
+struct sensor *activeSensorList = NULL;
+
+struct process *getAllProcessList()
+{
+	return NULL;
+}
+
+void PrintSystemDetails(char *buffer, int length)
+{
+	snprintf(buffer, length, "hostdevice");
+}
+
+int publishBufferToMQTTTopic(char * /* buffer */, char * /* topic */)
+{
+	return 0;
+}
+
+int noOfMessagesSent = 0;
+bool messageTooLong = false;
+bool messageBadlyFormed = false;
+
+void collectMessage(char *json)
+{
+	int length = strlen(json);
+
+	noOfMessagesSent++;
+
+	if (length >= METRICS_JSON_BUFFER_SIZE - 1)
+	{
+		messageTooLong = true;
+	}
+
+	if (json[0] != '{' || json[length - 1] != '}')
+	{
+		messageBadlyFormed = true;
+	}
+}
+
+void sendAndCount()
+{
+	noOfMessagesSent = 0;
+	messageTooLong = false;
+	messageBadlyFormed = false;
+	sendMetrics(collectMessage);
+}
+
+// names and values for the metrics; the names must outlive the registry
+
+char metricNames[METRICS_MAX_NO_OF_METRICS][32];
+unsigned long counters[METRICS_MAX_NO_OF_METRICS];
+unsigned long bucketLimits[] = {1, 10, 100, 1000, 10000, 100000};
+struct metricHistogram histograms[METRICS_MAX_NO_OF_METRICS];
+
+int noOfNames = 0;
+
+const char *newMetricName(const char *prefix)
+{
+	snprintf(metricNames[noOfNames], 32, "%s%02dwithaverylongmetricnamehere", prefix, noOfNames);
+	return metricNames[noOfNames++];
+}
+
+void addCounters(int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		counters[noOfNames] = 4000000000UL;
+		CHECK(addCounterMetric(newMetricName("c"), &counters[noOfNames]));
+	}
+}
+
+void addHistograms(int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		struct metricHistogram *h = &histograms[noOfNames];
+		h->bucketLimits = bucketLimits;
+		h->noOfLimits = sizeof(bucketLimits) / sizeof(unsigned long);
+		for (unsigned long v = 0; v < 200000; v = v * 3 + 1)
+		{
+			recordMetricHistogram(h, v);
+		}
+		CHECK(addHistogramMetric(newMetricName("h"), h));
+	}
+}
+
+void testWholeMessage()
+{
+	char buffer[METRICS_JSON_BUFFER_SIZE];
+
+	addCounters(4);
+	addHistograms(2);
+
+	CHECK(createMetricsJson(buffer, METRICS_JSON_BUFFER_SIZE, METRICS_ALL_SECTIONS));
+	CHECK(strstr(buffer, "\"c\":{") != NULL);
+	CHECK(strstr(buffer, "\"h\":{") != NULL);
+
+	sendAndCount();
+	CHECK(noOfMessagesSent == 1);
+	CHECK(!messageBadlyFormed);
+	CHECK(metricsSplitPublishes == 0);
+	CHECK(metricsOverflows == 0);
+
+	// a small buffer is reported as cut off
+	CHECK(!createMetricsJson(buffer, 100, METRICS_ALL_SECTIONS));
+	CHECK(strlen(buffer) == 99);
+}
+
+void testSplitMessage()
+{
+	// each section fits on its own but not all together
+	addCounters(16);
+	addHistograms(10);
+
+	sendAndCount();
+	CHECK(noOfMessagesSent == 4);
+	CHECK(!messageTooLong);
+	CHECK(!messageBadlyFormed);
+	CHECK(metricsSplitPublishes == 1);
+	CHECK(metricsOverflows == 0);
+}
+
+void testSectionOverflow()
+{
+	// the counters section no longer fits in a message of its own
+	addCounters(16);
+
+	sendAndCount();
+	CHECK(noOfMessagesSent == 3);
+	CHECK(!messageTooLong);
+	CHECK(!messageBadlyFormed);
+	CHECK(metricsSplitPublishes == 2);
+	CHECK(metricsOverflows == 1);
+}
+
+int main()
+{
+	testWholeMessage();
+	testSplitMessage();
+	testSectionOverflow();
+	return hostTestResult("metrics");
+}
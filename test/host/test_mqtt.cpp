@@ -0,0 +1,322 @@
+// Host tests of the MQTT process against the fake broker in hostBroker:
+// the connection steps and retries when the broker accepts, delays or
+// refuses connections, the journal that holds messages while the
+// connection is down and the room for the longest topics.
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+
+#include "hostTest.h"
+#include "mqtt.h"
+
+extern unsigned long mqttJournalled;
+extern unsigned long mqttJournalTooLong;
+extern unsigned long mqttJournalBytes;
+extern unsigned long mqttSendDropped;
+extern unsigned long mqttWiFiRescans;
+extern char mqttDataTopic[];
+extern char mqttSubscribeFullTopic[];
+
+extern struct SettingItem mqttTopicPrefixSetting;
+extern struct SettingItem mqttPublishTopicSetting;
+extern struct SettingItem mqttSubscribeTopicSetting;
+extern struct SettingItem mqttDeviceNameSetting;
+
+void buildMQTTTopics();
+
+int hostWiFiScans = 0;
+
+void beginWiFiScanning()
+{
+	hostWiFiScans++;
+	WiFiProcessDescriptor.status = WIFI_SCANNING;
+}
+
+void setMQTTDefaults()
+{
+	for (int i = 0; i < mqttSettingItems.noOfSettings; i++)
+	{
+		SettingItem *item = mqttSettingItems.settings[i];
+		item->setDefault(item->value);
+	}
+	strcpy(mqttSettings.mqttServer, "broker");
+	strcpy(mqttSettings.mqttDeviceName, "hostdevice");
+	mqttSettings.mqtt_enabled = true;
+}
+
+// a reboot loses everything but the files
+
+void startDevice()
+{
+	hostBrokerReset();
+	WiFiProcessDescriptor.status = WIFI_OK;
+	setMQTTDefaults();
+	MQTTProcessDescriptor.initProcess();
+	MQTTProcessDescriptor.startProcess();
+}
+
+// the longest time one update has held up the loop
+unsigned long longestUpdateMillis;
+
+void updateTimes(int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		unsigned long start = millis();
+		MQTTProcessDescriptor.udpateProcess();
+		unsigned long taken = millis() - start;
+		if (taken > longestUpdateMillis)
+		{
+			longestUpdateMillis = taken;
+		}
+		hostAdvanceMillis(10);
+	}
+}
+
+// updates until the status changes or the time runs out and returns the
+// time taken
+
+unsigned long updateUntilStatusChanges(unsigned long limitMillis)
+{
+	int startStatus = MQTTProcessDescriptor.status;
+	unsigned long start = millis();
+
+	while (MQTTProcessDescriptor.status == startStatus && millis() - start < limitMillis)
+	{
+		updateTimes(1);
+	}
+
+	return millis() - start;
+}
+
+void testConnect()
+{
+	startDevice();
+	longestUpdateMillis = 0;
+
+	// the network connection and the session are made in separate updates
+	updateTimes(1);
+	CHECK(MQTTProcessDescriptor.status == MQTT_CONNECTING);
+	CHECK(hostBroker.networkConnects == 1);
+	CHECK(hostBroker.sessionConnects == 0);
+
+	updateTimes(1);
+	CHECK(MQTTProcessDescriptor.status == MQTT_OK);
+	CHECK(hostBroker.sessionConnects == 1);
+	CHECK(hostBroker.subscribes == 1);
+	CHECK(longestUpdateMillis < 20);
+}
+
+void testSlowBroker()
+{
+	startDevice();
+	longestUpdateMillis = 0;
+
+	hostBroker.behaviour.networkDelayMillis = 2500;
+	hostBroker.behaviour.sessionDelayMillis = 2500;
+
+	updateTimes(2);
+	CHECK(MQTTProcessDescriptor.status == MQTT_OK);
+
+	// neither step holds up the loop for more than its own limit
+	CHECK(longestUpdateMillis >= 2500);
+	CHECK(longestUpdateMillis <= MQTT_NETWORK_CONNECT_TIMEOUT_MILLIS);
+}
+
+void testRefusedSession()
+{
+	startDevice();
+
+	hostBroker.behaviour.sessionResult = MQTT_CONNECT_BAD_CREDENTIALS;
+
+	updateTimes(2);
+	CHECK(MQTTProcessDescriptor.status == MQTT_ERROR_BAD_CREDENTIALS);
+
+	// each retry waits twice as long as the last
+	unsigned long firstWait = updateUntilStatusChanges(MQTT_CONNECT_RETRY_MAX_MILLIS);
+	updateTimes(2);
+	CHECK(MQTTProcessDescriptor.status == MQTT_ERROR_BAD_CREDENTIALS);
+	unsigned long secondWait = updateUntilStatusChanges(MQTT_CONNECT_RETRY_MAX_MILLIS);
+	CHECK(secondWait >= firstWait * 2 - 20 && secondWait <= firstWait * 2 + 20);
+
+	// a broker that refuses the session is reachable so WiFi is left alone
+	for (int i = 0; i < MQTT_UNREACHABLE_BEFORE_WIFI_RESCAN + 1; i++)
+	{
+		updateTimes(2);
+		updateUntilStatusChanges(MQTT_CONNECT_RETRY_MAX_MILLIS);
+	}
+	CHECK(hostWiFiScans == 0);
+
+	// and the connection is made once the broker accepts it
+	hostBroker.behaviour.sessionResult = MQTT_CONNECTED;
+	updateTimes(2);
+	CHECK(MQTTProcessDescriptor.status == MQTT_OK);
+}
+
+void testUnreachableBroker()
+{
+	startDevice();
+	hostWiFiScans = 0;
+	unsigned long rescansBefore = mqttWiFiRescans;
+	longestUpdateMillis = 0;
+
+	hostBroker.behaviour.acceptNetwork = false;
+
+	for (int i = 1; i < MQTT_UNREACHABLE_BEFORE_WIFI_RESCAN; i++)
+	{
+		updateTimes(1);
+		CHECK(MQTTProcessDescriptor.status == MQTT_ERROR_CONNECT_FAILED);
+		updateUntilStatusChanges(MQTT_CONNECT_RETRY_MAX_MILLIS);
+		CHECK(MQTTProcessDescriptor.status == MQTT_STARTING);
+	}
+
+	CHECK(hostWiFiScans == 0);
+
+	// the next failure starts a WiFi scan and MQTT waits for WiFi
+	updateTimes(1);
+	CHECK(hostWiFiScans == 1);
+	CHECK(mqttWiFiRescans == rescansBefore + 1);
+	CHECK(MQTTProcessDescriptor.status == MQTT_ERROR_NO_WIFI);
+
+	updateTimes(100);
+	CHECK(MQTTProcessDescriptor.status == MQTT_ERROR_NO_WIFI);
+	CHECK(hostBroker.networkConnects == MQTT_UNREACHABLE_BEFORE_WIFI_RESCAN);
+
+	// a failed network connection waits no longer than the timeout
+	CHECK(longestUpdateMillis <= MQTT_NETWORK_CONNECT_TIMEOUT_MILLIS);
+
+	// WiFi comes back on an access point that can reach the broker
+	hostBroker.behaviour.acceptNetwork = true;
+	WiFiProcessDescriptor.status = WIFI_OK;
+	updateTimes(2);
+	CHECK(MQTTProcessDescriptor.status == MQTT_OK);
+}
+
+void testDroppedConnection()
+{
+	startDevice();
+	updateTimes(2);
+	CHECK(MQTTProcessDescriptor.status == MQTT_OK);
+
+	hostBroker.behaviour.dropConnection = true;
+	updateTimes(1);
+	CHECK(MQTTProcessDescriptor.status == MQTT_ERROR_LOOP_FAILED);
+
+	updateUntilStatusChanges(MQTT_CONNECT_RETRY_MAX_MILLIS);
+	updateTimes(2);
+	CHECK(MQTTProcessDescriptor.status == MQTT_OK);
+	CHECK(hostBroker.sessionConnects == 2);
+}
+
+void publishRecord(int number)
+{
+	char buffer[30];
+	snprintf(buffer, 30, "record %d", number);
+	publishBufferToMQTTTopic(buffer, "data");
+}
+
+bool recordPublished(int index, int number)
+{
+	char buffer[30];
+	snprintf(buffer, 30, "record %d", number);
+	return index < hostBroker.noOfPublished && strcmp(hostBroker.published[index].payload, buffer) == 0;
+}
+
+void testJournalSurvivesReboot()
+{
+	LittleFS.files.clear();
+	startDevice();
+
+	// nothing is connected yet so these are all journalled
+	for (int i = 0; i < 10; i++)
+	{
+		publishRecord(i);
+	}
+	CHECK(mqttJournalled == 10);
+	CHECK(MQTTProcessDescriptor.status == MQTT_STARTING);
+
+	// network connect, session connect and then one batch sent
+	updateTimes(3);
+	CHECK(MQTTProcessDescriptor.status == MQTT_OK);
+	CHECK(hostBroker.noOfPublished == MQTT_PUBLISH_BATCH_SIZE);
+
+	// reboot part way through the replay
+	startDevice();
+	CHECK(mqttJournalBytes > 0);
+
+	updateTimes(10);
+	CHECK(MQTTProcessDescriptor.status == MQTT_OK);
+	CHECK(hostBroker.noOfPublished == 10 - MQTT_PUBLISH_BATCH_SIZE);
+
+	for (int i = 0; i < hostBroker.noOfPublished; i++)
+	{
+		CHECK(recordPublished(i, i + MQTT_PUBLISH_BATCH_SIZE));
+	}
+
+	CHECK(mqttJournalBytes == 0);
+
+	// a reboot after the replay has finished sends nothing
+	startDevice();
+	updateTimes(10);
+	CHECK(hostBroker.noOfPublished == 0);
+
+	// new records are replayed from the start of the emptied journal
+	startDevice();
+	publishRecord(20);
+	publishRecord(21);
+	updateTimes(10);
+	CHECK(hostBroker.noOfPublished == 2);
+	CHECK(recordPublished(0, 20));
+	CHECK(recordPublished(1, 21));
+}
+
+void testTooLongToJournal()
+{
+	LittleFS.files.clear();
+	startDevice();
+
+	char buffer[MQTT_JOURNAL_RECORD_SIZE + 100];
+	memset(buffer, 'x', sizeof(buffer) - 1);
+	buffer[sizeof(buffer) - 1] = 0;
+
+	unsigned long droppedBefore = mqttSendDropped;
+
+	publishBufferToMQTTTopic(buffer, "metrics");
+
+	CHECK(mqttJournalTooLong == 1);
+	CHECK(mqttSendDropped == droppedBefore + 1);
+	CHECK(mqttJournalBytes == 0);
+}
+
+// the topics have room for the longest settings that validate
+
+void testLongestTopics()
+{
+	std::string prefix(MQTT_TOPIC_PREFIX_LENGTH - 1, 'p');
+	std::string publish(MQTT_TOPIC_LENGTH - 1, 't');
+	std::string subscribe(MQTT_TOPIC_LENGTH - 1, 's');
+	std::string device(DEVICE_NAME_LENGTH - 1, 'd');
+
+	CHECK(mqttTopicPrefixSetting.validateValue(mqttSettings.mqttTopicPrefix, prefix.c_str()));
+	CHECK(mqttPublishTopicSetting.validateValue(mqttSettings.mqttPublishTopic, publish.c_str()));
+	CHECK(mqttSubscribeTopicSetting.validateValue(mqttSettings.mqttSubscribeTopic, subscribe.c_str()));
+	CHECK(mqttDeviceNameSetting.validateValue(mqttSettings.mqttDeviceName, device.c_str()));
+
+	buildMQTTTopics();
+
+	CHECK(mqttDataTopic == prefix + "/" + publish + "/" + device);
+	CHECK(mqttSubscribeFullTopic == prefix + "/" + subscribe + "/" + device);
+}
+
+int main()
+{
+	testConnect();
+	testSlowBroker();
+	testRefusedSession();
+	testUnreachableBroker();
+	testDroppedConnection();
+	testJournalSurvivesReboot();
+	testTooLongToJournal();
+	testLongestTopics();
+	return hostTestResult("mqtt");
+}
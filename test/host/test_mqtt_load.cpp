@@ -0,0 +1,264 @@
+// Host load test of the MQTT command path. A fake broker sends commands
+// at a set rate and the replies come back through act_onJson_message, the
+// receive ring and the send queue. Each scenario reports the throughput,
+// the latency from the broker sending a command to receiving its reply,
+// and the commands dropped by the receive ring.
+//
+// The host clock is moved on by the real time each update takes, so the
+// latencies include the command decoding as well as the queueing. The
+// throughput is measured on the host, which is many times faster than a
+// device, so compare runs with each other rather than with a device.
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "hostTest.h"
+#include "mqtt.h"
+#include "processes.h"
+
+extern unsigned long mqttReceiveOverflows;
+
+void addProcessToAllProcessList(struct process *newProcess);
+
+void beginWiFiScanning() {}
+
+// commands from the default stream of the on-device load test, numbered
+// so that each reply can be matched with its command
+
+const char *loadCommands[] = {
+	"{\"setting\":\"mqttpub\",\"seq\":\"%d\"}",
+	"{\"setting\":\"mqttdevicename\",\"seq\":\"%d\"}",
+	"{\"process\":\"loadtest\",\"command\":\"none\",\"seq\":\"%d\"}",
+	"{\"setting\":\"nosuchsetting\",\"seq\":\"%d\"}"};
+
+#define NO_OF_LOAD_COMMANDS (sizeof(loadCommands) / sizeof(const char *))
+
+#define LOAD_MAX_MESSAGES 5000
+
+unsigned long sendMicros[LOAD_MAX_MESSAGES];
+long replyMicros[LOAD_MAX_MESSAGES];
+int noOfReplies;
+int repliesOutOfOrder;
+int lastReplySeq;
+
+// the reply to the first device name setting command
+char deviceNameReply[100];
+
+void recordReply(const char * /* topic */, const char *payload, unsigned int /* length */)
+{
+	const char *seqText = strstr(payload, "\"seq\":");
+
+	if (seqText == NULL)
+	{
+		return;
+	}
+
+	int seq = atoi(seqText + 6);
+
+	if (seq < 0 || seq >= LOAD_MAX_MESSAGES || replyMicros[seq] >= 0)
+	{
+		return;
+	}
+
+	if (seq < lastReplySeq)
+	{
+		repliesOutOfOrder++;
+	}
+
+	if (seq == 1)
+	{
+		snprintf(deviceNameReply, 100, "%s", payload);
+	}
+
+	lastReplySeq = seq;
+	replyMicros[seq] = micros();
+	noOfReplies++;
+}
+
+void startDevice()
+{
+	hostBrokerReset();
+	hostBroker.onPublish = recordReply;
+
+	for (int i = 0; i < mqttSettingItems.noOfSettings; i++)
+	{
+		SettingItem *item = mqttSettingItems.settings[i];
+		item->setDefault(item->value);
+	}
+	strcpy(mqttSettings.mqttServer, "broker");
+	strcpy(mqttSettings.mqttDeviceName, "hostdevice");
+	mqttSettings.mqtt_enabled = true;
+	mqttSettings.mqttTelemetry = false;
+
+	MQTTProcessDescriptor.initProcess();
+	MQTTProcessDescriptor.startProcess();
+}
+
+// one pass round the device loop: the MQTT update and then the rest of
+// the processes, which take loopMillis
+
+double hostUpdateSeconds;
+
+void runLoop(unsigned long loopMillis)
+{
+	auto start = std::chrono::steady_clock::now();
+	MQTTProcessDescriptor.udpateProcess();
+	std::chrono::duration<double> taken = std::chrono::steady_clock::now() - start;
+
+	hostUpdateSeconds += taken.count();
+	hostMicros += (unsigned long)(taken.count() * 1000000) + 1;
+	hostAdvanceMillis(loopMillis);
+}
+
+struct loadScenario
+{
+	const char *name;
+	int noOfMessages;
+	int messagesPerBurst;
+	unsigned long millisBetweenBursts;
+	unsigned long loopMillis;
+};
+
+struct loadResult
+{
+	int sent;
+	int replies;
+	unsigned long dropped;
+	int outOfOrder;
+};
+
+unsigned long percentile(std::vector<unsigned long> &sorted, int percent)
+{
+	return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+struct loadResult runScenario(struct loadScenario *scenario)
+{
+	startDevice();
+
+	while (MQTTProcessDescriptor.status != MQTT_OK)
+	{
+		runLoop(scenario->loopMillis);
+	}
+
+	for (int i = 0; i < LOAD_MAX_MESSAGES; i++)
+	{
+		replyMicros[i] = -1;
+	}
+	noOfReplies = 0;
+	repliesOutOfOrder = 0;
+	lastReplySeq = -1;
+	hostUpdateSeconds = 0;
+
+	unsigned long overflowsAtStart = mqttReceiveOverflows;
+	unsigned long startMicros = micros();
+	unsigned long nextBurstMicros = startMicros;
+	int sent = 0;
+
+	// carries on until every reply is back or the device has been quiet
+	// for a second
+	unsigned long lastActivityMicros = startMicros;
+
+	while (sent < scenario->noOfMessages || micros() - lastActivityMicros < 1000000)
+	{
+		if (sent < scenario->noOfMessages && micros() >= nextBurstMicros)
+		{
+			for (int i = 0; i < scenario->messagesPerBurst && sent < scenario->noOfMessages; i++)
+			{
+				char command[100];
+				snprintf(command, 100, loadCommands[sent % NO_OF_LOAD_COMMANDS], sent);
+				sendMicros[sent] = micros();
+				if (!hostBrokerSend("loadtest", command))
+				{
+					printf("  broker inbound queue full - slow the scenario down\n");
+				}
+				sent++;
+			}
+			nextBurstMicros += scenario->millisBetweenBursts * 1000;
+		}
+
+		int repliesBefore = noOfReplies;
+		runLoop(scenario->loopMillis);
+
+		if (noOfReplies != repliesBefore || sent < scenario->noOfMessages)
+		{
+			lastActivityMicros = micros();
+		}
+
+		if (noOfReplies + (int)(mqttReceiveOverflows - overflowsAtStart) == scenario->noOfMessages)
+		{
+			break;
+		}
+	}
+
+	unsigned long elapsedMicros = micros() - startMicros;
+
+	struct loadResult result;
+	result.sent = sent;
+	result.replies = noOfReplies;
+	result.dropped = mqttReceiveOverflows - overflowsAtStart;
+	result.outOfOrder = repliesOutOfOrder;
+
+	std::vector<unsigned long> latencies;
+	for (int i = 0; i < sent; i++)
+	{
+		if (replyMicros[i] >= 0)
+		{
+			latencies.push_back(replyMicros[i] - sendMicros[i]);
+		}
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	printf("  %-8s sent %5d replies %5d dropped %4lu", scenario->name, result.sent, result.replies, result.dropped);
+
+	if (latencies.size() > 0)
+	{
+		printf("  %6.0f msg/sec  latency ms 50%%:%5.1f 90%%:%5.1f 99%%:%5.1f max:%5.1f  host %.1f us/msg",
+			   result.replies * 1000000.0 / elapsedMicros,
+			   percentile(latencies, 50) / 1000.0, percentile(latencies, 90) / 1000.0,
+			   percentile(latencies, 99) / 1000.0, latencies.back() / 1000.0,
+			   hostUpdateSeconds * 1000000.0 / result.replies);
+	}
+	printf("\n");
+
+	return result;
+}
+
+int main()
+{
+	// the settings commands look the settings up through the process list
+	addProcessToAllProcessList(&MQTTProcessDescriptor);
+
+	struct loadScenario steady = {"steady", 1000, 1, 20, 5};
+	struct loadScenario burst = {"burst", 1000, 8, 200, 5};
+	struct loadScenario flood = {"flood", 2000, 4, 1, 5};
+	struct loadScenario slow = {"slowloop", 500, 2, 50, 40};
+
+	// one command per update's worth of time is handled straight away
+	struct loadResult result = runScenario(&steady);
+	CHECK(result.replies == result.sent);
+	CHECK(result.dropped == 0);
+	CHECK(result.outOfOrder == 0);
+	CHECK(strcmp(deviceNameReply, "{\"val\":\"hostdevice\",\"error\":0,\"seq\":1}") == 0);
+
+	// bursts bigger than the receive ring lose the commands that don't fit
+	result = runScenario(&burst);
+	CHECK(result.dropped > 0);
+	CHECK(result.replies + (int)result.dropped == result.sent);
+	CHECK(result.outOfOrder == 0);
+
+	result = runScenario(&flood);
+	CHECK(result.replies + (int)result.dropped == result.sent);
+	CHECK(result.outOfOrder == 0);
+
+	// a slow loop still keeps up with a burst that fits in the ring
+	result = runScenario(&slow);
+	CHECK(result.dropped == 0);
+	CHECK(result.replies == result.sent);
+
+	return hostTestResult("mqtt load");
+}
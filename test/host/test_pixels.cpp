@@ -0,0 +1,358 @@
+// Host benchmark and golden image test of the pixel framebuffer. This file
+// is built twice, once with the float framebuffer and once with
+// PIXELS_INTEGER_FRAMEBUFFER. Both builds draw the same frames of moving
+// lights and report the frames per second. The float build writes its
+// output as the golden image and the integer build checks that nearly
+// all of its colour channels are within one step of it. Each build also
+// checks that its output is byte for byte what the framebuffer drew
+// before it was changed from a column per allocation to a single block.
+// Frames written straight into the strip buffer are checked against the
+// ones written a pixel at a time, and the cost of each is reported.
+
+#include <Arduino.h>
+
+#include <chrono>
+
+#include "hostTest.h"
+#include "Leds.h"
+
+#include <Adafruit_NeoPixel.h>
+
+#define PIXELS_WIDTH 20
+#define PIXELS_HEIGHT 10
+#define PIXELS_NO_OF_LEDS (PIXELS_WIDTH * PIXELS_HEIGHT)
+#define PIXELS_NO_OF_LIGHTS 20
+#define PIXELS_NO_OF_FRAMES 1000
+#define PIXELS_NO_OF_OUTPUT_FRAMES 20000
+
+#define PIXELS_GOLDEN_FILENAME "build/pixels_golden.bin"
+
+// the lowest fraction of integer channels within one step of the float ones
+#define PIXELS_MIN_WITHIN_ONE_STEP 0.997
+
+// hashes of the output of the Led** framebuffer layout, which kept each
+// column in a separate allocation, drawing the same frames
+#define PIXELS_FLOAT_LAYOUT_HASH 0xed7226c2UL
+#define PIXELS_INTEGER_LAYOUT_HASH 0xa2c0a9ddUL
+
+// a stand-in for the strip, in the colour order of most panels
+Adafruit_NeoPixel strip(PIXELS_NO_OF_LEDS, 0, NEO_GRB + NEO_KHZ800);
+
+// what was sent to the strip for the current frame, in red, green, blue order
+unsigned char stripBytes[PIXELS_NO_OF_LEDS * 3];
+
+void hostShow() {}
+
+// as setPixel in pixels.cpp
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+
+void hostSetPixel(int no, unsigned char r, unsigned char g, unsigned char b)
+{
+	strip.setPixelColor(no, r, g, b);
+}
+
+#else
+
+void hostSetPixel(int no, float r, float g, float b)
+{
+	strip.setPixelColor(no, (unsigned char)round(r * 255), (unsigned char)round(g * 255), (unsigned char)round(b * 255));
+}
+
+#endif
+
+void readStrip()
+{
+	unsigned char *pixels = strip.getPixels();
+
+	for (int i = 0; i < PIXELS_NO_OF_LEDS; i++)
+	{
+		stripBytes[i * 3] = pixels[i * 3 + strip.rOffset];
+		stripBytes[i * 3 + 1] = pixels[i * 3 + strip.gOffset];
+		stripBytes[i * 3 + 2] = pixels[i * 3 + strip.bOffset];
+	}
+}
+
+// a zig-zag strip, as buildDecodeArray makes for most panels
+
+int rasterLookup[PIXELS_NO_OF_LEDS];
+
+void buildRasterLookup()
+{
+	for (int y = 0; y < PIXELS_HEIGHT; y++)
+	{
+		for (int x = 0; x < PIXELS_WIDTH; x++)
+		{
+			int column = (y % 2 == 0) ? x : PIXELS_WIDTH - 1 - x;
+			rasterLookup[(y * PIXELS_WIDTH) + x] = (y * PIXELS_WIDTH) + column;
+		}
+	}
+}
+
+// the lights are set up from a fixed sequence so that every run and
+// both builds draw the same frames
+
+unsigned long lightSeed;
+
+float nextLightValue(int range)
+{
+	lightSeed = (lightSeed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+	return (float)((lightSeed >> 8) % range);
+}
+
+struct HostLight
+{
+	float x, y;
+	float xSpeed, ySpeed;
+	Colour colour;
+	float brightness;
+	float opacity;
+};
+
+struct HostLight lights[PIXELS_NO_OF_LIGHTS];
+
+void setupLights()
+{
+	lightSeed = 1;
+
+	for (int i = 0; i < PIXELS_NO_OF_LIGHTS; i++)
+	{
+		struct HostLight *light = &lights[i];
+		light->x = nextLightValue(PIXELS_WIDTH * 100) / 100;
+		light->y = nextLightValue(PIXELS_HEIGHT * 100) / 100;
+		light->xSpeed = (nextLightValue(100) - 50) / 1000;
+		light->ySpeed = (nextLightValue(100) - 50) / 1000;
+		light->colour = {nextLightValue(256) / 255, nextLightValue(256) / 255, nextLightValue(256) / 255};
+		light->brightness = nextLightValue(101) / 100;
+		light->opacity = nextLightValue(2) == 1 ? 1 : nextLightValue(101) / 100;
+	}
+}
+
+// every fourth frame is cleared to black and the unlit pixels are
+// washed with a colour after the lights have been drawn
+
+void drawLightsFrame(Leds *leds, int frameNo)
+{
+	Colour background = {0.02f * (frameNo % 10), 0, 0.05f};
+
+	if (frameNo % 4 == 0)
+	{
+		background = BLACK_COLOUR;
+	}
+
+	leds->clear(background);
+
+	for (int i = 0; i < PIXELS_NO_OF_LIGHTS; i++)
+	{
+		struct HostLight *light = &lights[i];
+
+		light->x = light->x + light->xSpeed;
+		light->y = light->y + light->ySpeed;
+
+		if (light->x < 0)
+			light->x = light->x + PIXELS_WIDTH;
+		if (light->x > PIXELS_WIDTH)
+			light->x = light->x - PIXELS_WIDTH;
+		if (light->y < 0)
+			light->y = light->y + PIXELS_HEIGHT;
+		if (light->y > PIXELS_HEIGHT)
+			light->y = light->y - PIXELS_HEIGHT;
+
+		leds->renderLight(light->x, light->y, light->colour, light->brightness, light->opacity);
+	}
+
+	if (frameNo % 4 == 0)
+	{
+		Colour washColour = {0, 0.1f, 0.02f * (frameNo % 10)};
+		leds->wash(washColour);
+	}
+
+	leds->display(0.1f + 0.9f * (frameNo % 100) / 99.0f);
+}
+
+// frames per second, with the whole output kept for the golden image
+
+unsigned char *drawLights(Leds *leds)
+{
+	unsigned char *frames = new unsigned char[PIXELS_NO_OF_FRAMES * sizeof(stripBytes)];
+
+	setupLights();
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int frameNo = 0; frameNo < PIXELS_NO_OF_FRAMES; frameNo++)
+	{
+		drawLightsFrame(leds, frameNo);
+		readStrip();
+		memcpy(frames + (frameNo * sizeof(stripBytes)), stripBytes, sizeof(stripBytes));
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("  %d lights on %dx%d%s: %.0f frames/sec\n", PIXELS_NO_OF_LIGHTS, PIXELS_WIDTH, PIXELS_HEIGHT,
+		   leds->outputBuffer != NULL ? " straight into the strip" : "", PIXELS_NO_OF_FRAMES / seconds);
+
+	return frames;
+}
+
+uint32_t hashFrames(unsigned char *frames)
+{
+	uint32_t hash = 2166136261UL;
+
+	for (unsigned int i = 0; i < PIXELS_NO_OF_FRAMES * sizeof(stripBytes); i++)
+	{
+		hash = (hash ^ frames[i]) * 16777619UL;
+	}
+
+	return hash;
+}
+
+void checkSameAsColumnLayout(unsigned char *frames)
+{
+	uint32_t hash = hashFrames(frames);
+
+	printf("  output hash %08lx\n", (unsigned long)hash);
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+	CHECK(hash == PIXELS_INTEGER_LAYOUT_HASH);
+#else
+	CHECK(hash == PIXELS_FLOAT_LAYOUT_HASH);
+#endif
+}
+
+// The frames written straight into the strip buffer go through the
+// brightness table, which rounds the float framebuffer to a byte before
+// scaling it, so they can be one step away from the float ones
+
+void checkStripOutput(unsigned char *frames, unsigned char *stripFrames)
+{
+	int worstDifference = 0;
+
+	for (unsigned int i = 0; i < PIXELS_NO_OF_FRAMES * sizeof(stripBytes); i++)
+	{
+		int difference = abs(frames[i] - stripFrames[i]);
+
+		if (difference > worstDifference)
+		{
+			worstDifference = difference;
+		}
+	}
+
+	printf("  strip buffer output worst difference %d\n", worstDifference);
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+	CHECK(worstDifference == 0);
+#else
+	CHECK(worstDifference <= 1);
+#endif
+}
+
+// the cost of sending one frame, which is already drawn, to the strip
+
+double outputMicrosPerFrame(Leds *leds)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	for (int frameNo = 0; frameNo < PIXELS_NO_OF_OUTPUT_FRAMES; frameNo++)
+	{
+		leds->display(0.5);
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return seconds * 1000000 / PIXELS_NO_OF_OUTPUT_FRAMES;
+}
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+
+void compareWithGoldenImage(unsigned char *frames)
+{
+	int size = PIXELS_NO_OF_FRAMES * sizeof(stripBytes);
+	unsigned char *golden = new unsigned char[size];
+
+	FILE *goldenFile = fopen(PIXELS_GOLDEN_FILENAME, "rb");
+	CHECK(goldenFile != NULL);
+
+	if (goldenFile == NULL)
+	{
+		return;
+	}
+
+	CHECK(fread(golden, 1, size, goldenFile) == (size_t)size);
+	fclose(goldenFile);
+
+	int withinOneStep = 0;
+	int worstDifference = 0;
+
+	for (int i = 0; i < size; i++)
+	{
+		int difference = abs(frames[i] - golden[i]);
+
+		if (difference <= 1)
+		{
+			withinOneStep++;
+		}
+
+		if (difference > worstDifference)
+		{
+			worstDifference = difference;
+		}
+	}
+
+	double fraction = (double)withinOneStep / size;
+
+	printf("  %.2f%% of channels within one step of the float framebuffer, worst difference %d\n",
+		   fraction * 100, worstDifference);
+
+	CHECK(fraction >= PIXELS_MIN_WITHIN_ONE_STEP);
+
+	delete[] golden;
+}
+
+#else
+
+void writeGoldenImage(unsigned char *frames)
+{
+	FILE *goldenFile = fopen(PIXELS_GOLDEN_FILENAME, "wb");
+	CHECK(goldenFile != NULL);
+
+	if (goldenFile == NULL)
+	{
+		return;
+	}
+
+	CHECK(fwrite(frames, 1, PIXELS_NO_OF_FRAMES * sizeof(stripBytes), goldenFile) == PIXELS_NO_OF_FRAMES * sizeof(stripBytes));
+	fclose(goldenFile);
+}
+
+#endif
+
+int main()
+{
+	buildRasterLookup();
+
+	Leds leds(PIXELS_WIDTH, PIXELS_HEIGHT, rasterLookup, hostShow, hostSetPixel);
+
+	unsigned char *frames = drawLights(&leds);
+
+	checkSameAsColumnLayout(frames);
+
+	// the strip buffer path as startPixel sets it up
+	Leds stripLeds(PIXELS_WIDTH, PIXELS_HEIGHT, rasterLookup, hostShow, hostSetPixel);
+	stripLeds.setOutputBuffer(strip.getPixels(), strip.rOffset, strip.gOffset, strip.bOffset, 3);
+
+	unsigned char *stripFrames = drawLights(&stripLeds);
+
+	checkStripOutput(frames, stripFrames);
+
+	printf("  output to a strip of %d: setPixel %.2f us/frame, strip buffer %.2f us/frame\n", PIXELS_NO_OF_LEDS,
+		   outputMicrosPerFrame(&leds), outputMicrosPerFrame(&stripLeds));
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+	compareWithGoldenImage(frames);
+	return hostTestResult("pixels integer framebuffer");
+#else
+	writeGoldenImage(frames);
+	return hostTestResult("pixels float framebuffer");
+#endif
+}
@@ -0,0 +1,111 @@
+// Host measurement of the loop jitter caused by the slow sensors. The
+// clock and BME280 are given an estimate of the time that a read takes on
+// the device and the sensor loop is run for ten seconds, first with both
+// sensors polled on the same phase, as before the poll offsets, and then
+// with their default offsets. The sensorpassmicros histogram and the
+// worst pass are shown for each. With the default offsets no pass reads
+// both.
+
+#include <Arduino.h>
+
+#include "hostTest.h"
+#include "metrics.h"
+#include "sensors.h"
+
+// estimates of the time to read each sensor. The BME280 library makes a
+// number of transfers on a 100kHz I2C bus for the three values.
+#define HOST_CLOCK_READ_MICROS 200
+#define HOST_BME280_READ_MICROS 3000
+
+#define SENSOR_POLL_RUN_MILLIS 10000
+
+extern struct sensor *activeSensorList;
+extern struct metricHistogram sensorPassHistogram;
+
+void scheduleSensorPolling(sensor *s);
+
+struct process *getAllProcessList()
+{
+	return NULL;
+}
+
+void PrintSystemDetails(char *buffer, int length)
+{
+	snprintf(buffer, length, "hostdevice");
+}
+
+int publishBufferToMQTTTopic(char * /* buffer */, char * /* topic */)
+{
+	return 0;
+}
+
+void noReading(char * /* buffer */, int /* bufferSize */) {}
+
+void updateHostClock()
+{
+	hostMicros += HOST_CLOCK_READ_MICROS;
+}
+
+void updateHostBME280()
+{
+	hostMicros += HOST_BME280_READ_MICROS;
+}
+
+struct sensor hostClock;
+struct sensor hostBME280;
+
+void setupSensor(struct sensor *s, const char *name, void (*update)(), unsigned long pollOffsetMillis)
+{
+	s->sensorName = (char *)name;
+	s->updateSensor = update;
+	s->addReading = noReading;
+	s->beingUpdated = true;
+	s->pollIntervalMillis = 100;
+	s->pollOffsetMillis = pollOffsetMillis;
+	scheduleSensorPolling(s);
+}
+
+// returns the worst pass through the sensors
+
+unsigned long runSensors(const char *title, unsigned long clockOffset, unsigned long bme280Offset)
+{
+	setupSensor(&hostClock, "clock", updateHostClock, clockOffset);
+	setupSensor(&hostBME280, "bme280", updateHostBME280, bme280Offset);
+	activeSensorList = &hostClock;
+	hostClock.nextActiveSensor = &hostBME280;
+	hostBME280.nextActiveSensor = NULL;
+
+	memset(sensorPassHistogram.counts, 0, sizeof(sensorPassHistogram.counts));
+	sensorPassHistogram.noOfValues = 0;
+	sensorPassHistogram.maxValue = 0;
+
+	unsigned long endMillis = millis() + SENSOR_POLL_RUN_MILLIS;
+
+	while (millis() < endMillis)
+	{
+		updateSensors();
+		hostAdvanceMillis(1);
+	}
+
+	printf("  %s: worst pass %lu us, passes up to", title, sensorPassHistogram.maxValue);
+
+	for (int i = 0; i < sensorPassHistogram.noOfLimits; i++)
+	{
+		printf(" %luus:%lu", sensorPassHistogram.bucketLimits[i], sensorPassHistogram.counts[i]);
+	}
+
+	printf(" over:%lu\n", sensorPassHistogram.counts[sensorPassHistogram.noOfLimits]);
+
+	return sensorPassHistogram.maxValue;
+}
+
+int main()
+{
+	unsigned long samePhase = runSensors("same phase", 0, 0);
+	unsigned long staggered = runSensors("default offsets", CLOCK_POLL_OFFSET_MILLIS, BME280_POLL_OFFSET_MILLIS);
+
+	CHECK(samePhase == HOST_CLOCK_READ_MICROS + HOST_BME280_READ_MICROS);
+	CHECK(staggered == HOST_BME280_READ_MICROS);
+
+	return hostTestResult("sensor poll");
+}
@@ -0,0 +1,358 @@
+// Host test of the sensor telemetry: the CBOR form is decoded and checked
+// against the readings that were added, the JSON form is parsed the same
+// way, and a buffer too small for either form gives a length of zero. The
+// real BME280 sensor is read to check that a steady reading is left out
+// of the changed readings.
+
+#include <Arduino.h>
+
+#include "hostTest.h"
+#include "sensors.h"
+#include "BME280Sensor.h"
+#include "clock.h"
+
+#include <Adafruit_BME280.h>
+
+#include <map>
+
+extern struct sensor *activeSensorList;
+extern Adafruit_BME280 bme;
+
+// the BME280 sends on the clock ticks, which stay at midnight here
+struct clockReading hostClockReading;
+struct sensor clockSensor;
+
+void addWeatherReadings(char *buffer, int bufferSize)
+{
+	addSensorReadingFloat(buffer, bufferSize, "temp", 21.5);
+	addSensorReadingFloat(buffer, bufferSize, "chill", -3.25);
+	addSensorReadingInt(buffer, bufferSize, "pressure", 101325);
+}
+
+void addCountReadings(char *buffer, int bufferSize)
+{
+	addSensorReadingInt(buffer, bufferSize, "small", 23);
+	addSensorReadingInt(buffer, bufferSize, "byte", 200);
+	addSensorReadingInt(buffer, bufferSize, "short", 40000);
+	addSensorReadingInt(buffer, bufferSize, "minus", -1);
+	addSensorReadingInt(buffer, bufferSize, "bigminus", -70000);
+}
+
+void addTextReadings(char *buffer, int bufferSize)
+{
+	addSensorReadingText(buffer, bufferSize, "card", "04a2b3c4d5");
+	addSensorReadingText(buffer, bufferSize, "longname", "a text reading longer than twenty three characters");
+}
+
+struct sensor weatherSensor;
+struct sensor countSensor;
+struct sensor textSensor;
+
+void setupSensors()
+{
+	weatherSensor.sensorName = "weather";
+	weatherSensor.addReading = addWeatherReadings;
+	weatherSensor.beingUpdated = true;
+	countSensor.sensorName = "count";
+	countSensor.addReading = addCountReadings;
+	countSensor.beingUpdated = true;
+	textSensor.sensorName = "text";
+	textSensor.addReading = addTextReadings;
+	textSensor.beingUpdated = true;
+
+	activeSensorList = &weatherSensor;
+	weatherSensor.nextActiveSensor = &countSensor;
+	countSensor.nextActiveSensor = &textSensor;
+	textSensor.nextActiveSensor = NULL;
+}
+
+// every value is held as text so that both forms can be compared with
+// the expected readings
+
+typedef std::map<std::string, std::string> readings;
+
+readings expectedReadings()
+{
+	return {
+		{"dev", "hostdevice"},
+		{"temp", "21.50"},
+		{"chill", "-3.25"},
+		{"pressure", "101325"},
+		{"small", "23"},
+		{"byte", "200"},
+		{"short", "40000"},
+		{"minus", "-1"},
+		{"bigminus", "-70000"},
+		{"card", "04a2b3c4d5"},
+		{"longname", "a text reading longer than twenty three characters"}};
+}
+
+// a decoder for the subset of CBOR that the telemetry uses
+
+struct cborReader
+{
+	const unsigned char *data;
+	int length;
+	int pos;
+	bool failed;
+};
+
+int readCborByte(cborReader *r)
+{
+	if (r->pos >= r->length)
+	{
+		r->failed = true;
+		return 0;
+	}
+	return r->data[r->pos++];
+}
+
+unsigned long readCborArgument(cborReader *r, int info)
+{
+	if (info < 24)
+		return info;
+
+	int noOfBytes = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : 0;
+
+	if (noOfBytes == 0)
+	{
+		r->failed = true;
+		return 0;
+	}
+
+	unsigned long value = 0;
+	for (int i = 0; i < noOfBytes; i++)
+	{
+		value = (value << 8) | readCborByte(r);
+	}
+	return value;
+}
+
+std::string readCborItem(cborReader *r)
+{
+	int initial = readCborByte(r);
+	int major = initial >> 5;
+	int info = initial & 0x1f;
+	char buffer[30];
+
+	if (initial == CBOR_FLOAT32)
+	{
+		uint32_t bits = readCborArgument(r, 26);
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		snprintf(buffer, 30, "%.2f", value);
+		return buffer;
+	}
+
+	unsigned long argument = readCborArgument(r, info);
+
+	switch (major)
+	{
+	case CBOR_MAJOR_UNSIGNED:
+		snprintf(buffer, 30, "%lu", argument);
+		return buffer;
+
+	case CBOR_MAJOR_NEGATIVE:
+		snprintf(buffer, 30, "%ld", -1 - (long)argument);
+		return buffer;
+
+	case CBOR_MAJOR_TEXT:
+	{
+		std::string text;
+		for (unsigned long i = 0; i < argument; i++)
+		{
+			text += (char)readCborByte(r);
+		}
+		return text;
+	}
+	}
+
+	r->failed = true;
+	return "";
+}
+
+bool decodeCbor(const char *buffer, int length, readings *result)
+{
+	cborReader r = {(const unsigned char *)buffer, length, 0, false};
+
+	if (readCborByte(&r) != CBOR_MAP_START)
+		return false;
+
+	while (!r.failed && r.pos < length && r.data[r.pos] != CBOR_BREAK)
+	{
+		std::string name = readCborItem(&r);
+		(*result)[name] = readCborItem(&r);
+	}
+
+	// the break must be the last byte
+	return !r.failed && r.pos == length - 1 && r.data[r.pos] == CBOR_BREAK;
+}
+
+// JSON in the form the telemetry writes: a flat object of strings and numbers
+
+bool decodeJson(const char *buffer, readings *result)
+{
+	const char *p = buffer;
+
+	while (*p == ' ' || *p == '{')
+		p++;
+
+	while (*p == '"')
+	{
+		const char *nameEnd = strchr(p + 1, '"');
+		if (nameEnd == NULL || nameEnd[1] != ':')
+			return false;
+		std::string name(p + 1, nameEnd);
+		p = nameEnd + 2;
+
+		const char *valueEnd;
+		std::string value;
+
+		if (*p == '"')
+		{
+			valueEnd = strchr(p + 1, '"');
+			if (valueEnd == NULL)
+				return false;
+			value = std::string(p + 1, valueEnd);
+			valueEnd++;
+		}
+		else
+		{
+			valueEnd = p + strcspn(p, ",}");
+			value = std::string(p, valueEnd);
+		}
+
+		(*result)[name] = value;
+		p = valueEnd;
+
+		if (*p == ',')
+			p++;
+	}
+
+	return strcmp(p, "}") == 0;
+}
+
+void testCborRoundTrip()
+{
+	char buffer[300];
+
+	int length = createSensorTelemetry("hostdevice", buffer, sizeof(buffer), sensorTelemetryCbor, false);
+	CHECK(length > 0);
+
+	readings decoded;
+	CHECK(decodeCbor(buffer, length, &decoded));
+	CHECK(decoded == expectedReadings());
+
+	// one byte short of room for the break
+	CHECK(createSensorTelemetry("hostdevice", buffer, length - 1, sensorTelemetryCbor, false) == 0);
+	CHECK(createSensorTelemetry("hostdevice", buffer, length, sensorTelemetryCbor, false) == length);
+}
+
+void testJson()
+{
+	char buffer[300];
+
+	int length = createSensorTelemetry("hostdevice", buffer, sizeof(buffer), sensorTelemetryJson, false);
+	CHECK(length == (int)strlen(buffer));
+
+	readings decoded;
+	CHECK(decodeJson(buffer, &decoded));
+	CHECK(decoded == expectedReadings());
+
+	// the terminator needs a byte too
+	CHECK(createSensorTelemetry("hostdevice", buffer, length, sensorTelemetryJson, false) == 0);
+	CHECK(createSensorTelemetry("hostdevice", buffer, length + 1, sensorTelemetryJson, false) == length);
+
+	// cut off in the middle of the readings
+	CHECK(createSensorTelemetry("hostdevice", buffer, length / 2, sensorTelemetryJson, false) == 0);
+
+	// even the device name doesn't fit
+	CHECK(createSensorTelemetry("hostdevice", buffer, 8, sensorTelemetryJson, false) == 0);
+}
+
+void testChangedOnly()
+{
+	char buffer[300];
+
+	markSensorReadingsTransmitted();
+	countSensor.readingNumber++;
+
+	int length = createSensorTelemetry("hostdevice", buffer, sizeof(buffer), sensorTelemetryCbor, true);
+
+	readings decoded;
+	CHECK(decodeCbor(buffer, length, &decoded));
+	CHECK(decoded.size() == 6);
+	CHECK(decoded["short"] == "40000");
+	CHECK(decoded.count("temp") == 0);
+}
+
+// as the sensor loop reads the BME280 every 100 milliseconds
+
+void readBME280(int noOfReads)
+{
+	for (int i = 0; i < noOfReads; i++)
+	{
+		hostAdvanceMillis(BME280_DEFAULT_POLL_INTERVAL_MILLIS);
+		bme280Sensor.updateSensor();
+	}
+}
+
+readings changedReadings()
+{
+	char buffer[300];
+	readings decoded;
+
+	int length = createSensorTelemetry("hostdevice", buffer, sizeof(buffer), sensorTelemetryCbor, true);
+	CHECK(decodeCbor(buffer, length, &decoded));
+	return decoded;
+}
+
+void testBME280Unchanged()
+{
+	clockSensor.activeReading = &hostClockReading;
+
+	bme280SensorSettings.bme280SensorFitted = true;
+	bme280SensorSettings.envNoOfAverages = 5;
+	bme280SensorSettings.tempDelta = 0.5;
+	bme280SensorSettings.humidDelta = 2;
+	bme280SensorSettings.pressDelta = 10;
+
+	bme280Sensor.startSensor();
+	CHECK(bme280Sensor.status == SENSOR_OK);
+	bme280Sensor.startReading();
+	bme280Sensor.beingUpdated = true;
+	bme280Sensor.nextActiveSensor = NULL;
+	activeSensorList = &bme280Sensor;
+
+	// the first reading always goes
+	readBME280(5);
+	CHECK(sensorReadingsChanged());
+	markSensorReadingsTransmitted();
+
+	// small changes, inside the deltas
+	bme.temperature = 20.2;
+	bme.humidity = 51;
+	bme.pressure = 101500;
+	readBME280(50);
+
+	CHECK(!sensorReadingsChanged());
+	CHECK(changedReadings().size() == 1);
+
+	bme.temperature = 21;
+	readBME280(5);
+
+	CHECK(sensorReadingsChanged());
+	readings decoded = changedReadings();
+	CHECK(decoded["temp"] == "21.00");
+	CHECK(decoded["humidity"] == "51.00");
+}
+
+int main()
+{
+	setupSensors();
+	testCborRoundTrip();
+	testJson();
+	testChangedOnly();
+	testBME280Unchanged();
+	return hostTestResult("sensor telemetry");
+}
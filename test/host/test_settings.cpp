@@ -0,0 +1,175 @@
+// Host test of where the settings are stored. A save that changes the
+// binary image also rewrites the text file, so that a change in the
+// layout of the settings makes the next boot load the current settings
+// from the text file once. Both files are written to a temporary file
+// and renamed, so a power cut part way through a save leaves the old
+// settings in place.
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include "hostTest.h"
+#include "settings.h"
+#include "mqtt.h"
+#include "processes.h"
+
+extern SettingsStoreStatus settingsStoreStatus;
+extern unsigned long settingsTextWrites;
+extern unsigned long settingsImageWrites;
+
+void addProcessToAllProcessList(struct process *newProcess);
+
+void beginWiFiScanning() {}
+
+// a restart, which sets the store up again from the files
+
+SettingsSetupStatus reboot()
+{
+	settingsStoreStatus = SETTINGS_STATUS_JUST_BOOTED;
+	return setupSettings(false);
+}
+
+std::string textSettings()
+{
+	if (!LittleFS.exists(SETTINGS_FILENAME))
+	{
+		return "";
+	}
+
+	return *LittleFS.files[SETTINGS_FILENAME];
+}
+
+void testSavesWriteBothFiles()
+{
+	CHECK(reboot() == SETTINGS_RESET_TO_DEFAULTS);
+	CHECK(LittleFS.exists(SETTINGS_IMAGE_FILENAME));
+	CHECK(LittleFS.exists(SETTINGS_FILENAME));
+
+	unsigned long imageWritesBefore = settingsImageWrites;
+	unsigned long textWritesBefore = settingsTextWrites;
+
+	strcpy(mqttSettings.mqttServer, "imagebroker");
+	saveSettings();
+	flushSettings();
+
+	CHECK(settingsImageWrites == imageWritesBefore + 1);
+	CHECK(settingsTextWrites == textWritesBefore + 1);
+	CHECK(textSettings().find("mqtthost=imagebroker\n") != std::string::npos);
+
+	// a save that changes nothing writes neither file
+	saveSettings();
+	flushSettings();
+
+	CHECK(settingsImageWrites == imageWritesBefore + 1);
+	CHECK(settingsTextWrites == textWritesBefore + 1);
+
+	strcpy(mqttSettings.mqttServer, "changed");
+	CHECK(reboot() == SETTINGS_SETUP_OK);
+	CHECK(strcmp(getSettingsLoadSource(), "image") == 0);
+	CHECK(strcmp(mqttSettings.mqttServer, "imagebroker") == 0);
+}
+
+void testExport()
+{
+	unsigned long textWritesBefore = settingsTextWrites;
+
+	CHECK(exportSettingsToFile((char *)"exported.config"));
+	CHECK(settingsTextWrites == textWritesBefore + 1);
+	CHECK(LittleFS.exists("exported.config"));
+	CHECK(*LittleFS.files["exported.config"] == textSettings());
+}
+
+// Firmware with a different layout of settings, made here by leaving out
+// the last MQTT setting. No export is made first, the settings must come
+// through from the text file written by the last save.
+
+void testLayoutChange()
+{
+	strcpy(mqttSettings.mqttServer, "beforeupdate");
+	mqttSettings.mqttPort = 1884;
+	saveSettings();
+	flushSettings();
+
+	int noOfSettings = mqttSettingItems.noOfSettings;
+	mqttSettingItems.noOfSettings = noOfSettings - 1;
+
+	strcpy(mqttSettings.mqttServer, "changed");
+	mqttSettings.mqttPort = 0;
+
+	CHECK(reboot() == SETTINGS_SETUP_OK);
+	CHECK(strcmp(getSettingsLoadSource(), "text") == 0);
+	CHECK(strcmp(mqttSettings.mqttServer, "beforeupdate") == 0);
+	CHECK(mqttSettings.mqttPort == 1884);
+
+	// the image has been written again so the text file isn't needed next time
+	strcpy(mqttSettings.mqttServer, "changed");
+	CHECK(reboot() == SETTINGS_SETUP_OK);
+	CHECK(strcmp(getSettingsLoadSource(), "image") == 0);
+	CHECK(strcmp(mqttSettings.mqttServer, "beforeupdate") == 0);
+
+	// and back to the first firmware
+	mqttSettingItems.noOfSettings = noOfSettings;
+
+	strcpy(mqttSettings.mqttServer, "changed");
+	CHECK(reboot() == SETTINGS_SETUP_OK);
+	CHECK(strcmp(getSettingsLoadSource(), "text") == 0);
+	CHECK(strcmp(mqttSettings.mqttServer, "beforeupdate") == 0);
+}
+
+// The power goes part way through writing the image, or once the image
+// is in place part way through writing the text file
+
+void powerCut(long budget)
+{
+	strcpy(mqttSettings.mqttServer, "aftercut");
+	saveSettings();
+	hostFileWriteBudget = budget;
+	flushSettings();
+	hostFileWriteBudget = -1;
+}
+
+void testPowerCut()
+{
+	strcpy(mqttSettings.mqttServer, "beforecut");
+	saveSettings();
+	flushSettings();
+
+	std::string image = *LittleFS.files[SETTINGS_IMAGE_FILENAME];
+	std::string text = textSettings();
+
+	long budgets[] = {0, 20, (long)image.size() / 2, (long)image.size() - 1};
+
+	for (long budget : budgets)
+	{
+		powerCut(budget);
+
+		CHECK(*LittleFS.files[SETTINGS_IMAGE_FILENAME] == image);
+		CHECK(textSettings() == text);
+
+		strcpy(mqttSettings.mqttServer, "changed");
+		CHECK(reboot() == SETTINGS_SETUP_OK);
+		CHECK(strcmp(getSettingsLoadSource(), "image") == 0);
+		CHECK(strcmp(mqttSettings.mqttServer, "beforecut") == 0);
+	}
+
+	powerCut((long)image.size() + 20);
+
+	CHECK(textSettings() == text);
+
+	strcpy(mqttSettings.mqttServer, "changed");
+	CHECK(reboot() == SETTINGS_SETUP_OK);
+	CHECK(strcmp(getSettingsLoadSource(), "image") == 0);
+	CHECK(strcmp(mqttSettings.mqttServer, "aftercut") == 0);
+}
+
+int main()
+{
+	addProcessToAllProcessList(&MQTTProcessDescriptor);
+
+	testSavesWriteBothFiles();
+	testExport();
+	testLayoutChange();
+	testPowerCut();
+
+	return hostTestResult("settings");
+}
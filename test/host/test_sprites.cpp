@@ -0,0 +1,164 @@
+// Host replay of the sprite engine. A frame is taken through walking
+// colours, speed changes, a colour mask, twinkle, background and
+// brightness fades on three panel sizes, and a hash of everything sent to
+// the pixels is compared with the one recorded from the separate sprite
+// objects that were used before the sprite store. The frame has the
+// default 20 sprites. Like test_pixels this is built with both
+// framebuffers.
+
+#include <Arduino.h>
+
+#include "hostTest.h"
+#include "Frame.h"
+
+#define SPRITES_NO_OF_FRAMES 600
+#define SPRITES_MAX_NO_OF_LEDS 200
+
+void localSrand(int seed);
+
+// hashes of the output of the sprite objects drawing the same frames
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+#define SPRITES_STRIP_HASH 0x3e52ec85UL
+#define SPRITES_SQUARE_HASH 0x8100ac27UL
+#define SPRITES_PANEL_HASH 0x703fd0aeUL
+#else
+#define SPRITES_STRIP_HASH 0x1bc8465aUL
+#define SPRITES_SQUARE_HASH 0x51c1dd0bUL
+#define SPRITES_PANEL_HASH 0x224cbdd2UL
+#endif
+
+unsigned char stripBytes[SPRITES_MAX_NO_OF_LEDS * 3];
+int rasterLookup[SPRITES_MAX_NO_OF_LEDS];
+
+int framesDrawn;
+
+void hostShow()
+{
+	framesDrawn++;
+}
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+
+void hostSetPixel(int no, unsigned char r, unsigned char g, unsigned char b)
+{
+	stripBytes[no * 3] = r;
+	stripBytes[no * 3 + 1] = g;
+	stripBytes[no * 3 + 2] = b;
+}
+
+#else
+
+void hostSetPixel(int no, float r, float g, float b)
+{
+	stripBytes[no * 3] = (unsigned char)round(r * 255);
+	stripBytes[no * 3 + 1] = (unsigned char)round(g * 255);
+	stripBytes[no * 3 + 2] = (unsigned char)round(b * 255);
+}
+
+#endif
+
+uint32_t hashBytes(uint32_t hash, unsigned char *bytes, int length)
+{
+	for (int i = 0; i < length; i++)
+	{
+		hash = (hash ^ bytes[i]) * 16777619UL;
+	}
+
+	return hash;
+}
+
+// the frame is changed at these frame numbers, as pixel commands would
+
+void changeFrame(Frame *frame, int frameNo)
+{
+	char walkingColours[] = "RGBYMC";
+	char colourMask[] = "R*GKB*WKY";
+	char allOff[] = "K";
+	char white[] = "W";
+	Colour dimBlue = {0, 0, 0.1f};
+
+	switch (frameNo)
+	{
+	case 0:
+		frame->fadeUp(30);
+		frame->fadeSpritesToWalkingColours(walkingColours, 20);
+		break;
+	case 100:
+		frame->setSpriteSpeed(0.05);
+		break;
+	case 150:
+		frame->fadeSpritesToColourCharMask(colourMask, 30);
+		break;
+	case 250:
+		frame->fadeSpritesToTwinkle(20);
+		break;
+	case 320:
+		frame->fadeBackToColour(dimBlue, 20);
+		break;
+	case 380:
+		frame->fadeSpritesToWalkingColours(allOff, 10);
+		break;
+	case 430:
+		frame->fadeSpritesToWalkingColours(white, 10);
+		frame->setSpriteSpeed(0.1);
+		break;
+	case 520:
+		frame->fadeDown(50);
+		break;
+	}
+}
+
+// draws the frames as updateFrame in pixels.cpp does, only when
+// something has changed
+
+uint32_t replaySprites(int width, int height)
+{
+	int noOfLeds = width * height;
+
+	for (int i = 0; i < noOfLeds; i++)
+	{
+		rasterLookup[i] = i;
+	}
+
+	randomSeed(1);
+	localSrand(1234);
+	framesDrawn = 0;
+
+	Leds leds(width, height, rasterLookup, hostShow, hostSetPixel);
+	Frame frame(&leds, BLACK_COLOUR);
+
+	uint32_t hash = 2166136261UL;
+
+	for (int frameNo = 0; frameNo < SPRITES_NO_OF_FRAMES; frameNo++)
+	{
+		changeFrame(&frame, frameNo);
+
+		frame.update();
+
+		if (frame.frameChanged)
+		{
+			frame.render();
+			hash = hashBytes(hash, stripBytes, noOfLeds * 3);
+		}
+	}
+
+	printf("  %dx%d with %d sprites: %d frames drawn, output hash %08lx\n", width, height,
+		   frame.sprites->noOfSprites, framesDrawn, (unsigned long)hash);
+
+	CHECK(frame.sprites->noOfSprites == DEFAULT_NO_OF_SPRITES);
+
+	return hash;
+}
+
+int main()
+{
+	CHECK(replaySprites(12, 1) == SPRITES_STRIP_HASH);
+	CHECK(replaySprites(8, 8) == SPRITES_SQUARE_HASH);
+	CHECK(replaySprites(20, 10) == SPRITES_PANEL_HASH);
+
+#ifdef PIXELS_INTEGER_FRAMEBUFFER
+	return hostTestResult("sprites integer framebuffer");
+#else
+	return hostTestResult("sprites float framebuffer");
+#endif
+}